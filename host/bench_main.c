@@ -0,0 +1,114 @@
+/**
+ * @file bench_main.c
+ * @brief 호스트 벤치마크 실행 파일. bench.h의 결과를 CSV로 출력한다.
+ *
+ *   linetracer_bench [-b baseline.csv] [-t tolerance] > result.csv
+ *     -b <file>  이전 결과 CSV. 중앙값이 기준보다 tolerance 배 넘게 느려진 함수가 있으면 종료 코드 1을 반환한다.
+ *     -t <ratio> 허용 비율 (기본 1.25)
+ *
+ * 비교 결과는 stderr로 출력하므로, stdout은 그대로 다음 기준 결과로 쓸 수 있다.
+ * 펌웨어의 Benchmark 메뉴도 같은 형식의 CSV를 TEXT 프레임으로 보낸다. (단위만 cycles로 다르다)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+
+#include "hal_host.h"
+#include "bench.h"
+
+#define BENCH_KERNEL_MAX 32
+#define BENCH_NAME_MAX   48
+
+static struct bench_baseline_t {
+    char name[BENCH_NAME_MAX];
+    float median;
+} baseline[BENCH_KERNEL_MAX];
+static int baseline_count = 0;
+
+static float tolerance = 1.25f;
+static int regressions = 0;
+
+/**
+ * @brief 기준 결과 CSV를 읽는다. 형식은 BENCH_CSV_HEADER와 같다.
+ *
+ * @return 0: 성공, 1: 파일을 열 수 없음
+ */
+static int baseline_load(const char *path) {
+    char line[256], name[BENCH_NAME_MAX], unit[16];
+    unsigned calls;
+    float min, median, max;
+
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        perror(path);
+        return 1;
+    }
+    while (fgets(line, sizeof(line), file) && baseline_count < BENCH_KERNEL_MAX) {
+        for (char *c = line; *c; c++) {
+            if (*c == ',') {
+                *c = ' ';
+            }
+        }
+        if (sscanf(line, "%47s %15s %u %f %f %f", name, unit, &calls, &min, &median, &max) == 6) {
+            snprintf(baseline[baseline_count].name, BENCH_NAME_MAX, "%s", name);
+            baseline[baseline_count].median = median;
+            baseline_count++;
+        }
+    }
+    fclose(file);
+
+    return 0;
+}
+
+static void report(const struct bench_result_t *result) {
+    char line[128];
+
+    bench_format_csv(result, line, sizeof(line));
+    printf("%s\n", line);
+
+    for (int i = 0; i < baseline_count; i++) {
+        if (strcmp(baseline[i].name, result->name) != 0 || strcmp(result->name, "baseline") == 0) {
+            continue;
+        }
+
+        const float ratio = baseline[i].median > 0 ? result->median / baseline[i].median : 1.0f;
+        const bool regressed = ratio > tolerance;
+        fprintf(stderr, "%-32s %8.1f -> %8.1f %s  (x%.2f)%s\n", result->name, baseline[i].median, result->median,
+                HAL_CYCLE_UNIT, ratio, regressed ? "  REGRESSION" : "");
+        regressions += regressed;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int option;
+
+    while ((option = getopt(argc, argv, "b:t:h")) != -1) {
+        switch (option) {
+        case 'b':
+            if (baseline_load(optarg)) {
+                return 1;
+            }
+            break;
+        case 't':
+            tolerance = strtof(optarg, NULL);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-b baseline.csv] [-t tolerance]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    hal_host_reset();
+
+    printf("%s\n", BENCH_CSV_HEADER);
+    bench_run(report);
+
+    if (regressions) {
+        fprintf(stderr, "%d kernel(s) slower than %.2fx the baseline\n", regressions, tolerance);
+        return 1;
+    }
+
+    return 0;
+}
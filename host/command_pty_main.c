@@ -0,0 +1,261 @@
+/**
+ * @file command_pty_main.c
+ * @brief pty 위에서 command.c(라인트레이서 쪽)와 tools/param_tool.c(PC 쪽)를 맞물려 파라미터 명령을 검사하는 테스트
+ *
+ *   linetracer_command_pty <param_tool 실행 파일>
+ *
+ * pty의 master 쪽은 USB CDC 대신 hal_host.usb_*에 연결하고, 스레드 하나가 command_poll과 telemetry_flush를 계속 호출한다.
+ * slave 쪽 장치 파일에 param_tool을 실행하여 list, get, set, sweep의 출력과 종료 코드를 확인한다.
+ * 1. list: 레지스트리의 파라미터가 모두 번호 순서대로 나와야 한다.
+ * 2. set, get: 최소/최대값 밖의 값은 범위 안으로 제한되고, 정수 파라미터는 반올림되어야 한다.
+ * 3. 오류: 없는 이름이면 "err unknown parameter"와 함께 실패해야 한다.
+ * 4. sweep: 값마다 한 줄씩 실제로 적용된 값이 나와야 한다.
+ * 실패하면 종료 코드 1을 반환한다.
+ */
+
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <math.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "hal_host.h"
+#include "command.h"
+#include "param.h"
+#include "telemetry.h"
+
+#define PTY_OUTPUT_MAX (64 * 1024)
+
+static int master;
+static volatile bool server_running = true;
+static const char *param_tool;
+
+static void pty_write(const void *data, uint length) {
+    const uint8_t *p = data;
+
+    while (length > 0) {
+        const ssize_t n = write(master, p, length);
+        if (n < 0) {
+            struct pollfd pfd = { .fd = master, .events = POLLOUT };
+            poll(&pfd, 1, 10);
+            continue;
+        }
+        p += n;
+        length -= n;
+    }
+}
+
+static int pty_read_char(void) {
+    uint8_t c;
+
+    return read(master, &c, 1) == 1 ? c : -1;
+}
+
+/**
+ * @brief 라인트레이서의 메인 루프 대신 명령을 받아 처리한다.
+ */
+static void *pty_server(void *arg) {
+    (void)arg;
+
+    while (server_running) {
+        struct pollfd pfd = { .fd = master, .events = POLLIN };
+        poll(&pfd, 1, 10);
+        command_poll();
+        telemetry_flush();
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief param_tool을 실행하고 stdout, stderr 출력을 모은다.
+ *
+ * @return param_tool의 종료 코드, 실행하지 못하면 -1
+ */
+static int pty_run(const char *slave, const char *args, char *output, uint size) {
+    char command[512];
+    snprintf(command, sizeof(command), "'%s' '%s' %s 2>&1", param_tool, slave, args);
+
+    FILE *fp = popen(command, "r");
+    if (!fp) {
+        return -1;
+    }
+    const size_t length = fread(output, 1, size - 1, fp);
+    output[length] = '\0';
+
+    const int status = pclose(fp);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+static void pty_key(const struct param_t *param, char *key, uint size) {
+    uint i;
+    for (i = 0; param->name[i] != '\0' && i + 1 < size; i++) {
+        key[i] = param->name[i] == ' ' ? '_' : param->name[i];
+    }
+    key[i] = '\0';
+}
+
+static bool pty_equal(float a, float b) {
+    return fabsf(a - b) <= 1e-4f * MAX(1.0f, fabsf(b));
+}
+
+/**
+ * @brief "key value" 한 줄(param_tool get, set의 출력)에서 값을 읽어 expected와 비교한다.
+ */
+static bool pty_check_value(const char *output, const char *key, float expected) {
+    char name[64];
+    float value;
+
+    return sscanf(output, "%63s %f", name, &value) == 2 && strcmp(name, key) == 0 && pty_equal(value, expected);
+}
+
+static int pty_report(const char *name, bool passed, int code, const char *output) {
+    printf("%-12s  exit %d  %s\n", name, code, passed ? "OK" : "FAILED");
+    if (!passed) {
+        printf("%s", output);
+    }
+
+    return !passed;
+}
+
+static int pty_test(const char *slave) {
+    static char output[PTY_OUTPUT_MAX];
+    char args[256];
+    char key[64], int_key[16];
+    int failed = 0, code;
+
+    // 값 범위가 step의 두 배 이상인 실수 파라미터와, 정수 파라미터 하나를 고른다.
+    const struct param_t *param = NULL, *int_param = NULL;
+    uint int_index = 0;
+    for (uint i = 0; i < param_count(); i++) {
+        const struct param_t *p = param_get(i);
+        if (!param && p->type == PARAM_TYPE_FLOAT && p->step > 0 && p->max - p->min >= 2 * p->step) {
+            param = p;
+        }
+        if (!int_param && p->type == PARAM_TYPE_INT && p->max - p->min >= 2) {
+            int_param = p;
+            int_index = i;
+        }
+    }
+    if (!param || !int_param) {
+        printf("no suitable parameter  FAILED\n");
+        return 1;
+    }
+    pty_key(param, key, sizeof(key));
+    snprintf(int_key, sizeof(int_key), "%u", int_index);
+
+    // list: 번호, 이름 순서
+    code = pty_run(slave, "list", output, sizeof(output));
+    {
+        uint lines = 0;
+        bool ordered = true;
+        char line_key[64];
+        for (const char *line = output; *line != '\0'; lines++) {
+            uint index;
+            if (sscanf(line, "%u %63s", &index, line_key) != 2 || index != lines) {
+                ordered = false;
+            } else {
+                char expected[64];
+                pty_key(param_get(index), expected, sizeof(expected));
+                ordered = ordered && strcmp(line_key, expected) == 0;
+            }
+            const char *newline = strchr(line, '\n');
+            line = newline ? newline + 1 : line + strlen(line);
+        }
+        failed |= pty_report("list", code == 0 && ordered && lines == param_count(), code, output);
+    }
+
+    // set: 최대값보다 큰 값, 최소값보다 작은 값은 범위 안으로 제한된다.
+    snprintf(args, sizeof(args), "set %s %g", key, param->max + 100 * param->step);
+    code = pty_run(slave, args, output, sizeof(output));
+    failed |= pty_report("set max", code == 0 && pty_check_value(output, key, param->max), code, output);
+
+    snprintf(args, sizeof(args), "set %s %g", key, param->min - 100 * param->step);
+    code = pty_run(slave, args, output, sizeof(output));
+    failed |= pty_report("set min", code == 0 && pty_check_value(output, key, param->min), code, output);
+
+    snprintf(args, sizeof(args), "get %s", key);
+    code = pty_run(slave, args, output, sizeof(output));
+    failed |= pty_report("get", code == 0 && pty_check_value(output, key, param->min), code, output);
+
+    // 정수 파라미터는 반올림된다. 번호로도 지정할 수 있다.
+    snprintf(args, sizeof(args), "set %s %g", int_key, int_param->min + 1.4f);
+    code = pty_run(slave, args, output, sizeof(output));
+    failed |= pty_report("set int", code == 0 && pty_check_value(output, int_key, int_param->min + 1), code, output);
+
+    // 없는 이름
+    code = pty_run(slave, "get no_such_parameter", output, sizeof(output));
+    failed |= pty_report("get unknown", code == 1 && strstr(output, "err unknown parameter") != NULL, code, output);
+
+    code = pty_run(slave, "set no_such_parameter 1", output, sizeof(output));
+    failed |= pty_report("set unknown", code == 1 && strstr(output, "err unknown parameter") != NULL, code, output);
+
+    // sweep: min, min + step, min + 2 * step
+    snprintf(args, sizeof(args), "sweep %s %.9g %.9g %.9g 1", key, param->min, param->min + 2 * param->step,
+             param->step);
+    code = pty_run(slave, args, output, sizeof(output));
+    {
+        bool passed = code == 0 && strncmp(output, "time_ms,value\n", 14) == 0;
+        const char *line = output + (passed ? 14 : 0);
+        uint rows = 0;
+        for (long time_ms; passed && *line != '\0'; rows++) {
+            float value;
+            passed = sscanf(line, "%ld,%f", &time_ms, &value) == 2 && pty_equal(value, param->min + rows * param->step);
+            const char *newline = strchr(line, '\n');
+            line = newline ? newline + 1 : line + strlen(line);
+        }
+        failed |= pty_report("sweep", passed && rows == 3, code, output);
+    }
+
+    return failed;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <param_tool>\n", argv[0]);
+        return 1;
+    }
+    param_tool = argv[1];
+
+    master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        perror("posix_openpt");
+        return 1;
+    }
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+
+    // telemetry 프레임은 이진 데이터이므로 slave를 raw로 둔다. param_tool이 끝나도 설정이 유지되도록 계속 열어둔다.
+    const char *slave = ptsname(master);
+    const int slave_fd = open(slave, O_RDWR | O_NOCTTY);
+    struct termios tio;
+    if (slave_fd < 0 || tcgetattr(slave_fd, &tio) != 0) {
+        perror(slave);
+        return 1;
+    }
+    cfmakeraw(&tio);
+    tcsetattr(slave_fd, TCSANOW, &tio);
+
+    hal_host_reset();
+    hal_host.usb_write = pty_write;
+    hal_host.usb_read_char = pty_read_char;
+    hal_host.usb_write_available = 4096;
+
+    pthread_t server;
+    pthread_create(&server, NULL, pty_server, NULL);
+
+    const int failed = pty_test(slave);
+
+    server_running = false;
+    pthread_join(server, NULL);
+    close(slave_fd);
+    close(master);
+
+    return failed;
+}
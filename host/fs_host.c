@@ -0,0 +1,32 @@
+/**
+ * @file fs_host.c
+ * @brief fs.h의 호스트 구현. flash 대신 RAM에 데이터를 보관한다.
+ */
+
+#include <string.h>
+
+#include "fs.h"
+
+static struct fs_data_t fs_data;
+
+void fs_init(void) {
+    fs_format();
+}
+
+int fs_format(void) {
+    memset(&fs_data, 0, sizeof(fs_data));
+    for (int i = 0; i < SENSING_IR_COUNT; i++) {
+        fs_data.sensing_ir_range[i] = 0xff;
+    }
+    fs_data.sensing_ir_threshold = SENSING_IR_THRESHOLD_DEFAULT;
+
+    return 0;
+}
+
+int fs_flush_data(void) {
+    return 0;
+}
+
+struct fs_data_t *fs_get_data(void) {
+    return &fs_data;
+}
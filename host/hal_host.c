@@ -0,0 +1,196 @@
+/**
+ * @file hal_host.c
+ * @brief hal.h의 호스트 구현. 가상의 시계와 하드웨어 상태(hal_host.h)를 사용한다.
+ */
+
+#include <string.h>
+#include <time.h>
+
+#include "hal_host.h"
+
+struct hal_host_t hal_host;
+
+static bool in_handler = false; // 타이머 핸들러(인터럽트)를 실행하는 중인지 여부
+
+void hal_host_reset(void) {
+    memset(&hal_host, 0, sizeof(hal_host));
+    hal_host.loop_us = 1;
+    in_handler = false;
+    timer_host_reset();
+}
+
+void hal_host_advance(uint32_t us) {
+    const uint32_t target = hal_host.time_us + us;
+
+    if (in_handler) {
+        if (hal_host.step) {
+            hal_host.step(us);
+        }
+        hal_host.time_us = target;
+        return;
+    }
+
+    for (;;) {
+        uint32_t deadline;
+        if (timer_host_next(&deadline) || (int32_t)(deadline - target) > 0) {
+            break;
+        }
+
+        // 앞선 핸들러가 시간을 쓰는 동안 주기가 된 타이머는, 실제 인터럽트처럼 그 핸들러가 끝난 뒤에 늦게 실행된다.
+        if ((int32_t)(deadline - hal_host.time_us) > 0) {
+            if (hal_host.step) {
+                hal_host.step(deadline - hal_host.time_us);
+            }
+            hal_host.time_us = deadline;
+        }
+
+        in_handler = true;
+        timer_host_dispatch(hal_host.time_us);
+        in_handler = false;
+    }
+
+    if ((int32_t)(target - hal_host.time_us) > 0) {
+        if (hal_host.step) {
+            hal_host.step(target - hal_host.time_us);
+        }
+        hal_host.time_us = target;
+    }
+}
+
+int hal_clock_init(void) {
+    return 0;
+}
+
+uint32_t hal_clock_sys_hz(void) {
+    return CLOCK_SYS_MHZ * 1000000u;
+}
+
+uint32_t hal_time_us_32(void) {
+    // 메인 루프가 시각을 읽는 동안에도 시간은 흐르므로, 시각을 확인하며 기다리는 루프도 끝날 수 있다.
+    if (!in_handler) {
+        hal_host_advance(hal_host.loop_us);
+    }
+
+    return hal_host.time_us;
+}
+
+void hal_busy_wait_us(uint32_t us) {
+    hal_host_advance(us);
+}
+
+void hal_busy_wait_ms(uint32_t ms) {
+    hal_host_advance(ms * 1000);
+}
+
+void hal_tight_loop(void) {
+    hal_host_advance(hal_host.loop_us);
+}
+
+void hal_memory_barrier(void) {
+    // 호스트에서는 큐를 여러 스레드로 시험하므로(linetracer_queue_stress) 실제 barrier를 둔다.
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+uint32_t hal_irq_save(void) {
+    return 0;
+}
+
+void hal_irq_restore(uint32_t status) {
+    (void)status;
+}
+
+void hal_adc_init(void) {
+}
+
+void hal_adc_gpio_init(uint gpio) {
+    (void)gpio;
+}
+
+uint hal_adc_read(uint channel) {
+    return hal_host.adc_read ? hal_host.adc_read(channel) & 0xFFF : 0;
+}
+
+void hal_gpio_init_output(uint gpio) {
+    hal_host.gpio &= ~(1u << gpio);
+}
+
+void hal_gpio_put(uint gpio, bool value) {
+    if (value) {
+        hal_host.gpio |= 1u << gpio;
+    } else {
+        hal_host.gpio &= ~(1u << gpio);
+    }
+}
+
+void hal_gpio_set_mask(uint32_t mask) {
+    hal_host.gpio |= mask;
+}
+
+void hal_gpio_clr_mask(uint32_t mask) {
+    hal_host.gpio &= ~mask;
+}
+
+void hal_pwm_init(uint slice, uint32_t freq_hz, uint gpio_a, uint gpio_b) {
+    (void)slice, (void)gpio_a, (void)gpio_b;
+
+    // 펌웨어와 같은 분해능을 갖도록 CLOCK_SYS_MHZ 시스템 클럭과 hal_pico.c의 분주 방식을 따른다.
+    const uint32_t div = (hal_clock_sys_hz() / freq_hz + 0xFFFF) / 0x10000;
+    hal_host.pwm_top = hal_clock_sys_hz() / (freq_hz * div) - 1;
+    hal_host.pwm_enabled = false;
+}
+
+uint16_t hal_pwm_get_top(uint slice) {
+    (void)slice;
+
+    return hal_host.pwm_top;
+}
+
+void hal_pwm_set_level(uint slice, uint channel, uint16_t level) {
+    (void)slice;
+
+    hal_host.pwm_level[channel & 1] = level;
+}
+
+void hal_pwm_set_enabled(uint slice, bool enabled) {
+    (void)slice;
+
+    hal_host.pwm_enabled = enabled;
+}
+
+void hal_encoder_init(uint sm, uint base_gpio) {
+    (void)base_gpio;
+
+    hal_host.encoder[sm] = 0;
+}
+
+int32_t hal_encoder_get_count(uint sm) {
+    return hal_host.encoder[sm];
+}
+
+void hal_cycle_counter_init(void) {
+}
+
+uint32_t hal_cycle_count(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint32_t)((uint64_t)now.tv_sec * 1000000000u + now.tv_nsec);
+}
+
+bool hal_usb_connected(void) {
+    return hal_host.usb_write != NULL;
+}
+
+uint hal_usb_write_available(void) {
+    return hal_host.usb_write ? hal_host.usb_write_available : 0;
+}
+
+void hal_usb_write(const void *data, uint length) {
+    if (hal_host.usb_write) {
+        hal_host.usb_write(data, length);
+    }
+}
+
+int hal_usb_read_char(void) {
+    return hal_host.usb_read_char ? hal_host.usb_read_char() : -1;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file hal_host.h
+ * @brief hal.h의 호스트 구현이 흉내내는 가상 하드웨어의 상태
+ *
+ * 시각은 실제 시간과 관계없이 가상의 시계로 흐른다. 메인 루프 코드가 시각을 읽거나 기다릴 때마다 시계가 조금씩 흐르고,
+ * 그 사이에 주기가 된 타이머 핸들러(timer.h)가 실제 인터럽트처럼 실행된다.
+ * 시뮬레이터는 adc_read와 step 콜백을 채워 센서 값과 물리 모델을 제공한다.
+ */
+
+#ifndef _HAL_HOST_H_
+#define _HAL_HOST_H_
+
+#include "hal.h"
+
+struct hal_host_t {
+    uint32_t time_us; // 가상의 현재 시각
+    uint32_t loop_us; // 메인 루프가 시각을 읽을 때마다 흐르는 시간 (메인 루프 한 바퀴의 비용을 흉내낸다)
+
+    uint32_t gpio; // 출력 GPIO 상태 (비트마다 GPIO 하나)
+
+    uint16_t pwm_top;
+    uint16_t pwm_level[2]; // channel A, B
+    bool pwm_enabled;
+
+    int32_t encoder[4]; // state machine 번호별 엔코더 누적 값
+
+    /**
+     * @brief ADC 변환 값을 돌려주는 콜백 (12비트). 현재 GPIO 상태(MUX 선택, IR 발광)를 보고 값을 정한다.
+     * NULL이면 항상 0을 돌려준다.
+     */
+    uint (*adc_read)(uint channel);
+
+    /**
+     * @brief 가상의 시각이 dt_us 만큼 흐를 때 호출되는 콜백. 시뮬레이터가 물리 모델을 진행시키는 데 사용한다.
+     */
+    void (*step)(uint32_t dt_us);
+
+    /**
+     * @brief USB CDC. usb_write가 NULL이면 USB가 연결되지 않은 것으로 본다.
+     * 시험 프로그램이 콜백을 채워 telemetry.c가 보내는 바이트를 받고, command.c에 명령을 넣는다.
+     */
+    void (*usb_write)(const void *data, uint length);
+    int (*usb_read_char)(void); // 받은 문자가 없으면 음수
+    uint usb_write_available; // hal_usb_write_available이 돌려줄 값 (USB 송신 버퍼의 빈 자리)
+};
+
+extern struct hal_host_t hal_host;
+
+/**
+ * @brief 가상 하드웨어를 초기 상태로 되돌린다. 콜백과 타이머 등록도 지워진다.
+ */
+void hal_host_reset(void);
+
+/**
+ * @brief 가상의 시각을 us 만큼 흐르게 한다. 그 사이에 주기가 된 타이머 핸들러를 시각 순서대로 실행한다.
+ * 타이머 핸들러 안에서 호출되면 시각만 흐르고 다른 핸들러는 실행하지 않는다. (인터럽트는 중첩되지 않는다)
+ */
+void hal_host_advance(uint32_t us);
+
+/**
+ * @brief [timer_host.c] 실행 중인 타이머 중 가장 먼저 주기가 되는 타이머의 시각을 구한다.
+ *
+ * @return 0: 실행 중인 타이머가 있음, 1: 실행 중인 타이머가 없음
+ */
+int timer_host_next(uint32_t *deadline);
+
+/**
+ * @brief [timer_host.c] 시각 now까지 주기가 된(늦어진 것 포함) 타이머 핸들러들을 슬롯 순서대로 실행한다.
+ */
+void timer_host_dispatch(uint32_t now);
+
+/**
+ * @brief [timer_host.c] 모든 타이머를 멈추고 등록을 지운다.
+ */
+void timer_host_reset(void);
+
+/**
+ * @brief [switch_host.c] switch_read가 돌려줄 입력을 차례로 넣어둔다.
+ * 넣어둔 입력이 없으면 switch_read는 SWITCH_EVENT_BOTH를 돌려준다.
+ * 따라서 파라미터 편집 화면은 바로 넘어가고, YES // NO 확인 화면은 NO로 넘어간다.
+ */
+void switch_host_push(uint event);
+
+/**
+ * @brief [telemetry_host.c] telemetry_push로 보내진 프레임을 받는 콜백. 스트림 설정과 관계없이 모든 프레임이 전달된다.
+ * NULL이면 프레임을 버린다.
+ */
+extern void (*telemetry_host_hook)(uint type, const void *payload, uint length);
+
+#endif
@@ -0,0 +1,15 @@
+/**
+ * @file types.h
+ * @brief 호스트 빌드에서 Pico SDK의 pico/types.h를 대신하는 기본 타입 정의
+ */
+
+#ifndef _PICO_TYPES_H
+#define _PICO_TYPES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+
+#endif
@@ -0,0 +1,378 @@
+/**
+ * @file match_main.c
+ * @brief map.c(n차 주행의 마크 매칭)를 잡음이 섞인 마크 열로 검사하는 재생기
+ *
+ *   linetracer_match [-n trials] [-s seed] [golden ...]
+ *
+ * 맵은 인자로 받은 golden 파일("<mark> <tick>" 줄, linetracer_replay 참고)이나, 없으면 무작위로 만든 트랙을 쓴다.
+ * 시행마다 맵으로부터 n차 주행의 마크 열을 만든다.
+ * - 거리 배율 0.97 ~ 1.03 (바퀴 마모, 슬립)과 마크마다 최대 MARK_LENGTH_TICK의 위치 오차
+ * - 마크 삭제(놓침), 삽입(잘못 본 마크), 종류 바뀜을 각각 일정 확률로
+ * 맵에 있는 마크를 올바른 맵 인덱스에 맞췄는지, 잘못 본 마크를 무시했는지 센다.
+ * 비교를 위해 종류만 순서대로 맞추고 처음 어긋나면 멈추는 방식(이전 n차 주행)의 결과도 함께 출력한다.
+ * 또 마크를 맞추기 직전에 map_locate로 구한 마크의 맵 좌표와 실제 맵 위치의 차이(위치 보정 오차)를,
+ * 거리 배율 없이 마지막 마크로부터의 거리만 더했을 때의 오차와 함께 출력한다.
+ * 올바르게 맞춘 비율이 MATCH_PASS_RATIO보다 낮거나, 잘못 맞춘 비율이 MATCH_WRONG_RATIO보다 높거나,
+ * 위치 보정 오차가 배율 없는 경우보다 MATCH_LOCATE_TOLERANCE_MM 넘게 크면 종료 코드 1을 반환한다.
+ * (짧은 트랙에서는 배율을 배울 구간이 부족하므로 두 오차가 거의 같다)
+ *
+ * 맵 합치기(map_merge)도 검사한다. 같은 잡음의 주행 MATCH_MERGE_RUNS번은 모두 합쳐져야 하고,
+ * 다른 트랙의 주행과 거리 배율이 MATCH_MERGE_OUTLIER_SCALE인 주행은 거부되어야 한다.
+ * 첫 주행이 놓친 마크는 이후 주행들을 합치면서 맵에 들어가야 한다.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+
+#include "map.h"
+#include "fs.h"
+
+#define MATCH_MARK_MAX DRIVE_MARK_COUNT_MAX
+#define MATCH_RANDOM_MARKS 80
+
+#define MATCH_DELETE_PERCENT 5
+#define MATCH_INSERT_PERCENT 5
+#define MATCH_SUBSTITUTE_PERCENT 2
+
+#define MATCH_PASS_RATIO 0.95 // 맵에 있는 마크 중 올바르게 맞춰야 하는 비율
+#define MATCH_WRONG_RATIO 0.01 // 다른 맵 마크에 잘못 맞춰도 되는 비율
+#define MATCH_LOCATE_TOLERANCE_MM 1.0
+
+#define MATCH_MERGE_RUNS 8
+#define MATCH_MERGE_NOISE_PERCENT 2 // 1차 주행은 느리므로 마크를 놓치거나 잘못 보는 일이 드물다.
+#define MATCH_MERGE_OUTLIER_SCALE 1.2f
+#define MATCH_MISSING_EVERY 20 // 첫 주행이 이만큼의 마크마다 하나씩 놓친다.
+
+struct match_map_t {
+    const char *name;
+    enum mark_t marks[MATCH_MARK_MAX];
+    int32_t ticks[MATCH_MARK_MAX];
+    uint count;
+};
+
+struct match_result_t {
+    uint marks; // 맵에 있는 마크로서 본 수
+    uint correct; // 올바른 맵 인덱스에 맞춘 수
+    uint wrong; // 다른 맵 인덱스에 맞춘 수
+    uint inserted; // 잘못 본 마크 수
+    uint rejected; // 잘못 본 마크를 무시한 수
+    uint strict; // 이전 방식으로 올바르게 맞춘 수
+    double locate_error; // map_locate로 구한 위치와 실제 맵 위치의 차이 합 (tick)
+    double offset_error; // 배율 없이 구한 위치와 실제 맵 위치의 차이 합 (tick)
+};
+
+static const char *const MARK_NAME[] = { "none", "left", "right", "both", "cross" };
+
+static uint32_t random_state = 1;
+
+static uint match_random(uint range) {
+    random_state = random_state * 1103515245u + 12345u;
+    return (random_state >> 16) % range;
+}
+
+static int32_t match_random_range(int32_t min, int32_t max) {
+    return min + (int32_t)match_random(max - min + 1);
+}
+
+/**
+ * @brief 좌우 마크 쌍(직선), 곡선 마크, 크로스가 섞인 무작위 트랙 맵을 만든다.
+ */
+static void match_random_map(struct match_map_t *map) {
+    int32_t tick = MOTOR_TICK_PER_METER * 0.2f;
+
+    map->name = "random";
+    map->count = 0;
+    map->marks[map->count] = MARK_BOTH;
+    map->ticks[map->count++] = tick;
+
+    while (map->count < MATCH_RANDOM_MARKS - 1) {
+        const enum mark_t mark = match_random(2) ? MARK_LEFT : MARK_RIGHT;
+        const uint kind = match_random(4);
+
+        tick += match_random_range(MOTOR_TICK_PER_METER * 0.2f, MOTOR_TICK_PER_METER * 1.5f);
+        if (kind == 0) {
+            map->marks[map->count] = MARK_CROSS;
+        } else {
+            map->marks[map->count] = mark;
+            if (kind == 1) { // 직선: 같은 마크가 한 번 더 나온다.
+                map->ticks[map->count++] = tick;
+                tick += match_random_range(MOTOR_TICK_PER_METER * 0.5f, MOTOR_TICK_PER_METER * 3.0f);
+                map->marks[map->count] = mark;
+            }
+        }
+        map->ticks[map->count++] = tick;
+    }
+
+    map->marks[map->count] = MARK_BOTH;
+    map->ticks[map->count++] = tick + MOTOR_TICK_PER_METER * 0.5f;
+}
+
+/**
+ * @return 읽은 마크 수, 파일을 열 수 없으면 -1
+ */
+static int match_read_map(const char *path, struct match_map_t *map) {
+    char line[128], name[16];
+    int tick;
+    FILE *file = fopen(path, "r");
+
+    if (!file) {
+        return -1;
+    }
+
+    map->name = path;
+    map->count = 0;
+    while (fgets(line, sizeof(line), file) && map->count < MATCH_MARK_MAX) {
+        if (line[0] == '#' || sscanf(line, "%15s %d", name, &tick) != 2) {
+            continue;
+        }
+        for (uint m = MARK_LEFT; m <= MARK_CROSS; m++) {
+            if (strcmp(name, MARK_NAME[m]) == 0) {
+                map->marks[map->count] = m;
+                map->ticks[map->count++] = tick;
+            }
+        }
+    }
+    fclose(file);
+
+    return map->count;
+}
+
+/**
+ * @brief 이전 n차 주행의 방식: 종류만 순서대로 비교하고, 처음 어긋나면 이후로 맞추지 않는다.
+ */
+static int match_strict(const struct match_map_t *map, uint *index, bool *valid, enum mark_t mark) {
+    if (!*valid || *index >= map->count) {
+        return MAP_MATCH_NONE;
+    }
+    if (map->marks[*index] != mark) {
+        *valid = false;
+        return MAP_MATCH_NONE;
+    }
+    return (*index)++;
+}
+
+/**
+ * @brief 맵으로부터 잡음이 섞인 마크 열을 한 번 만들어 매칭하고, 결과를 result에 더한다.
+ */
+static void match_trial(const struct match_map_t *map, struct match_result_t *result) {
+    const float scale = 0.97f + 0.0001f * match_random(601);
+    struct map_match_t match;
+    uint strict_index = 0;
+    bool strict_valid = true;
+
+    map_match_init(&match, map->marks, map->ticks, map->count);
+
+    for (uint i = 0; i < map->count; i++) {
+        const int32_t tick = map->ticks[i] * scale + match_random_range(-MARK_LENGTH_TICK, MARK_LENGTH_TICK);
+
+        // 잘못 본 마크: 이전 마크와 이번 마크 사이 어딘가
+        if (i > 0 && match_random(100) < MATCH_INSERT_PERCENT) {
+            const int32_t previous = map->ticks[i - 1] * scale;
+            const enum mark_t mark = MARK_LEFT + match_random(3); // left, right, cross
+
+            result->inserted++;
+            result->rejected += map_match(&match, mark, match_random_range(previous, tick)) == MAP_MATCH_NONE;
+            match_strict(map, &strict_index, &strict_valid, mark);
+        }
+
+        if (match_random(100) < MATCH_DELETE_PERCENT) {
+            continue; // 놓친 마크
+        }
+
+        if (map->marks[i] != MARK_BOTH && match_random(100) < MATCH_SUBSTITUTE_PERCENT) {
+            // 종류가 바뀐 마크는 맵에 없는 마크이다.
+            const enum mark_t mark = map->marks[i] == MARK_LEFT ? MARK_RIGHT : MARK_LEFT;
+
+            result->inserted++;
+            result->rejected += map_match(&match, mark, tick) == MAP_MATCH_NONE;
+            match_strict(map, &strict_index, &strict_valid, mark);
+            continue;
+        }
+
+        result->locate_error += abs(map_locate(&match, tick) - map->ticks[i]);
+        result->offset_error += abs(match.map_last + (tick - match.run_last) - map->ticks[i]);
+
+        const int index = map_match(&match, map->marks[i], tick);
+        result->marks++;
+        result->correct += index == (int)i;
+        result->wrong += index != MAP_MATCH_NONE && index != (int)i;
+        result->strict += match_strict(map, &strict_index, &strict_valid, map->marks[i]) == (int)i;
+    }
+}
+
+/**
+ * @brief 맵으로부터 잡음이 섞인 1차 주행 하나를 만든다. (놓친 마크, 잘못 본 마크, 위치 오차)
+ */
+static void match_noisy_run(const struct match_map_t *map, float scale, struct match_map_t *run) {
+    // 맵 마크를 MAP_MERGE_MATCH_RATIO 이상 맞출 수 있는 정도의 잡음만 넣는다.
+    run->count = 0;
+    for (uint i = 0; i < map->count && run->count < MATCH_MARK_MAX - 1; i++) {
+        const int32_t tick = map->ticks[i] * scale + match_random_range(-MARK_LENGTH_TICK, MARK_LENGTH_TICK);
+
+        if (i > 0 && match_random(100) < MATCH_MERGE_NOISE_PERCENT) {
+            run->marks[run->count] = MARK_LEFT + match_random(3);
+            run->ticks[run->count++] = match_random_range(map->ticks[i - 1] * scale, tick);
+        }
+        if (match_random(100) < MATCH_MERGE_NOISE_PERCENT) {
+            continue;
+        }
+        run->marks[run->count] = map->marks[i];
+        run->ticks[run->count++] = tick;
+    }
+}
+
+/**
+ * @brief map을 첫 주행으로 저장한 뒤 잡음 섞인 주행들을 합치고, 다른 트랙과 배율이 크게 다른 주행은 거부하는지 본다.
+ *
+ * @param other map과 다른 트랙
+ * @return 0: 통과, 1: 실패
+ */
+static int match_merge_report(const struct match_map_t *map, const struct match_map_t *other) {
+    static struct fs_data_t data;
+    static struct match_map_t run;
+    uint merged = 0, rejected = 0;
+
+    data.detected_mark_count = map->count;
+    for (uint i = 0; i < map->count; i++) {
+        data.detected_mark[i] = map->marks[i];
+        data.detected_tick[i] = data.detected_exit_tick[i] = map->ticks[i];
+    }
+    map_stat_reset(&data);
+
+    for (int r = 0; r < MATCH_MERGE_RUNS; r++) {
+        match_noisy_run(map, 0.97f + 0.0001f * match_random(601), &run);
+        merged += map_merge(&data, run.marks, run.ticks, run.ticks, run.count) == 0;
+    }
+
+    rejected += map_merge(&data, other->marks, other->ticks, other->ticks, other->count) != 0;
+    match_noisy_run(map, MATCH_MERGE_OUTLIER_SCALE, &run);
+    rejected += map_merge(&data, run.marks, run.ticks, run.ticks, run.count) != 0;
+
+    double std_sum = 0;
+    for (uint i = 0; i < data.detected_mark_count; i++) {
+        std_sum += map_stat_std(&data.detected_stat[i]);
+    }
+    const bool passed = merged == MATCH_MERGE_RUNS && rejected == 2;
+
+    printf("%-40s %4u marks  merged %u/%u  outliers rejected %u/2  kept %u marks  mean std %5.1f mm  %s\n",
+           map->name, map->count, merged, MATCH_MERGE_RUNS, rejected, data.detected_mark_count,
+           data.detected_mark_count ? std_sum / data.detected_mark_count / MOTOR_TICK_PER_METER * 1000 : 0.0,
+           passed ? "OK" : "FAILED");
+
+    return !passed;
+}
+
+/**
+ * @brief 첫 주행이 MATCH_MISSING_EVERY번째 마크마다 놓친 맵에 잡음 섞인 주행들을 합친다.
+ * 놓친 마크가 후보를 거쳐 맵에 들어가, 합친 맵의 마크가 실제 맵과 종류, 위치(MAP_MERGE_ERROR_TICK 안)까지 같아야 한다.
+ *
+ * @return 0: 통과, 1: 실패
+ */
+static int match_missing_report(const struct match_map_t *map) {
+    static struct fs_data_t data;
+    static struct match_map_t run;
+    uint merged = 0, missing = 0;
+
+    data.detected_mark_count = 0;
+    for (uint i = 0; i < map->count; i++) {
+        if (i % MATCH_MISSING_EVERY == MATCH_MISSING_EVERY / 2) {
+            missing++;
+            continue;
+        }
+        data.detected_mark[data.detected_mark_count] = map->marks[i];
+        data.detected_tick[data.detected_mark_count] = data.detected_exit_tick[data.detected_mark_count] = map->ticks[i];
+        data.detected_mark_count++;
+    }
+    map_stat_reset(&data);
+
+    for (int r = 0; r < MATCH_MERGE_RUNS; r++) {
+        match_noisy_run(map, 0.97f + 0.0001f * match_random(601), &run);
+        merged += map_merge(&data, run.marks, run.ticks, run.ticks, run.count) == 0;
+    }
+
+    uint same = 0;
+    for (uint i = 0; i < map->count && i < data.detected_mark_count; i++) {
+        same += data.detected_mark[i] == map->marks[i] && abs(data.detected_tick[i] - map->ticks[i]) <= MAP_MERGE_ERROR_TICK;
+    }
+    const bool passed = merged == MATCH_MERGE_RUNS && data.detected_mark_count == map->count && same == map->count;
+
+    printf("%-40s %4u marks  merged %u/%u  missing in first run %u  kept %u marks  same as map %u  %s\n", map->name,
+           map->count, merged, MATCH_MERGE_RUNS, missing, data.detected_mark_count, same, passed ? "OK" : "FAILED");
+
+    return !passed;
+}
+
+/**
+ * @return 0: 통과, 1: 실패
+ */
+static int match_report(const struct match_map_t *map, uint trials) {
+    struct match_result_t result = { 0 };
+
+    for (uint t = 0; t < trials; t++) {
+        match_trial(map, &result);
+    }
+
+    const double correct = (double)result.correct / result.marks;
+    const double wrong = (double)result.wrong / result.marks;
+    const double locate_mm = result.locate_error / result.marks / MOTOR_TICK_PER_METER * 1000;
+    const double offset_mm = result.offset_error / result.marks / MOTOR_TICK_PER_METER * 1000;
+    const bool passed = correct >= MATCH_PASS_RATIO && wrong <= MATCH_WRONG_RATIO && locate_mm <= offset_mm + MATCH_LOCATE_TOLERANCE_MM;
+
+    printf("%-40s %4u marks  %5u trials  correct %6.2f %%  wrong %5.2f %%  rejected %6.2f %%  strict %6.2f %%  "
+           "locate %5.1f mm (unscaled %5.1f mm)  %s\n",
+           map->name, map->count, trials, 100 * correct, 100 * wrong,
+           result.inserted ? 100.0 * result.rejected / result.inserted : 100.0, 100.0 * result.strict / result.marks,
+           locate_mm, offset_mm, passed ? "OK" : "FAILED");
+
+    return !passed;
+}
+
+int main(int argc, char *argv[]) {
+    static struct match_map_t map, other;
+    uint trials = 1000;
+    int option;
+
+    while ((option = getopt(argc, argv, "n:s:h")) != -1) {
+        switch (option) {
+        case 'n':
+            trials = strtoul(optarg, NULL, 0);
+            break;
+        case 's':
+            random_state = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-n trials] [-s seed] [golden ...]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    int failed = 0;
+
+    if (optind == argc) {
+        for (int i = 0; i < 5; i++) {
+            match_random_map(&map);
+            failed |= match_report(&map, trials);
+        }
+        for (int i = 0; i < 5; i++) {
+            match_random_map(&map);
+            match_random_map(&other);
+            failed |= match_merge_report(&map, &other);
+        }
+        for (int i = 0; i < 5; i++) {
+            match_random_map(&map);
+            failed |= match_missing_report(&map);
+        }
+    }
+    for (int i = optind; i < argc; i++) {
+        if (match_read_map(argv[i], &map) <= 0) {
+            fprintf(stderr, "%s: no marks\n", argv[i]);
+            failed = 1;
+            continue;
+        }
+        failed |= match_report(&map, trials);
+    }
+
+    return failed;
+}
@@ -0,0 +1,40 @@
+/**
+ * @file oled_host.c
+ * @brief oled.h의 호스트 구현. 화면이 없으므로 아무것도 그리지 않는다.
+ */
+
+#include "oled.h"
+
+void oled_init(void) {
+}
+
+void oled_clear(void) {
+}
+
+int oled_putchar(char c, oled_color_t color, uint8_t x, uint8_t y) {
+    (void)c, (void)color, (void)x, (void)y;
+
+    return 0;
+}
+
+void oled_draw_begin(void) {
+}
+
+void oled_draw_end(void) {
+}
+
+void oled_fill_rect(int x, int y, int w, int h, oled_color_t color) {
+    (void)x, (void)y, (void)w, (void)h, (void)color;
+}
+
+void oled_draw_vline(int x, int y0, int y1, oled_color_t color) {
+    (void)x, (void)y0, (void)y1, (void)color;
+}
+
+void oled_scroll_left(int x, int y, int w, int h, int dx) {
+    (void)x, (void)y, (void)w, (void)h, (void)dx;
+}
+
+void oled_printf(const char *format, ...) {
+    (void)format;
+}
@@ -0,0 +1,147 @@
+/**
+ * @file queue_stress_main.c
+ * @brief queue.c(SPSC 큐)를 producer, consumer 스레드 두 개로 검사하는 스트레스 테스트
+ *
+ *   linetracer_queue_stress [-n items]
+ *
+ * 1. 재시도: 큐가 가득 차면 producer가 다시 넣는다. consumer는 모든 항목을 순서대로, 손상 없이 받아야 한다.
+ * 2. 버림: 큐가 가득 차면 producer가 항목을 버린다. 받은 항목은 순서대로여야 하고,
+ *    받은 수와 overflow의 합은 넣으려 한 수와 같아야 한다.
+ * 항목은 여러 워드로 되어 있어, 내용을 다 쓰기 전에 head가 옮겨지면 consumer가 찢어진 항목을 보게 된다.
+ * 실패하면 종료 코드 1을 반환한다.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include "queue.h"
+
+struct stress_item_t {
+    uint32_t seq;
+    uint32_t check[4];
+    uint8_t tail; // 항목 크기가 4의 배수가 아니어도 위치 계산이 맞는지 본다.
+} __attribute__((packed));
+
+QUEUE_DEFINE(stress_queue, struct stress_item_t, 8);
+
+static uint32_t item_count = 2000000;
+static bool retry;
+static volatile bool producer_done;
+
+/**
+ * @brief 상대 스레드를 기다린다. 처음에는 양보만 하다가 오래 기다리면 잠시 잠든다.
+ * (sched_yield만으로는 코어가 하나뿐인 환경에서 상대 스레드로 넘어가지 않는 경우가 있다)
+ */
+static void stress_wait(uint *spins) {
+    if (++*spins < 64) {
+        sched_yield();
+    } else {
+        usleep(1);
+        *spins = 0;
+    }
+}
+
+static struct stress_item_t stress_make(uint32_t seq) {
+    const struct stress_item_t item = {
+        .seq = seq,
+        .check = { seq * 2654435761u, ~seq, seq ^ 0xA5A5A5A5u, seq * 40503u },
+        .tail = (uint8_t)(seq * 7),
+    };
+    return item;
+}
+
+static bool stress_valid(const struct stress_item_t *item) {
+    const struct stress_item_t expected = stress_make(item->seq);
+
+    for (int i = 0; i < 4; i++) {
+        if (item->check[i] != expected.check[i]) {
+            return false;
+        }
+    }
+    return item->tail == expected.tail;
+}
+
+static void *stress_producer(void *arg) {
+    uint spins = 0;
+    (void)arg;
+
+    for (uint32_t seq = 0; seq < item_count; seq++) {
+        const struct stress_item_t item = stress_make(seq);
+        // 가득 차면 재시도 모드는 다시 넣고, 버림 모드는 버린 뒤 consumer가 따라올 기회를 준다.
+        while (!queue_push(&stress_queue, &item)) {
+            stress_wait(&spins);
+            if (!retry) {
+                break;
+            }
+        }
+    }
+    __atomic_store_n(&producer_done, true, __ATOMIC_RELEASE);
+
+    return NULL;
+}
+
+/**
+ * @return 0: 통과, 1: 실패
+ */
+static int stress_run(bool retry_mode) {
+    struct stress_item_t item;
+    uint32_t received = 0, torn = 0, disorder = 0;
+    int64_t last = -1;
+    uint spins = 0;
+    pthread_t producer;
+
+    retry = retry_mode;
+    producer_done = false;
+    queue_reset(&stress_queue);
+
+    pthread_create(&producer, NULL, stress_producer, NULL);
+    for (;;) {
+        const bool done = __atomic_load_n(&producer_done, __ATOMIC_ACQUIRE);
+
+        if (queue_pop(&stress_queue, &item)) {
+            received++;
+            torn += !stress_valid(&item);
+            disorder += (int64_t)item.seq <= last || (retry_mode && item.seq != last + 1);
+            last = item.seq;
+        } else if (done) {
+            break; // producer가 끝난 뒤에도 비어 있으면 모두 받은 것이다.
+        } else {
+            stress_wait(&spins);
+        }
+    }
+    pthread_join(producer, NULL);
+
+    const uint overflow = stress_queue.overflow;
+    // 재시도 모드의 overflow는 다시 넣은 횟수이므로 받은 수에 더하지 않는다.
+    const bool passed = torn == 0 && disorder == 0 && received + (retry_mode ? 0 : overflow) == item_count;
+
+    printf("%-6s  %u items  received %u  overflow %u  torn %u  out of order %u  %s\n",
+           retry_mode ? "retry" : "drop", item_count, received, overflow, torn, disorder, passed ? "OK" : "FAILED");
+
+    return !passed;
+}
+
+int main(int argc, char *argv[]) {
+    int option;
+
+    while ((option = getopt(argc, argv, "n:h")) != -1) {
+        switch (option) {
+        case 'n':
+            item_count = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-n items]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    int failed = 0;
+    failed |= stress_run(true);
+    failed |= stress_run(false);
+
+    return failed;
+}
@@ -0,0 +1,367 @@
+/**
+ * @file replay_main.c
+ * @brief 기록된 센서 상태를 마크 state machine(mark.c)에 다시 넣어 보는 재생기.
+ *
+ *   linetracer_replay [-u] [-r repeat] [-t tolerance tick] trace.csv ...
+ *     -u           결과로 golden 파일을 새로 쓴다. (트레이스 파일 이름의 .csv를 .golden으로 바꾼 파일, "#" 주석 줄은 남긴다)
+ *     -r <repeat>  처리 속도를 재기 위해 트레이스마다 repeat 번 반복한다. (기본 100)
+ *     -t <tick>    golden과 비교할 때 허용하는 마크 위치의 차이 (기본 MARK_LENGTH_TICK)
+ *
+ * 트레이스는 telemetry_decode가 만드는 blackbox CSV와 같은 형식이다. 첫 줄의 헤더에서
+ * time_us, ir_state, position, encoder_l, encoder_r 열을 찾아 읽고, 다른 열은 무시한다.
+ * 엔코더 값은 이전 값과의 차이를 16비트로 보고 이어 붙이므로, 블랙박스의 하위 16비트 값도 그대로 쓸 수 있다.
+ *
+ * 주행 중(drive.c)과 같이 레코드마다 mark_update_window, mark_update_state를 한 번씩 호출하고,
+ * 결정된 마크와 마크를 처음 본 위치(mark_state_t의 entry, (|왼쪽| + |오른쪽|) / 2)를
+ * golden 파일의 "<mark> <distance>" 줄들과 비교한다.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+
+#include "hal_host.h"
+#include "mark.h"
+#include "motor.h"
+
+#define REPLAY_LINE_MAX 512
+#define REPLAY_MARK_MAX 1024
+
+struct replay_record_t {
+    uint32_t time_us;
+    sensing_ir_state_t ir_state;
+    int position;
+    int32_t encoder[MOTOR_COUNT]; // motor_get_encoder_value가 돌려줄 값
+};
+
+struct replay_mark_t {
+    enum mark_t mark;
+    int32_t distance;
+    uint index; // 마크가 결정된 레코드 번호 (0부터)
+};
+
+static const char *const mark_names[] = {
+    [MARK_NONE] = "none",
+    [MARK_LEFT] = "left",
+    [MARK_RIGHT] = "right",
+    [MARK_BOTH] = "both",
+    [MARK_CROSS] = "cross",
+};
+
+static enum mark_t mark_from_name(const char *name) {
+    for (uint i = MARK_LEFT; i <= MARK_CROSS; i++) {
+        if (strcmp(name, mark_names[i]) == 0) {
+            return i;
+        }
+    }
+    return MARK_NONE;
+}
+
+/**
+ * @brief CSV 헤더에서 이름이 name인 열의 번호를 찾는다.
+ *
+ * @return 열 번호, 찾지 못하면 -1
+ */
+static int csv_column(const char *header, const char *name) {
+    char buffer[REPLAY_LINE_MAX];
+    int column = 0;
+
+    snprintf(buffer, sizeof(buffer), "%s", header);
+    for (char *token = strtok(buffer, ",\r\n"); token; token = strtok(NULL, ",\r\n"), column++) {
+        if (strcmp(token, name) == 0) {
+            return column;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief 트레이스 CSV 파일을 읽는다.
+ *
+ * @return 레코드 수. 실패하면 -1
+ */
+static int replay_load(const char *path, struct replay_record_t **records) {
+    static const char *const columns[] = { "time_us", "ir_state", "position", "encoder_l", "encoder_r" };
+    enum { COLUMN_TIME, COLUMN_IR_STATE, COLUMN_POSITION, COLUMN_ENCODER_L, COLUMN_ENCODER_R, COLUMN_COUNT };
+    int index[COLUMN_COUNT];
+    char line[REPLAY_LINE_MAX];
+
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        perror(path);
+        return -1;
+    }
+
+    if (!fgets(line, sizeof(line), file)) {
+        fprintf(stderr, "%s: empty file\n", path);
+        fclose(file);
+        return -1;
+    }
+    for (int c = 0; c < COLUMN_COUNT; c++) {
+        if ((index[c] = csv_column(line, columns[c])) < 0) {
+            fprintf(stderr, "%s: no '%s' column\n", path, columns[c]);
+            fclose(file);
+            return -1;
+        }
+    }
+
+    int capacity = 4096, count = 0;
+    *records = malloc(sizeof(**records) * capacity);
+
+    long previous[MOTOR_COUNT] = { 0 };
+    int32_t encoder[MOTOR_COUNT] = { 0 };
+
+    while (fgets(line, sizeof(line), file)) {
+        long value[COLUMN_COUNT] = { 0 };
+        int found = 0, column = 0;
+
+        for (char *token = strtok(line, ",\r\n"); token; token = strtok(NULL, ",\r\n"), column++) {
+            for (int c = 0; c < COLUMN_COUNT; c++) {
+                if (column == index[c]) {
+                    value[c] = strtol(token, NULL, 0);
+                    found++;
+                }
+            }
+        }
+        if (found < COLUMN_COUNT) {
+            continue; // 빈 줄 등
+        }
+
+        if (count == capacity) {
+            capacity *= 2;
+            *records = realloc(*records, sizeof(**records) * capacity);
+        }
+
+        struct replay_record_t *record = &(*records)[count];
+        record->time_us = value[COLUMN_TIME];
+        record->ir_state = value[COLUMN_IR_STATE];
+        record->position = value[COLUMN_POSITION];
+        for (int m = 0; m < MOTOR_COUNT; m++) {
+            const long raw = value[COLUMN_ENCODER_L + m];
+            encoder[m] = count == 0 ? (int32_t)raw : encoder[m] + (int16_t)(raw - previous[m]);
+            previous[m] = raw;
+            record->encoder[m] = encoder[m];
+        }
+        count++;
+    }
+    fclose(file);
+
+    return count;
+}
+
+/**
+ * @brief 레코드들을 마크 state machine에 차례로 넣는다.
+ *
+ * @return 결정된 마크 수
+ */
+static uint replay_run(const struct replay_record_t *records, uint count, struct replay_mark_t *marks) {
+    static const int32_t comp[MOTOR_COUNT] = { MOTOR_ENCODER_COMP_LEFT, MOTOR_ENCODER_COMP_RIGHT };
+    struct mark_state_t state = mark_init_state();
+    uint mark_count = 0;
+
+    for (uint i = 0; i < count; i++) {
+        const struct replay_record_t *record = &records[i];
+
+        // 펌웨어가 보게 될 전역 상태를 기록된 값으로 바꾼다. (comp는 1 또는 -1이므로 곱하면 원래 값으로 돌아간다)
+        hal_host.time_us = record->time_us;
+        sensing_ir_state = record->ir_state;
+        sensing_ir_position = record->position;
+        for (int m = 0; m < MOTOR_COUNT; m++) {
+            hal_host.encoder[m] = record->encoder[m] * comp[m];
+        }
+
+        mark_update_window(&state, sensing_ir_position);
+        const enum mark_t mark = mark_update_state(&state);
+        if (mark && mark_count < REPLAY_MARK_MAX) {
+            marks[mark_count++] = (struct replay_mark_t) {
+                .mark = mark,
+                .distance = state.entry,
+                .index = i,
+            };
+        }
+    }
+
+    return mark_count;
+}
+
+static void golden_path(const char *trace, char *path, size_t size) {
+    const char *dot = strrchr(trace, '.');
+    const int length = dot && strcmp(dot, ".csv") == 0 ? (int)(dot - trace) : (int)strlen(trace);
+
+    snprintf(path, size, "%.*s.golden", length, trace);
+}
+
+/**
+ * @brief golden 파일을 새로 쓴다. 기존 파일의 '#' 주석 줄은 그대로 앞에 남긴다. (기존 파일이 없으면 기본 머리말)
+ */
+static int golden_write(const char *path, const struct replay_mark_t *marks, uint count) {
+    static char comments[REPLAY_MARK_MAX * REPLAY_LINE_MAX / 16];
+    char line[REPLAY_LINE_MAX];
+    size_t length = 0;
+
+    FILE *file = fopen(path, "r");
+    if (file) {
+        while (fgets(line, sizeof(line), file)) {
+            const size_t line_length = strlen(line);
+            if (line[0] == '#' && length + line_length + 1 < sizeof(comments)) {
+                memcpy(&comments[length], line, line_length);
+                length += line_length;
+                if (line[line_length - 1] != '\n') {
+                    comments[length++] = '\n';
+                }
+            }
+        }
+        fclose(file);
+    }
+    comments[length] = '\0';
+
+    file = fopen(path, "w");
+    if (!file) {
+        perror(path);
+        return 1;
+    }
+
+    fputs(length > 0 ? comments : "# mark entry(tick)\n", file);
+    for (uint i = 0; i < count; i++) {
+        fprintf(file, "%s %d\n", mark_names[marks[i].mark], marks[i].distance);
+    }
+    fclose(file);
+
+    return 0;
+}
+
+/**
+ * @brief golden 파일을 읽는다.
+ *
+ * @return 마크 수. 파일을 열 수 없으면 -1
+ */
+static int golden_read(const char *path, struct replay_mark_t *marks) {
+    char line[REPLAY_LINE_MAX], name[16];
+    int count = 0, distance;
+
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return -1;
+    }
+    while (fgets(line, sizeof(line), file) && count < REPLAY_MARK_MAX) {
+        if (line[0] != '#' && sscanf(line, "%15s %d", name, &distance) == 2) {
+            marks[count++] = (struct replay_mark_t) { .mark = mark_from_name(name), .distance = distance };
+        }
+    }
+    fclose(file);
+
+    return count;
+}
+
+/**
+ * @brief 재생 결과를 golden과 순서대로 비교한다. print가 참이면 다른 곳을 출력한다.
+ *
+ * @return 다른 곳의 수
+ */
+static uint golden_compare(const struct replay_mark_t *expected, uint expected_count,
+                           const struct replay_mark_t *actual, uint actual_count, int32_t tolerance, bool print) {
+    uint mismatch = 0;
+
+    for (uint i = 0; i < MAX(expected_count, actual_count); i++) {
+        const struct replay_mark_t *e = i < expected_count ? &expected[i] : NULL;
+        const struct replay_mark_t *a = i < actual_count ? &actual[i] : NULL;
+
+        if (e && a && e->mark == a->mark && abs(e->distance - a->distance) <= tolerance) {
+            continue;
+        }
+
+        mismatch++;
+        if (!print) {
+            continue;
+        }
+        printf("    #%-3u expected %-5s %7d  actual %-5s %7d", i + 1,
+               e ? mark_names[e->mark] : "-", e ? e->distance : 0,
+               a ? mark_names[a->mark] : "-", a ? a->distance : 0);
+        if (a) {
+            printf("  (record %u)", a->index);
+        }
+        printf("\n");
+    }
+
+    return mismatch;
+}
+
+int main(int argc, char *argv[]) {
+    bool update = false;
+    int repeat = 100;
+    int32_t tolerance = MARK_LENGTH_TICK;
+    int option;
+
+    while ((option = getopt(argc, argv, "ur:t:h")) != -1) {
+        switch (option) {
+        case 'u': update = true; break;
+        case 'r': repeat = MAX(atoi(optarg), 1); break;
+        case 't': tolerance = atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-u] [-r repeat] [-t tolerance tick] trace.csv ...\n", argv[0]);
+            return 1;
+        }
+    }
+    if (optind >= argc) {
+        fprintf(stderr, "usage: %s [-u] [-r repeat] [-t tolerance tick] trace.csv ...\n", argv[0]);
+        return 1;
+    }
+
+    hal_host_reset();
+
+    static struct replay_mark_t actual[REPLAY_MARK_MAX], expected[REPLAY_MARK_MAX];
+    uint failed = 0;
+
+    for (int t = optind; t < argc; t++) {
+        struct replay_record_t *records;
+        const int count = replay_load(argv[t], &records);
+        if (count < 0) {
+            failed++;
+            continue;
+        }
+
+        // 처리 속도: 같은 트레이스를 반복해서 재생한다. 결과는 매번 같으므로 마지막 결과를 쓴다.
+        uint mark_count = 0;
+        struct timespec begin, end;
+        clock_gettime(CLOCK_MONOTONIC, &begin);
+        for (int r = 0; r < repeat; r++) {
+            mark_count = replay_run(records, count, actual);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        const double elapsed = (end.tv_sec - begin.tv_sec) + (end.tv_nsec - begin.tv_nsec) * 1e-9;
+        const double fps = elapsed > 0 ? (double)count * repeat / elapsed : 0;
+
+        char path[REPLAY_LINE_MAX];
+        golden_path(argv[t], path, sizeof(path));
+
+        if (update) {
+            failed += golden_write(path, actual, mark_count);
+            printf("%-40s %6d records %3u marks  %6.1f M frames/s  written %s\n", argv[t], count, mark_count, fps / 1e6, path);
+        } else {
+            const int expected_count = golden_read(path, expected);
+            if (expected_count < 0) {
+                printf("%-40s %6d records %3u marks  %6.1f M frames/s  NO GOLDEN (%s)\n", argv[t], count, mark_count, fps / 1e6, path);
+                failed++;
+            } else {
+                printf("%-40s %6d records %3u marks  %6.1f M frames/s  ", argv[t], count, mark_count, fps / 1e6);
+                if (golden_compare(expected, expected_count, actual, mark_count, tolerance, false) == 0) {
+                    printf("OK\n");
+                } else {
+                    printf("MISMATCH\n");
+                    golden_compare(expected, expected_count, actual, mark_count, tolerance, true);
+                    failed++;
+                }
+            }
+        }
+
+        free(records);
+    }
+
+    if (failed) {
+        printf("%u of %d traces failed\n", failed, argc - optind);
+    }
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,603 @@
+/**
+ * @file sim.c
+ * @brief 차동 구동 라인트레이서 시뮬레이터
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stddef.h>
+
+#include "sim.h"
+#include "hal_host.h"
+#include "sensing.h"
+#include "motor.h"
+#include "mark.h"
+#include "blackbox.h"
+#include "telemetry_protocol.h"
+#include "switch.h"
+#include "fs.h"
+#include "param.h"
+#include "timer.h"
+
+#define DEG_TO_RAD(X)     ((X) * (float)M_PI / 180.0f)
+#define SIM_ARC_STEP      0.005f // 원호를 polyline으로 나눌 때의 간격
+#define SIM_MARK_LENGTH   0.02f // 진행 방향으로의 마크 길이
+#define SIM_MARK_INNER    0.040f // 라인 중심에서 좌우 마크 안쪽 끝까지의 거리
+#define SIM_MARK_OUTER    0.080f // 라인 중심에서 좌우 마크 바깥쪽 끝까지의 거리
+#define SIM_CROSS_HALF    0.12f // 크로스 마크의 절반 폭
+#define SIM_GRID_CELL     0.05f
+#define SIM_ADC_VOLTAGE_CHANNEL 0
+#define SIM_MONITOR_TIMER_SLOT  (TIMER_SLOT_3)
+#define SIM_MONITOR_INTERVAL_US 1000
+
+/* TRACK */
+
+static void track_add_point(struct sim_track_t *track, float x, float y) {
+    if (track->point_count < SIM_TRACK_POINT_MAX) {
+        track->point[track->point_count][0] = x;
+        track->point[track->point_count][1] = y;
+        track->point_count++;
+    }
+}
+
+static void track_add_patch(struct sim_track_t *track, float x, float y, float heading, float length, float width) {
+    if (track->patch_count < SIM_TRACK_PATCH_MAX) {
+        struct sim_patch_t *patch = &track->patch[track->patch_count++];
+        patch->center[0] = x;
+        patch->center[1] = y;
+        patch->axis[0] = cosf(heading);
+        patch->axis[1] = sinf(heading);
+        patch->half_length = length / 2;
+        patch->half_width = width / 2;
+    }
+}
+
+/**
+ * @brief 현재 위치(x, y)와 방향(heading)에 마크를 놓는다. 방향은 sim.h의 좌표계 설명을 참고한다.
+ */
+static int track_add_mark(struct sim_track_t *track, const char *type, float x, float y, float heading) {
+    const float nx = -sinf(heading), ny = cosf(heading); // 진행 방향의 왼쪽
+    const float side = (SIM_MARK_INNER + SIM_MARK_OUTER) / 2;
+    const float width = SIM_MARK_OUTER - SIM_MARK_INNER;
+    const bool left = strcmp(type, "left") == 0 || strcmp(type, "both") == 0;
+    const bool right = strcmp(type, "right") == 0 || strcmp(type, "both") == 0;
+
+    if (strcmp(type, "cross") == 0) {
+        track_add_patch(track, x, y, heading, SIM_MARK_LENGTH, 2 * SIM_CROSS_HALF);
+        return 0;
+    }
+    if (!left && !right) {
+        return 1;
+    }
+
+    // 펌웨어의 MARK_LEFT는 센서 0~3, 즉 진행 방향의 오른쪽에서 보인다.
+    if (left) {
+        track_add_patch(track, x - nx * side, y - ny * side, heading, SIM_MARK_LENGTH, width);
+    }
+    if (right) {
+        track_add_patch(track, x + nx * side, y + ny * side, heading, SIM_MARK_LENGTH, width);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 선분마다 그 선분에 닿을 수 있는 격자 칸들에 선분 번호를 넣는다.
+ */
+static void track_build_grid(struct sim_track_t *track) {
+    const float reach = track->line_width / 2 + 0.01f;
+    float min[2] = { INFINITY, INFINITY }, max[2] = { -INFINITY, -INFINITY };
+
+    for (uint i = 0; i < track->point_count; i++) {
+        for (int k = 0; k < 2; k++) {
+            min[k] = fminf(min[k], track->point[i][k]);
+            max[k] = fmaxf(max[k], track->point[i][k]);
+        }
+    }
+
+    track->grid_cell = SIM_GRID_CELL;
+    track->grid_origin[0] = min[0] - 1.0f;
+    track->grid_origin[1] = min[1] - 1.0f;
+    track->grid_width = (int)((max[0] - min[0] + 2.0f) / SIM_GRID_CELL) + 1;
+    track->grid_height = (int)((max[1] - min[1] + 2.0f) / SIM_GRID_CELL) + 1;
+
+    const int cell_count = track->grid_width * track->grid_height;
+    uint *count = calloc(cell_count + 1, sizeof(uint));
+
+    // 두 번 훑는다: 처음에는 칸마다 선분 수를 세고, 다음에는 선분 번호를 채운다.
+    for (int pass = 0; pass < 2; pass++) {
+        if (pass == 1) {
+            track->grid_start = calloc(cell_count + 1, sizeof(uint));
+            for (int c = 0; c < cell_count; c++) {
+                track->grid_start[c + 1] = track->grid_start[c] + count[c];
+                count[c] = 0;
+            }
+            track->grid_segment = malloc(sizeof(uint) * (track->grid_start[cell_count] + 1));
+        }
+
+        for (uint i = 0; i + 1 < track->point_count; i++) {
+            const float *a = track->point[i], *b = track->point[i + 1];
+            const int cx0 = (fminf(a[0], b[0]) - reach - track->grid_origin[0]) / SIM_GRID_CELL;
+            const int cx1 = (fmaxf(a[0], b[0]) + reach - track->grid_origin[0]) / SIM_GRID_CELL;
+            const int cy0 = (fminf(a[1], b[1]) - reach - track->grid_origin[1]) / SIM_GRID_CELL;
+            const int cy1 = (fmaxf(a[1], b[1]) + reach - track->grid_origin[1]) / SIM_GRID_CELL;
+
+            for (int cy = cy0; cy <= cy1; cy++) {
+                for (int cx = cx0; cx <= cx1; cx++) {
+                    const int c = cy * track->grid_width + cx;
+                    if (pass == 1) {
+                        track->grid_segment[track->grid_start[c] + count[c]] = i;
+                    }
+                    count[c]++;
+                }
+            }
+        }
+    }
+
+    free(count);
+}
+
+int sim_track_load(struct sim_track_t *track, const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        perror(path);
+        return 1;
+    }
+
+    memset(track, 0, sizeof(*track));
+    track->line_width = 0.019f;
+
+    char line[256];
+    int line_number = 0;
+    float x = 0, y = 0, heading = 0;
+    bool started = false;
+
+    while (fgets(line, sizeof(line), file)) {
+        line_number++;
+        char *comment = strchr(line, '#');
+        if (comment) {
+            *comment = '\0';
+        }
+
+        char command[16], type[16];
+        float a, b, c, d, e;
+        int ok = 1;
+
+        if (sscanf(line, "%15s", command) != 1) {
+            continue; // 빈 줄
+        }
+
+        if (strcmp(command, "width") == 0) {
+            ok = sscanf(line, "%*s %f", &track->line_width) == 1;
+        } else if (strcmp(command, "start") == 0 && (ok = sscanf(line, "%*s %f %f %f", &a, &b, &c) == 3)) {
+            x = track->start[0] = a;
+            y = track->start[1] = b;
+            heading = track->start_heading = DEG_TO_RAD(c);
+            track_add_point(track, x, y);
+            started = true;
+        } else if (strcmp(command, "point") == 0 && (ok = sscanf(line, "%*s %f %f", &a, &b) == 2)) {
+            if (track->point_count > 0) {
+                heading = atan2f(b - y, a - x);
+            }
+            x = a;
+            y = b;
+            track_add_point(track, x, y);
+        } else if (strcmp(command, "straight") == 0 && (ok = started && sscanf(line, "%*s %f", &a) == 1)) {
+            x += a * cosf(heading);
+            y += a * sinf(heading);
+            track_add_point(track, x, y);
+        } else if (strcmp(command, "arc") == 0 && (ok = started && sscanf(line, "%*s %f %f", &a, &b) == 2)) {
+            const float angle = DEG_TO_RAD(b);
+            const int steps = MAX(1, (int)ceilf(fabsf(angle) * a / SIM_ARC_STEP));
+            const float turn = angle > 0 ? 1.0f : -1.0f;
+            // 원호의 중심은 진행 방향의 왼쪽(양수) 또는 오른쪽(음수)에 있다.
+            const float cx = x - turn * a * sinf(heading), cy = y + turn * a * cosf(heading);
+
+            for (int i = 1; i <= steps; i++) {
+                const float h = heading + angle * i / steps;
+                track_add_point(track, cx + turn * a * sinf(h), cy - turn * a * cosf(h));
+            }
+            heading += angle;
+            x = track->point[track->point_count - 1][0];
+            y = track->point[track->point_count - 1][1];
+        } else if (strcmp(command, "mark") == 0 && (ok = sscanf(line, "%*s %15s", type) == 1)) {
+            ok = !track_add_mark(track, type, x, y, heading);
+        } else if (strcmp(command, "patch") == 0 && (ok = sscanf(line, "%*s %f %f %f %f %f", &a, &b, &c, &d, &e) == 5)) {
+            track_add_patch(track, a, b, DEG_TO_RAD(c), d, e);
+        } else if (ok) {
+            ok = 0;
+        }
+
+        if (!ok) {
+            fprintf(stderr, "%s:%d: invalid command\n", path, line_number);
+            fclose(file);
+            return 1;
+        }
+    }
+    fclose(file);
+
+    if (track->point_count < 2) {
+        fprintf(stderr, "%s: the track needs at least two points\n", path);
+        return 1;
+    }
+    if (!started) {
+        track->start[0] = track->point[0][0];
+        track->start[1] = track->point[0][1];
+        track->start_heading = atan2f(track->point[1][1] - track->point[0][1], track->point[1][0] - track->point[0][0]);
+    }
+
+    track_build_grid(track);
+
+    return 0;
+}
+
+void sim_track_free(struct sim_track_t *track) {
+    free(track->grid_start);
+    free(track->grid_segment);
+    track->grid_start = track->grid_segment = NULL;
+}
+
+/**
+ * @brief 점 (x, y)에서 라인 중심선까지의 거리. 격자 밖이거나 근처에 선분이 없으면 매우 큰 값을 반환한다.
+ */
+static float track_distance(const struct sim_track_t *track, float x, float y) {
+    const int cx = (x - track->grid_origin[0]) / track->grid_cell;
+    const int cy = (y - track->grid_origin[1]) / track->grid_cell;
+    float best = INFINITY;
+
+    if (cx < 0 || cy < 0 || cx >= track->grid_width || cy >= track->grid_height) {
+        return best;
+    }
+
+    const int c = cy * track->grid_width + cx;
+    for (uint k = track->grid_start[c]; k < track->grid_start[c + 1]; k++) {
+        const float *a = track->point[track->grid_segment[k]];
+        const float *b = track->point[track->grid_segment[k] + 1];
+        const float dx = b[0] - a[0], dy = b[1] - a[1];
+        const float length2 = dx * dx + dy * dy;
+        float t = length2 > 0 ? ((x - a[0]) * dx + (y - a[1]) * dy) / length2 : 0;
+        t = fminf(fmaxf(t, 0), 1);
+        const float ex = a[0] + t * dx - x, ey = a[1] + t * dy - y;
+        best = fminf(best, ex * ex + ey * ey);
+    }
+
+    return sqrtf(best);
+}
+
+/**
+ * @brief 점 (x, y)가 흰색(라인 또는 마크) 위에 있는 정도를 0 ~ 1 사이 값으로 반환한다.
+ */
+static float track_reflectance(const struct sim_track_t *track, float x, float y, float radius) {
+    for (uint i = 0; i < track->patch_count; i++) {
+        const struct sim_patch_t *p = &track->patch[i];
+        const float dx = x - p->center[0], dy = y - p->center[1];
+        const float along = dx * p->axis[0] + dy * p->axis[1];
+        const float across = -dx * p->axis[1] + dy * p->axis[0];
+        if (fabsf(along) <= p->half_length && fabsf(across) <= p->half_width) {
+            return 1.0f;
+        }
+    }
+
+    // 센서가 보는 원형 영역 중 라인에 걸친 비율을 선형으로 근사한다.
+    const float d = track_distance(track, x, y);
+    const float coverage = (track->line_width / 2 + radius - d) / (2 * radius);
+
+    return fminf(fmaxf(coverage, 0), 1);
+}
+
+/* ROBOT */
+
+static const struct sim_track_t *track;
+static struct sim_robot_t robot;
+
+static struct sim_state_t {
+    float x, y, heading;
+    float wheel[2]; // 바퀴 속도 (엔코더가 재는 속도, MOTOR_LEFT, MOTOR_RIGHT 순서)
+    float ground[2]; // 바퀴가 바닥에 대해 실제로 움직이는 속도
+    double wheel_distance[2]; // 엔코더 기준 누적 거리
+    double distance; // 바닥 기준 누적 거리
+    float max_offset, max_slip;
+    bool blind; // 참이면 모든 센서가 검은색을 본다 (제한 시간 초과 시)
+    uint32_t random;
+    uint mark_count;
+
+    // 같은 인터럽트 안에서 같은 센서를 여러 번 읽을 때 다시 계산하지 않도록 한다.
+    uint32_t cache_time;
+    float cache[SENSING_IR_COUNT];
+    uint16_t cache_valid;
+} state;
+
+static uint32_t deadline; // 제한 시각 (가상 시각)
+
+struct sim_robot_t sim_robot_default(void) {
+    return (struct sim_robot_t) {
+        .track_width = 0.10f,
+        .sensor_ahead = 0.08f,
+        .sensor_pitch = 0.010f,
+        .sensor_radius = 0.004f,
+        .velocity_per_volt = 1.2f,
+        .motor_tau = 0.015f,
+        .motor_tau_free = 0.0f,
+        .traction = 30.0f,
+        .lateral_grip = 50.0f,
+        .battery_voltage = 8.0f,
+        .adc_black = 400,
+        .adc_white = 3400,
+        .adc_noise = 24,
+    };
+}
+
+static const struct {
+    const char *name;
+    size_t offset;
+    bool integer;
+} robot_fields[] = { // sim_robot_set으로 이름을 통해 설정할 수 있는 로봇 모델 파라미터
+    { "track_width", offsetof(struct sim_robot_t, track_width), false },
+    { "sensor_ahead", offsetof(struct sim_robot_t, sensor_ahead), false },
+    { "sensor_pitch", offsetof(struct sim_robot_t, sensor_pitch), false },
+    { "sensor_radius", offsetof(struct sim_robot_t, sensor_radius), false },
+    { "velocity_per_volt", offsetof(struct sim_robot_t, velocity_per_volt), false },
+    { "motor_tau", offsetof(struct sim_robot_t, motor_tau), false },
+    { "motor_tau_free", offsetof(struct sim_robot_t, motor_tau_free), false },
+    { "traction", offsetof(struct sim_robot_t, traction), false },
+    { "lateral_grip", offsetof(struct sim_robot_t, lateral_grip), false },
+    { "battery_voltage", offsetof(struct sim_robot_t, battery_voltage), false },
+    { "adc_black", offsetof(struct sim_robot_t, adc_black), true },
+    { "adc_white", offsetof(struct sim_robot_t, adc_white), true },
+    { "adc_noise", offsetof(struct sim_robot_t, adc_noise), true },
+};
+
+int sim_robot_set(struct sim_robot_t *robot, const char *name, float value) {
+    for (size_t i = 0; i < sizeof(robot_fields) / sizeof(robot_fields[0]); i++) {
+        if (strcmp(robot_fields[i].name, name) == 0) {
+            void *field = (char *)robot + robot_fields[i].offset;
+            if (robot_fields[i].integer) {
+                *(uint *)field = (uint)value;
+            } else {
+                *(float *)field = value;
+            }
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+int sim_param_set(const char *name, float value, float *written) {
+    char buffer[64];
+
+    snprintf(buffer, sizeof(buffer), "%s", name);
+    for (char *c = buffer; *c; c++) {
+        if (*c == '_') {
+            *c = ' ';
+        }
+    }
+
+    const struct param_t *param = param_find(buffer);
+    if (!param) {
+        return 1;
+    }
+
+    const float result = param_write(param, value);
+    if (written) {
+        *written = result;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 모터 index의 PWM 출력으로부터 실제로 인가된 전압을 구한다. 부호는 앞으로 가는 방향이 양수이다.
+ * 펌웨어에서 왼쪽 모터는 목표 값이 감소하는 방향이 전진이므로, duty가 음수일 때 앞으로 간다.
+ */
+static float sim_motor_voltage(enum motor_index index) {
+    static const uint dir_gpio[MOTOR_COUNT] = { MOTOR_DIR_GPIO_LEFT, MOTOR_DIR_GPIO_RIGHT };
+
+    if (!hal_host.pwm_enabled || hal_host.pwm_top == 0) {
+        return 0;
+    }
+
+    float duty = (float)hal_host.pwm_level[index] / hal_host.pwm_top;
+    if (!(hal_host.gpio & (1u << dir_gpio[index]))) {
+        duty = -duty;
+    }
+
+    return (index == MOTOR_LEFT ? -duty : duty) * robot.battery_voltage;
+}
+
+static void sim_step(uint32_t dt_us) {
+    const float dt = dt_us * 1e-6f;
+
+    /*
+     * 모터: 1차 지연, 바퀴: 최대 가속도를 넘으면 미끄러진다.
+     * motor_tau_free가 0이면 바퀴는 바닥과 상관없이 지령을 따르고, 바닥 속도만 traction으로 제한된다.
+     * 0보다 크면 모터의 힘을 로봇 질량당 가속도((지령 속도 - 바퀴 속도) / motor_tau)로 나타내어, 바닥은 traction까지만
+     * 힘을 전하고 남는 힘은 로봇보다 가벼운 바퀴(질량비 motor_tau_free / motor_tau)만 돌린다.
+     * 그래서 미끄러지는 동안 엔코더가 재는 바퀴 속도가 지령보다 빠르게 바뀌고, 펌웨어의 슬립 추정(slip.h)이 이를 볼 수 있다.
+     */
+    for (int i = 0; i < MOTOR_COUNT; i++) {
+        const float v_target = sim_motor_voltage(i) * robot.velocity_per_volt;
+        const float drive = (v_target - state.wheel[i]) / robot.motor_tau;
+        const float slip = state.wheel[i] - state.ground[i];
+
+        if (robot.motor_tau_free <= 0) {
+            const float dv_max = robot.traction * dt;
+            state.wheel[i] += (v_target - state.wheel[i]) * fminf(dt / robot.motor_tau, 1.0f);
+            state.ground[i] += fminf(fmaxf(state.wheel[i] - state.ground[i], -dv_max), dv_max);
+        } else if (fabsf(slip) < 1e-4f && fabsf(drive) <= robot.traction) {
+            state.wheel[i] += (v_target - state.wheel[i]) * fminf(dt / robot.motor_tau, 1.0f);
+            state.ground[i] = state.wheel[i];
+        } else {
+            const float friction = copysignf(robot.traction, fabsf(slip) < 1e-4f ? drive : slip);
+            const float ground = state.ground[i] + friction * dt;
+
+            state.wheel[i] += (drive - friction) * (robot.motor_tau / robot.motor_tau_free) * dt;
+            // 미끄러지는 방향이 바뀌면 다시 붙는다.
+            state.ground[i] = (state.wheel[i] - ground) * friction > 0 ? ground : state.wheel[i];
+        }
+        state.wheel_distance[i] += state.wheel[i] * dt;
+    }
+
+    const float v = (state.ground[MOTOR_LEFT] + state.ground[MOTOR_RIGHT]) / 2;
+    float omega = (state.ground[MOTOR_RIGHT] - state.ground[MOTOR_LEFT]) / robot.track_width;
+
+    // 구심 가속도가 한계를 넘으면 옆으로 미끄러져 더 큰 원을 그린다.
+    if (fabsf(v * omega) > robot.lateral_grip) {
+        omega = copysignf(robot.lateral_grip / fmaxf(fabsf(v), 1e-3f), omega);
+    }
+
+    state.heading += omega * dt;
+    state.x += v * cosf(state.heading) * dt;
+    state.y += v * sinf(state.heading) * dt;
+    state.distance += fabs(v) * dt;
+
+    // 엔코더 값. comp를 곱한 값(motor_get_encoder_value)이 펌웨어의 목표 값과 같은 방향이 되도록 한다.
+    hal_host.encoder[MOTOR_LEFT] = (int32_t)(-state.wheel_distance[MOTOR_LEFT] * MOTOR_TICK_PER_METER) * MOTOR_ENCODER_COMP_LEFT;
+    hal_host.encoder[MOTOR_RIGHT] = (int32_t)(state.wheel_distance[MOTOR_RIGHT] * MOTOR_TICK_PER_METER) * MOTOR_ENCODER_COMP_RIGHT;
+
+    const float odometry = (fabs(state.wheel_distance[0]) + fabs(state.wheel_distance[1])) / 2;
+    state.max_slip = fmaxf(state.max_slip, fabsf(odometry - (float)state.distance));
+}
+
+static uint sim_adc_read(uint channel) {
+    // xorshift 잡음
+    state.random ^= state.random << 13;
+    state.random ^= state.random >> 17;
+    state.random ^= state.random << 5;
+    const int noise = robot.adc_noise ? (int)(state.random % (2 * robot.adc_noise + 1)) - (int)robot.adc_noise : 0;
+
+    if (channel == SIM_ADC_VOLTAGE_CHANNEL) {
+        return robot.battery_voltage / SENSING_EXPR_RAW_TO_VOLTAGE(1.0f) + noise;
+    }
+
+    // MUX 선택 핀으로부터 센서 번호를 구한다. (sensing.c의 ir_order 참고)
+    const uint sel = ((hal_host.gpio >> SENSING_IR_MUX_GPIO_SEL0) & 1) |
+                     ((hal_host.gpio >> SENSING_IR_MUX_GPIO_SEL1) & 1) << 1 |
+                     ((hal_host.gpio >> SENSING_IR_MUX_GPIO_SEL2) & 1) << 2;
+    const uint index = (7 - sel) + (channel == 1 ? 0 : 8);
+
+    float reflectance = 0;
+    if ((hal_host.gpio & (1u << SENSING_IR_MUX_GPIO_OUT)) && !state.blind) {
+        if (state.cache_time != hal_host.time_us) {
+            state.cache_time = hal_host.time_us;
+            state.cache_valid = 0;
+        }
+        if (!(state.cache_valid & (1u << index))) {
+            // 센서 0번이 로봇의 오른쪽 끝이다.
+            const float lateral = ((float)index - (SENSING_IR_COUNT - 1) / 2.0f) * robot.sensor_pitch;
+            const float c = cosf(state.heading), s = sinf(state.heading);
+            const float x = state.x + c * robot.sensor_ahead - s * lateral;
+            const float y = state.y + s * robot.sensor_ahead + c * lateral;
+            state.cache[index] = track_reflectance(track, x, y, robot.sensor_radius);
+            state.cache_valid |= 1u << index;
+        }
+        reflectance = state.cache[index];
+    }
+
+    const int value = robot.adc_black + (robot.adc_white - robot.adc_black) * reflectance + noise;
+    return MIN(MAX(value, 0), 4095);
+}
+
+/**
+ * @brief 주기적으로 로봇의 상태를 확인한다. 라인 중심으로부터의 거리를 기록하고, 제한 시간이 지나면 센서를 가린다.
+ * drive()는 끝날 때까지 반환되지 않으므로, 펌웨어가 쓰지 않는 타이머 슬롯에서 인터럽트처럼 실행한다.
+ */
+static void sim_monitor_handler(void) {
+    const float offset = track_distance(track, state.x, state.y);
+    if (isfinite(offset)) {
+        state.max_offset = fmaxf(state.max_offset, offset);
+    }
+
+    if ((int32_t)(hal_host.time_us - deadline) >= 0) {
+        state.blind = true;
+    }
+}
+
+static void sim_telemetry_hook(uint type, const void *payload, uint length) {
+    (void)payload, (void)length;
+
+    if (type == TELEMETRY_FRAME_MARK) {
+        state.mark_count++;
+    }
+}
+
+void sim_init(const struct sim_track_t *sim_track, const struct sim_robot_t *sim_robot) {
+    track = sim_track;
+    robot = *sim_robot;
+
+    hal_host_reset();
+    fs_init();
+    param_init();
+    switch_init();
+    sensing_init();
+    motor_init();
+
+    // 보정: 센서 값 (ADC >> 4)이 검은 바닥에서 0, 흰 라인에서 255가 되도록 한다.
+    for (int i = 0; i < SENSING_IR_COUNT; i++) {
+        sensing_ir_bias[i] = robot.adc_black >> 4;
+        sensing_ir_range[i] = (robot.adc_white - robot.adc_black) >> 4;
+    }
+
+    // 전압은 센싱 인터럽트에서 갱신되는데, 그 전에 모터 제어가 먼저 실행되면 0으로 나누게 된다.
+    sensing_supply_voltage = robot.battery_voltage;
+}
+
+static void sim_run_seed(enum drive_t type, uint32_t seed, bool merge, float timeout_s, struct sim_result_t *result) {
+    memset(&state, 0, sizeof(state));
+    state.x = track->start[0];
+    state.y = track->start[1];
+    state.heading = track->start_heading;
+    state.random = seed;
+    state.cache_time = UINT32_MAX;
+
+    hal_host.adc_read = sim_adc_read;
+    hal_host.step = sim_step;
+    hal_host.loop_us = 10;
+    telemetry_host_hook = sim_telemetry_hook;
+    for (int i = 0; i < MOTOR_COUNT; i++) {
+        hal_host.encoder[i] = 0;
+    }
+
+    // 1차 주행이 끝나면 마크 저장 여부를 묻는데, 이때 YES를 누른다. 저장된 맵에 합칠지도 물으면 merge에 따라 답한다.
+    switch_init(); // 지난 주행에서 쓰지 않은 입력을 버린다.
+    if (type == DRIVE_FIRST) {
+        switch_host_push(SWITCH_EVENT_LEFT);
+        switch_host_push(merge ? SWITCH_EVENT_LEFT : SWITCH_EVENT_RIGHT);
+    }
+
+    const uint32_t start = hal_host.time_us;
+    deadline = start + (uint32_t)(timeout_s * 1e6f);
+    timer_periodic_start(SIM_MONITOR_TIMER_SLOT, SIM_MONITOR_INTERVAL_US, sim_monitor_handler);
+
+    drive(type, true);
+
+    timer_periodic_stop(SIM_MONITOR_TIMER_SLOT);
+
+    // 주행 시간은 마지막 제어 주기(블랙박스의 마지막 레코드)까지로 한다. 정지 후의 대기와 저장 화면은 포함하지 않는다.
+    const uint count = blackbox_count();
+    const uint32_t end = count ? blackbox_get(count - 1)->time_us : hal_host.time_us;
+
+    memset(result, 0, sizeof(*result));
+    result->timeout = state.blind;
+    result->finished = !state.blind && blackbox_freeze_reason() == BLACKBOX_FREEZE_END;
+    result->line_out = !state.blind && !result->finished;
+    result->lap_time_s = (end - start) * 1e-6f;
+    result->distance_m = state.distance;
+    result->max_offset_m = state.max_offset;
+    result->max_slip_m = state.max_slip;
+    result->mark_count = state.mark_count;
+}
+
+void sim_run(enum drive_t type, float timeout_s, struct sim_result_t *result) {
+    sim_run_seed(type, 0x12345678, false, timeout_s, result);
+}
+
+int sim_run_merge(uint32_t seed, float timeout_s, struct sim_result_t *result) {
+    const uint runs = fs_get_data()->map_run_count;
+
+    sim_run_seed(DRIVE_FIRST, seed, true, timeout_s, result);
+
+    return !result->finished || fs_get_data()->map_run_count != runs + 1;
+}
@@ -0,0 +1,144 @@
+/**
+ * @file sim.h
+ * @brief 트랙 위를 달리는 차동 구동 라인트레이서를 실시간보다 빠르게 흉내내는 호스트 시뮬레이터
+ *
+ * 실제 펌웨어의 sensing, mark, motor, drive 코드를 그대로 사용한다. 시뮬레이터는 hal_host.h의 콜백을 통해
+ * IR 센서와 전압 ADC 값을 만들고, 모터 PWM 출력을 읽어 로봇을 움직이며, 엔코더 값을 돌려준다.
+ *
+ * [ 좌표계 ]
+ * 단위는 m, rad 이다. 로봇의 heading 방향이 +x, 왼쪽이 +y 인 로봇 좌표계를 사용한다.
+ * 펌웨어의 곡률 제어(position이 양수이면 오른쪽 모터가 빨라짐)와 맞도록, IR 센서 0번은 로봇의 오른쪽 끝, 15번은 왼쪽 끝에 둔다.
+ * 따라서 펌웨어가 MARK_LEFT로 판단하는 마크(센서 0~3)는 진행 방향의 오른쪽에 놓인다. 트랙 파일의 mark 명령은 펌웨어 기준의 이름을 쓴다.
+ */
+
+#ifndef _SIM_H_
+#define _SIM_H_
+
+#include "pico/types.h"
+#include "drive.h"
+
+#define SIM_TRACK_POINT_MAX 16384
+#define SIM_TRACK_PATCH_MAX 512
+
+/**
+ * @brief 트랙. 라인의 중심선을 나타내는 polyline과, 마크를 나타내는 직사각형 패치들로 이루어진다.
+ */
+struct sim_track_t {
+    float line_width; // 라인의 폭
+    uint point_count;
+    float point[SIM_TRACK_POINT_MAX][2];
+    uint patch_count;
+    struct sim_patch_t {
+        float center[2];
+        float axis[2]; // 직사각형의 길이 방향 단위 벡터
+        float half_length, half_width;
+    } patch[SIM_TRACK_PATCH_MAX];
+
+    // 로봇의 출발 위치와 방향
+    float start[2];
+    float start_heading;
+
+    // 빠른 거리 계산을 위한 격자. 각 칸에는 그 칸 근처를 지나는 선분의 번호가 들어간다.
+    float grid_origin[2];
+    float grid_cell;
+    int grid_width, grid_height;
+    uint *grid_start; // grid_width * grid_height + 1 개
+    uint *grid_segment;
+};
+
+/**
+ * @brief 로봇의 물리 모델 파라미터
+ */
+struct sim_robot_t {
+    float track_width; // 좌우 바퀴 사이 거리
+    float sensor_ahead; // 바퀴 축으로부터 IR 센서 배열까지의 거리
+    float sensor_pitch; // IR 센서 사이 간격
+    float sensor_radius; // IR 센서가 바닥을 보는 영역의 반지름
+    float velocity_per_volt; // 모터에 인가된 전압 1V당 무부하 바퀴 속도 (m/s)
+    float motor_tau; // 모터 속도 응답의 시정수 (1차 지연)
+    float motor_tau_free; // 바퀴가 미끄러져 로봇을 끌지 않을 때의 시정수 (0이면 바퀴는 미끄러져도 motor_tau로 지령을 따른다)
+    float traction; // 바퀴가 미끄러지지 않고 낼 수 있는 최대 가속도 (m/s^2)
+    float lateral_grip; // 미끄러지지 않고 낼 수 있는 최대 구심 가속도 (m/s^2)
+    float battery_voltage;
+    uint adc_black, adc_white; // 검은 바닥, 흰 라인에서의 ADC 값 (12비트)
+    uint adc_noise; // ADC 잡음의 최대 크기
+};
+
+/**
+ * @brief 주행 한 번의 결과
+ */
+struct sim_result_t {
+    bool finished; // 엔드 마크를 보고 정상적으로 멈췄는지 여부
+    bool line_out; // 라인을 벗어나 멈췄는지 여부
+    bool timeout; // 제한 시간을 넘겼는지 여부
+    float lap_time_s; // 출발부터 멈출 때까지 걸린 시간
+    float distance_m; // 주행 거리 (바닥 기준)
+    float max_offset_m; // 라인 중심으로부터 바퀴 축 중심이 가장 멀리 벗어난 거리
+    float max_slip_m; // 엔코더로 잰 거리와 실제 주행 거리의 최대 차이
+    uint mark_count; // 펌웨어가 판단한 마크 수
+};
+
+/**
+ * @brief 기본 로봇 파라미터를 반환한다.
+ */
+struct sim_robot_t sim_robot_default(void);
+
+/**
+ * @brief 로봇 모델 파라미터를 이름으로 설정한다. 이름은 struct sim_robot_t의 필드 이름과 같다. (예: traction)
+ *
+ * @return 0: 성공, 1: 그런 이름이 없음
+ */
+int sim_robot_set(struct sim_robot_t *robot, const char *name, float value);
+
+/**
+ * @brief 펌웨어 파라미터(param.h)를 이름으로 설정한다. 이름의 '_'는 공백으로 바꿔 찾는다. (예: default_velocity)
+ * 범위를 벗어난 값은 잘라서 쓴다. sim_init 후에 호출해야 한다.
+ *
+ * @param written 실제로 쓰인 값이 저장될 곳. 필요 없으면 NULL
+ * @return 0: 성공, 1: 그런 이름이 없음
+ */
+int sim_param_set(const char *name, float value, float *written);
+
+/**
+ * @brief 트랙 파일을 읽는다. 한 줄에 명령 하나이며 '#' 뒤는 주석이다.
+ *   width <m>                     라인 폭 (기본 0.019)
+ *   start <x> <y> <heading deg>   출발 위치. 이후의 straight, arc는 여기서부터 이어진다.
+ *   point <x> <y>                 polyline에 점을 직접 추가한다.
+ *   straight <length>             현재 방향으로 직선을 그린다.
+ *   arc <radius> <angle deg>      반지름 radius의 원호를 그린다. angle이 양수이면 왼쪽으로 돈다.
+ *   mark <left|right|both|cross>  현재 위치에 마크 패치를 놓는다.
+ *   patch <x> <y> <heading deg> <length> <width>  직사각형 패치를 직접 놓는다.
+ *
+ * @return 0: 성공, 1: 파일을 열 수 없거나 형식이 잘못됨
+ */
+int sim_track_load(struct sim_track_t *track, const char *path);
+
+/**
+ * @brief 트랙 메모리를 해제한다.
+ */
+void sim_track_free(struct sim_track_t *track);
+
+/**
+ * @brief 펌웨어와 가상 하드웨어를 초기화한다. 한 프로세스에서 처음 한 번, 그리고 맵을 지우고 새로 시작할 때 호출한다.
+ * 센서 보정 값은 로봇 파라미터의 ADC 값에 맞춰 설정된다.
+ */
+void sim_init(const struct sim_track_t *track, const struct sim_robot_t *robot);
+
+/**
+ * @brief 로봇을 출발 위치에 두고 주행을 한 번 실행한다. 1차 주행이 엔드 마크로 끝나면 맵을 저장한다.
+ *
+ * @param type DRIVE_FIRST 또는 DRIVE_SECOND
+ * @param timeout_s 가상 시각 기준의 제한 시간. 넘기면 센서를 가려 라인 이탈로 끝낸다.
+ * @param result 결과가 저장될 곳
+ */
+void sim_run(enum drive_t type, float timeout_s, struct sim_result_t *result);
+
+/**
+ * @brief 1차 주행을 한 번 더 실행하고, 엔드 마크로 끝나면 저장된 맵에 합친다 (map_merge).
+ * 센서 잡음의 seed를 바꿔 주행마다 마크 위치가 조금씩 달라지게 한다.
+ *
+ * @return 0: 합침, 1: 합치지 않음 (주행 실패 또는 map_merge가 거부)
+ */
+int sim_run_merge(uint32_t seed, float timeout_s, struct sim_result_t *result);
+
+#endif
@@ -0,0 +1,183 @@
+/**
+ * @file sim_main.c
+ * @brief 시뮬레이터 실행 파일. 트랙 하나에서 1차 주행과 2차 주행을 실행하고 결과를 출력한다.
+ *
+ *   linetracer_sim [track file] [name=value ...]
+ *
+ * name은 펌웨어 파라미터 이름(공백 대신 '_', 예: default_velocity=2.5) 또는 로봇 모델 파라미터(예: robot.traction=20)이다.
+ * merge=N을 주면 1차 주행 후 센서 잡음을 바꾼 1차 주행을 N번 더 하여 맵에 합치고(map_merge), 마크 위치의 통계를 출력한다.
+ * laps=N을 주면 n차 주행을 N번 반복하고, 마지막에 구간별 최고 속도 표(escalate.h)를 출력한다. (escalate=1과 함께 쓴다)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim.h"
+#include "fs.h"
+
+#define SIM_DEFAULT_TRACK "tracks/default.txt"
+#define SIM_TIMEOUT_S     120.0f
+
+static const char *const MARK_NAME[] = { "none", "left", "right", "both", "cross" };
+static const char *const ESCALATE_STATE_NAME[] = { "raising", "held", "backed off" };
+
+/**
+ * @brief 합친 맵의 마크별 평균 위치와 표준편차를 출력한다.
+ */
+static void print_map_stat(void) {
+    const struct fs_data_t *const data = fs_get_data();
+
+    for (uint i = 0; i < data->detected_mark_count; i++) {
+        printf("  mark %-3u %-5s %6.3f m  std %5.1f mm  seen %u/%u\n", i, MARK_NAME[data->detected_mark[i]],
+               data->detected_tick[i] / MOTOR_TICK_PER_METER,
+               map_stat_std(&data->detected_stat[i]) / MOTOR_TICK_PER_METER * 1000, data->detected_stat[i].count,
+               data->map_run_count);
+    }
+}
+
+/**
+ * @brief 1차 주행에서 분류하여 저장한 직선, 곡선 구간을 출력한다.
+ */
+static void print_segments(void) {
+    const struct segment_list_t *const list = &fs_get_data()->segment_list;
+
+    for (uint i = 0; i < list->count; i++) {
+        const struct segment_t *const segment = &list->segment[i];
+
+        printf("  segment %-3u %-8s %6.2f ~ %6.2f m", i, segment->type == SEGMENT_STRAIGHT ? "straight" : "curve",
+               segment->start / MOTOR_TICK_PER_METER, segment->end / MOTOR_TICK_PER_METER);
+        if (segment->type == SEGMENT_CURVE) {
+            printf("  radius %6.2f m  angle %5.0f deg", segment_radius_m(segment), segment->angle * 180 / PI);
+        }
+        printf("\n");
+    }
+}
+
+/**
+ * @brief n차 주행 반복 모드에서 배운 구간별 최고 속도를 출력한다.
+ */
+static void print_escalate(void) {
+    const struct fs_data_t *const data = fs_get_data();
+    const struct escalate_table_t *const table = &data->escalate;
+
+    if (!escalate_is_valid(table, &data->segment_list)) {
+        return;
+    }
+    for (uint i = 0; i < table->count; i++) {
+        printf("  segment %-3u %-8s %5.2f m/s  raised %2u  %s\n", i,
+               data->segment_list.segment[i].type == SEGMENT_STRAIGHT ? "straight" : "curve",
+               table->limit[i].velocity, table->limit[i].raise_count, ESCALATE_STATE_NAME[table->limit[i].state]);
+    }
+}
+
+static void print_result(const char *label, const struct sim_result_t *result) {
+    printf("%-6s %-8s time %7.3f s  distance %6.2f m  marks %3u  max offset %5.1f mm  max slip %5.1f mm\n",
+           label,
+           result->finished ? "finished" : result->timeout ? "timeout" : "line out",
+           result->lap_time_s, result->distance_m, result->mark_count,
+           result->max_offset_m * 1000, result->max_slip_m * 1000);
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = SIM_DEFAULT_TRACK;
+    int first_assignment = 1;
+
+    if (argc > 1 && !strchr(argv[1], '=')) {
+        path = argv[1];
+        first_assignment = 2;
+    }
+
+    static struct sim_track_t track;
+    if (sim_track_load(&track, path)) {
+        return 1;
+    }
+
+    // 로봇 모델 파라미터는 sim_init 전에, 펌웨어 파라미터는 sim_init(param_init) 후에 적용해야 한다.
+    struct sim_robot_t robot = sim_robot_default();
+    for (int i = first_assignment; i < argc; i++) {
+        const char *equal = strchr(argv[i], '=');
+        if (!equal || strncmp(argv[i], "robot.", 6) != 0) {
+            continue;
+        }
+
+        char name[64];
+        snprintf(name, sizeof(name), "%.*s", (int)(equal - argv[i] - 6), argv[i] + 6);
+        if (sim_robot_set(&robot, name, strtof(equal + 1, NULL))) {
+            fprintf(stderr, "unknown robot parameter: %s\n", name);
+            return 1;
+        }
+    }
+
+    sim_init(&track, &robot);
+
+    for (int i = first_assignment; i < argc; i++) {
+        const char *equal = strchr(argv[i], '=');
+        if (!equal) {
+            fprintf(stderr, "expected name=value: %s\n", argv[i]);
+            return 1;
+        }
+        if (strncmp(argv[i], "robot.", 6) == 0 || strncmp(argv[i], "merge=", 6) == 0 ||
+            strncmp(argv[i], "laps=", 5) == 0) {
+            continue;
+        }
+
+        char name[64];
+        snprintf(name, sizeof(name), "%.*s", (int)(equal - argv[i]), argv[i]);
+        const float value = strtof(equal + 1, NULL);
+        float written;
+        if (sim_param_set(name, value, &written)) {
+            fprintf(stderr, "unknown parameter: %s\n", name);
+            return 1;
+        }
+        if (written != value) {
+            fprintf(stderr, "%s: clamped to %g\n", name, written);
+        }
+    }
+
+    struct sim_result_t first, second;
+
+    sim_run(DRIVE_FIRST, SIM_TIMEOUT_S, &first);
+    print_result("first", &first);
+    print_segments();
+
+    // merge=N: 센서 잡음을 바꾼 1차 주행을 더 하여 맵에 합친다.
+    for (int i = first_assignment; i < argc; i++) {
+        if (strncmp(argv[i], "merge=", 6) != 0) {
+            continue;
+        }
+        const int runs = atoi(argv[i] + 6);
+        for (int r = 0; r < runs; r++) {
+            struct sim_result_t merged;
+            const int rejected = sim_run_merge(0x9E3779B9u * (r + 1), SIM_TIMEOUT_S, &merged);
+            printf("merge  %-8s time %7.3f s  %s\n", merged.finished ? "finished" : "failed", merged.lap_time_s,
+                   rejected ? "rejected" : "merged");
+        }
+        print_map_stat();
+    }
+    if (!first.finished) {
+        sim_track_free(&track);
+        return 2;
+    }
+
+    // laps=N: n차 주행을 반복한다.
+    int laps = 1;
+    for (int i = first_assignment; i < argc; i++) {
+        if (strncmp(argv[i], "laps=", 5) == 0) {
+            laps = atoi(argv[i] + 5);
+        }
+    }
+    for (int lap = 1; lap <= laps; lap++) {
+        char label[16];
+        snprintf(label, sizeof(label), laps > 1 ? "lap%d" : "second", lap);
+        sim_run(DRIVE_SECOND, SIM_TIMEOUT_S, &second);
+        print_result(label, &second);
+    }
+    if (laps > 1) {
+        print_escalate();
+    }
+
+    sim_track_free(&track);
+
+    return second.finished ? 0 : 2;
+}
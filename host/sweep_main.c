@@ -0,0 +1,519 @@
+/**
+ * @file sweep_main.c
+ * @brief 주행 파라미터 탐색기. 파라미터 조합마다 시뮬레이터(sim.h)로 1차, 2차 주행을 실행하고 결과를 정리한다.
+ *
+ *   linetracer_sweep [options] name=min:max[:steps] ... [name=value ...] [robot.name=value ...]
+ *     -t <track>   트랙 파일 (기본 tracks/default.txt)
+ *     -j <jobs>    동시에 실행할 프로세스 수 (기본: CPU 코어 수)
+ *     -n <count>   격자 대신 범위 안에서 count 개의 조합을 무작위로 뽑는다.
+ *     -b <count>   격자 대신 TPE(Bayesian 최적화)로 count 개의 조합을 뽑는다. 앞의 결과가 좋았던 곳 근처를 더 뽑는다.
+ *     -s <seed>    무작위, TPE 탐색의 seed (기본 1)
+ *     -o <file>    모든 결과를 저장할 CSV (기본 sweep_results.csv)
+ *     -p <file>    Pareto front를 저장할 CSV (기본 sweep_pareto.csv)
+ *
+ * name은 linetracer_sim과 같이 펌웨어 파라미터 이름의 공백을 '_'로 바꾼 것이다.
+ * (default_velocity, peak_velocity, accel, decel, curvature_coefficient, curve_deceleration, safe_distance, fit_in 등)
+ *
+ * 펌웨어는 전역 변수로 상태를 가지므로, 한 프로세스 안에서 여러 주행을 동시에 실행할 수 없다.
+ * 따라서 작업자는 스레드가 아닌 fork한 프로세스이며, 공유 메모리의 카운터에서 다음 조합 번호를 하나씩 가져간다.
+ * 먼저 끝난 작업자가 남은 조합을 계속 가져가므로, 주행 시간이 조합마다 달라도 코어가 놀지 않는다.
+ *
+ * TPE 탐색은 앞의 결과로 다음 조합을 정하므로, 작업자 수만큼씩 묶어서 실행한다. 묶음마다 부모 프로세스가
+ * 지금까지의 결과로 조합을 정해 공유 메모리에 써 두고, 작업자들이 모두 끝나면 다음 묶음을 정한다.
+ * 처음 SWEEP_TPE_STARTUP 비율(최소 작업자 수)은 무작위 탐색과 같은 조합이다.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "sim.h"
+
+#define SWEEP_PARAM_MAX   16
+#define SWEEP_NAME_MAX    48
+#define SWEEP_TIMEOUT_S   60.0f
+#define SWEEP_TOP_COUNT   10
+#define SWEEP_DEFAULT_TRACK "tracks/default.txt"
+
+#define SWEEP_TPE_STARTUP   0.25f // 처음에 무작위로 뽑는 비율
+#define SWEEP_TPE_GAMMA     0.25f // 랭킹 앞쪽에서 좋은 조합으로 보는 비율
+#define SWEEP_TPE_SAMPLES   24 // 조합 하나를 정할 때 l(x)에서 뽑아 비교하는 후보 수
+#define SWEEP_TPE_BANDWIDTH 0.5f // 커널의 표준편차 (범위 대비, 결과 수의 -1/5 제곱을 곱한다)
+
+/**
+ * @brief 탐색할(또는 고정할) 파라미터 하나. 고정 값은 min == max, steps == 1 이다.
+ */
+struct sweep_param_t {
+    char name[SWEEP_NAME_MAX];
+    float min, max;
+    uint steps;
+};
+
+/**
+ * @brief 조합 하나의 결과. 작업자 프로세스가 공유 메모리에 직접 쓴다.
+ */
+struct sweep_result_t {
+    float value[SWEEP_PARAM_MAX];
+    struct sim_result_t first, second;
+    bool done;
+};
+
+struct sweep_shared_t {
+    atomic_uint next; // 다음에 가져갈 조합 번호
+    atomic_uint done; // 끝난 조합 수
+    uint total; // 조합 수
+    struct sweep_result_t result[];
+};
+
+static struct sweep_param_t params[SWEEP_PARAM_MAX];
+static uint param_count = 0;
+static uint random_count = 0;
+static uint tpe_count = 0;
+static uint seed = 1;
+
+/**
+ * @brief xorshift32. [0, 1) 범위의 값을 반환한다.
+ */
+static float sweep_random(uint32_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return (*state >> 8) / (float)(1u << 24);
+}
+
+/**
+ * @brief 조합 번호 index에 해당하는 파라미터 값들을 구한다.
+ * 격자 탐색에서는 index를 각 파라미터의 단계 수로 이루어진 혼합 진법 수로 본다.
+ * 무작위 탐색에서는 (seed, index)로부터 값을 만들므로, 어느 작업자가 실행하더라도 같은 조합이 된다.
+ */
+static void sweep_candidate(uint index, float *value) {
+    uint32_t random = seed * 2654435761u ^ (index + 1) * 40503u;
+
+    for (uint k = 0; k < param_count; k++) {
+        const struct sweep_param_t *param = &params[k];
+        float t;
+
+        if (param->steps <= 1) {
+            t = 0;
+        } else if (random_count || tpe_count) {
+            t = sweep_random(&random);
+        } else {
+            t = (float)(index % param->steps) / (param->steps - 1);
+            index /= param->steps;
+        }
+
+        value[k] = param->min + (param->max - param->min) * t;
+    }
+}
+
+/**
+ * @brief 값 x들에 가우시안 커널(표준편차 sigma)을 씌우고 범위 전체의 균등 분포를 하나 더한 밀도
+ */
+static float sweep_tpe_density(float x, const float *points, uint count, float sigma, float range) {
+    float sum = 1.0f / range;
+    for (uint i = 0; i < count; i++) {
+        const float z = (x - points[i]) / sigma;
+        sum += expf(-0.5f * z * z) / (sigma * 2.5066283f);
+    }
+    return sum / (count + 1);
+}
+
+/**
+ * @brief TPE(Tree-structured Parzen Estimator)로 조합 번호 index의 파라미터 값들을 정한다.
+ * 지금까지의 결과를 랭킹 순서로 두고, 앞쪽 SWEEP_TPE_GAMMA 비율을 좋은 조합, 나머지를 나쁜 조합으로 나눈다.
+ * 파라미터마다 두 집합의 값으로 밀도 l(x), g(x)를 만들고, l(x)에서 SWEEP_TPE_SAMPLES 개를 뽑아
+ * l(x) / g(x)가 가장 큰 것을 고른다. 파라미터들은 서로 독립이라고 본다.
+ *
+ * @param ranked 지금까지의 결과 (랭킹 순서), count 개
+ */
+static void sweep_tpe_candidate(struct sweep_result_t *const *ranked, uint count, uint index, float *value) {
+    uint32_t random = seed * 2654435761u ^ (index + 1) * 40503u;
+    const uint good = MAX(1, (uint)ceilf(SWEEP_TPE_GAMMA * count));
+    const uint bad = count - good;
+
+    float *points = malloc(sizeof(float) * count);
+    float best_score = -INFINITY;
+    float sample[SWEEP_PARAM_MAX];
+
+    for (uint s = 0; s < SWEEP_TPE_SAMPLES; s++) {
+        float score = 0.0f;
+
+        for (uint k = 0; k < param_count; k++) {
+            const struct sweep_param_t *param = &params[k];
+            if (param->steps <= 1) {
+                sample[k] = param->min;
+                continue;
+            }
+            const float range = param->max - param->min;
+            for (uint i = 0; i < count; i++) {
+                points[i] = ranked[i]->value[k];
+            }
+            const float sigma_good = range * SWEEP_TPE_BANDWIDTH * powf(good, -0.2f);
+            const float sigma_bad = range * SWEEP_TPE_BANDWIDTH * powf(MAX(bad, 1), -0.2f);
+
+            // l(x)에서 뽑는다: 좋은 조합 하나를 골라 그 주변, 또는 범위 전체에서 균등하게
+            const uint pick = (uint)(sweep_random(&random) * (good + 1));
+            float x;
+            if (pick >= good) {
+                x = param->min + range * sweep_random(&random);
+            } else {
+                const float u = 1.0f - sweep_random(&random);
+                const float normal = sqrtf(-2.0f * logf(u)) * cosf(6.2831853f * sweep_random(&random));
+                x = fminf(fmaxf(points[pick] + sigma_good * normal, param->min), param->max);
+            }
+            sample[k] = x;
+
+            score += logf(sweep_tpe_density(x, points, good, sigma_good, range)) -
+                     logf(sweep_tpe_density(x, points + good, bad, sigma_bad, range));
+        }
+
+        if (score > best_score) {
+            best_score = score;
+            memcpy(value, sample, sizeof(float) * param_count);
+        }
+    }
+
+    free(points);
+}
+
+static void sweep_evaluate(const struct sim_track_t *track, const struct sim_robot_t *robot, struct sweep_result_t *result) {
+    sim_init(track, robot);
+    for (uint k = 0; k < param_count; k++) {
+        sim_param_set(params[k].name, result->value[k], &result->value[k]);
+    }
+
+    sim_run(DRIVE_FIRST, SWEEP_TIMEOUT_S, &result->first);
+    if (result->first.finished) {
+        sim_run(DRIVE_SECOND, SWEEP_TIMEOUT_S, &result->second);
+    }
+}
+
+/**
+ * @brief 두 주행을 모두 마쳤는지 확인한다. 2차 주행에서 1차 주행과 다른 수의 마크를 보았다면 미끄러지며
+ * 트랙을 가로질러 끝 마크에 닿은 것이므로 마치지 못한 것으로 본다. (TPE 탐색은 이런 조합을 잘 찾아낸다)
+ */
+static inline bool sweep_feasible(const struct sweep_result_t *result) {
+    return result->first.finished && result->second.finished && result->second.mark_count == result->first.mark_count;
+}
+
+/**
+ * @brief 랭킹 순서: 두 주행을 모두 마친 조합이 먼저이며, 그 안에서는 2차 주행 시간이 짧은 순서이다.
+ */
+static int sweep_compare(const void *a, const void *b) {
+    const struct sweep_result_t *ra = *(const struct sweep_result_t *const *)a;
+    const struct sweep_result_t *rb = *(const struct sweep_result_t *const *)b;
+
+    if (sweep_feasible(ra) != sweep_feasible(rb)) {
+        return sweep_feasible(ra) ? -1 : 1;
+    }
+    if (ra->second.lap_time_s != rb->second.lap_time_s) {
+        return ra->second.lap_time_s < rb->second.lap_time_s ? -1 : 1;
+    }
+    return ra->second.max_offset_m < rb->second.max_offset_m ? -1 : ra->second.max_offset_m > rb->second.max_offset_m;
+}
+
+static void sweep_write_header(FILE *file) {
+    fprintf(file, "rank");
+    for (uint k = 0; k < param_count; k++) {
+        fprintf(file, ",%s", params[k].name);
+    }
+    fprintf(file, ",first_result,first_time_s,second_result,second_time_s,second_max_offset_mm,second_max_slip_mm,second_marks\n");
+}
+
+static const char *sweep_result_name(const struct sim_result_t *result) {
+    return result->finished ? "finished" : result->timeout ? "timeout" : result->line_out ? "line_out" : "skipped";
+}
+
+static void sweep_write_row(FILE *file, uint rank, const struct sweep_result_t *result) {
+    fprintf(file, "%u", rank);
+    for (uint k = 0; k < param_count; k++) {
+        fprintf(file, ",%g", result->value[k]);
+    }
+    fprintf(file, ",%s,%.4f,%s,%.4f,%.2f,%.2f,%u\n",
+            sweep_result_name(&result->first), result->first.lap_time_s,
+            sweep_result_name(&result->second), result->second.lap_time_s,
+            result->second.max_offset_m * 1000, result->second.max_slip_m * 1000, result->second.mark_count);
+}
+
+/**
+ * @brief 문자열 "name=min:max[:steps]" 또는 "name=value"를 해석한다.
+ *
+ * @return 0: 성공, 1: 형식이 잘못됨
+ */
+static int sweep_parse_param(const char *text, struct sweep_param_t *param) {
+    const char *equal = strchr(text, '=');
+    if (!equal || equal == text || equal - text >= SWEEP_NAME_MAX) {
+        return 1;
+    }
+    snprintf(param->name, sizeof(param->name), "%.*s", (int)(equal - text), text);
+
+    int steps = 0;
+    const int fields = sscanf(equal + 1, "%f:%f:%d", &param->min, &param->max, &steps);
+    if (fields == 1) {
+        param->max = param->min;
+        param->steps = 1;
+    } else if (fields >= 2) {
+        param->steps = fields == 3 ? steps : 5;
+        if (param->steps < 1) {
+            return 1;
+        }
+    } else {
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 작업자 프로세스 jobs 개를 띄워 조합 [begin, end)를 실행하고, 모두 끝날 때까지 기다린다.
+ * TPE 탐색에서는 부모가 값을 미리 써 두고, 그 밖에는 작업자가 조합 번호로 값을 구한다.
+ *
+ * @return 0: 성공, 1: fork 실패
+ */
+static int sweep_batch(struct sweep_shared_t *shared, uint begin, uint end, long jobs, const struct sim_track_t *track,
+                       const struct sim_robot_t *robot, bool progress) {
+    atomic_store(&shared->next, begin);
+    jobs = MIN(jobs, (long)(end - begin));
+
+    for (long j = 0; j < jobs; j++) {
+        const pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            return 1;
+        }
+        if (pid == 0) {
+            uint index;
+            while ((index = atomic_fetch_add(&shared->next, 1)) < end) {
+                struct sweep_result_t *result = &shared->result[index];
+                if (!tpe_count) {
+                    sweep_candidate(index, result->value);
+                }
+                sweep_evaluate(track, robot, result);
+                result->done = true;
+                atomic_fetch_add(&shared->done, 1);
+            }
+            _exit(0);
+        }
+    }
+
+    // 작업자가 모두 끝날 때까지 기다린다. 터미널이면 진행 상황을 보여준다.
+    for (long remaining = jobs; remaining > 0;) {
+        int status;
+        while (remaining > 0 && waitpid(-1, &status, WNOHANG) > 0) {
+            remaining--;
+        }
+        if (progress) {
+            fprintf(stderr, "\r%u / %u", atomic_load(&shared->done), shared->total);
+        }
+        if (remaining > 0) {
+            usleep(20 * 1000); // TPE 묶음 사이에 코어가 오래 놀지 않도록 짧게 기다린다.
+        }
+    }
+
+    return 0;
+}
+
+static void usage(const char *program) {
+    fprintf(stderr,
+            "usage: %s [-t track] [-j jobs] [-n random count | -b TPE count] [-s seed] [-o results.csv] [-p pareto.csv]\n"
+            "       name=min:max[:steps] ... [name=value ...] [robot.name=value ...]\n",
+            program);
+}
+
+int main(int argc, char *argv[]) {
+    const char *track_path = SWEEP_DEFAULT_TRACK;
+    const char *results_path = "sweep_results.csv";
+    const char *pareto_path = "sweep_pareto.csv";
+    long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    int option;
+
+    while ((option = getopt(argc, argv, "t:j:n:b:s:o:p:h")) != -1) {
+        switch (option) {
+        case 't': track_path = optarg; break;
+        case 'j': jobs = atol(optarg); break;
+        case 'n': random_count = atoi(optarg); break;
+        case 'b': tpe_count = atoi(optarg); break;
+        case 's': seed = atoi(optarg); break;
+        case 'o': results_path = optarg; break;
+        case 'p': pareto_path = optarg; break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+    jobs = MAX(jobs, 1);
+
+    static struct sim_track_t track;
+    struct sim_robot_t robot = sim_robot_default();
+
+    for (int i = optind; i < argc; i++) {
+        if (strncmp(argv[i], "robot.", 6) == 0) {
+            const char *equal = strchr(argv[i], '=');
+            char name[SWEEP_NAME_MAX];
+            snprintf(name, sizeof(name), "%.*s", equal ? (int)(equal - argv[i] - 6) : 0, argv[i] + 6);
+            if (!equal || sim_robot_set(&robot, name, strtof(equal + 1, NULL))) {
+                fprintf(stderr, "invalid robot parameter: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (param_count == SWEEP_PARAM_MAX || sweep_parse_param(argv[i], &params[param_count])) {
+            fprintf(stderr, "invalid parameter: %s\n", argv[i]);
+            usage(argv[0]);
+            return 1;
+        } else {
+            param_count++;
+        }
+    }
+
+    if (sim_track_load(&track, track_path)) {
+        return 1;
+    }
+
+    // 이름과 범위를 작업자를 띄우기 전에 한 번 확인한다.
+    sim_init(&track, &robot);
+    for (uint k = 0; k < param_count; k++) {
+        float written[2];
+        if (sim_param_set(params[k].name, params[k].min, &written[0]) ||
+            sim_param_set(params[k].name, params[k].max, &written[1])) {
+            fprintf(stderr, "unknown parameter: %s\n", params[k].name);
+            return 1;
+        }
+        if (written[0] != params[k].min || written[1] != params[k].max) {
+            fprintf(stderr, "%s: range clamped to %g:%g\n", params[k].name, written[0], written[1]);
+            params[k].min = written[0];
+            params[k].max = written[1];
+        }
+    }
+
+    uint64_t total = 1;
+    if (random_count && tpe_count) {
+        fprintf(stderr, "-n and -b cannot be used together\n");
+        return 1;
+    }
+    if (random_count || tpe_count) {
+        total = random_count + tpe_count;
+    } else {
+        for (uint k = 0; k < param_count; k++) {
+            total *= params[k].steps;
+        }
+    }
+    if (total > 10000000) {
+        fprintf(stderr, "too many candidates: %llu\n", (unsigned long long)total);
+        return 1;
+    }
+
+    const size_t shared_size = sizeof(struct sweep_shared_t) + sizeof(struct sweep_result_t) * total;
+    struct sweep_shared_t *shared = mmap(NULL, shared_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    atomic_init(&shared->next, 0);
+    atomic_init(&shared->done, 0);
+    shared->total = total;
+
+    jobs = MIN(jobs, (long)total);
+    fprintf(stderr, "%llu candidates, %ld jobs\n", (unsigned long long)total, jobs);
+
+    const bool progress = isatty(STDERR_FILENO);
+    struct sweep_result_t **ranked = malloc(sizeof(*ranked) * total);
+
+    if (!tpe_count) {
+        if (sweep_batch(shared, 0, total, jobs, &track, &robot, progress)) {
+            return 1;
+        }
+    } else {
+        // TPE: 처음에는 무작위로, 그 뒤로는 작업자 수만큼씩 지금까지의 결과로 정한다.
+        const uint startup = MIN(total, MAX((uint)(SWEEP_TPE_STARTUP * total), (uint)jobs));
+        for (uint begin = 0, end; begin < total; begin = end) {
+            end = begin == 0 ? startup : MIN(begin + (uint)jobs, total);
+            if (begin > 0) {
+                uint count = 0;
+                for (uint i = 0; i < begin; i++) {
+                    if (shared->result[i].done) {
+                        ranked[count++] = &shared->result[i];
+                    }
+                }
+                qsort(ranked, count, sizeof(*ranked), sweep_compare);
+                for (uint i = begin; i < end; i++) {
+                    if (count > 0) {
+                        sweep_tpe_candidate(ranked, count, i, shared->result[i].value);
+                    } else {
+                        sweep_candidate(i, shared->result[i].value);
+                    }
+                }
+            }
+            if (sweep_batch(shared, begin, end, jobs, &track, &robot, progress)) {
+                return 1;
+            }
+        }
+    }
+    if (progress) {
+        fprintf(stderr, "\n");
+    }
+
+    // 랭킹
+    uint count = 0;
+    for (uint64_t i = 0; i < total; i++) {
+        if (shared->result[i].done) {
+            ranked[count++] = &shared->result[i];
+        }
+    }
+    if (count < total) {
+        fprintf(stderr, "%llu candidates were not evaluated (worker crashed?)\n", (unsigned long long)(total - count));
+    }
+    qsort(ranked, count, sizeof(*ranked), sweep_compare);
+
+    FILE *file = fopen(results_path, "w");
+    if (!file) {
+        perror(results_path);
+        return 1;
+    }
+    sweep_write_header(file);
+    for (uint i = 0; i < count; i++) {
+        sweep_write_row(file, i + 1, ranked[i]);
+    }
+    fclose(file);
+
+    /*
+     * Pareto front: 두 주행을 모두 마친 조합 중, 2차 주행 시간과 라인 중심으로부터의 최대 거리(여유)
+     * 둘 다에서 더 나은 다른 조합이 없는 조합들. 랭킹이 시간 순서이므로, 지금까지의 최소 거리보다 작은 것만 남기면 된다.
+     */
+    file = fopen(pareto_path, "w");
+    if (!file) {
+        perror(pareto_path);
+        return 1;
+    }
+    sweep_write_header(file);
+    float best_offset = INFINITY;
+    uint feasible = 0, front = 0;
+    for (uint i = 0; i < count && sweep_feasible(ranked[i]); i++) {
+        feasible++;
+        if (ranked[i]->second.max_offset_m < best_offset) {
+            best_offset = ranked[i]->second.max_offset_m;
+            sweep_write_row(file, i + 1, ranked[i]);
+            front++;
+        }
+    }
+    fclose(file);
+
+    printf("%u / %u candidates finished both drives, %u on the Pareto front\n", feasible, count, front);
+    for (uint i = 0; i < MIN(feasible, SWEEP_TOP_COUNT); i++) {
+        printf("%2u. %7.3f s  offset %5.1f mm ", i + 1, ranked[i]->second.lap_time_s, ranked[i]->second.max_offset_m * 1000);
+        for (uint k = 0; k < param_count; k++) {
+            if (params[k].steps > 1) {
+                printf(" %s=%g", params[k].name, ranked[i]->value[k]);
+            }
+        }
+        printf("\n");
+    }
+
+    free(ranked);
+    munmap(shared, shared_size);
+    sim_track_free(&track);
+
+    return 0;
+}
@@ -0,0 +1,30 @@
+/**
+ * @file switch_host.c
+ * @brief switch.h의 호스트 구현. 미리 넣어둔 입력을 차례로 돌려준다.
+ */
+
+#include "switch.h"
+#include "hal_host.h"
+
+#define SWITCH_HOST_QUEUE_SIZE 16
+
+static uint queue[SWITCH_HOST_QUEUE_SIZE];
+static uint queue_head = 0, queue_tail = 0;
+
+void switch_init(void) {
+    queue_head = queue_tail = 0;
+}
+
+void switch_host_push(uint event) {
+    if (queue_tail - queue_head < SWITCH_HOST_QUEUE_SIZE) {
+        queue[queue_tail++ % SWITCH_HOST_QUEUE_SIZE] = event;
+    }
+}
+
+enum switch_event_t switch_read(void) {
+    if (queue_head == queue_tail) {
+        return SWITCH_EVENT_BOTH;
+    }
+
+    return queue[queue_head++ % SWITCH_HOST_QUEUE_SIZE];
+}
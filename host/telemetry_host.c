@@ -0,0 +1,44 @@
+/**
+ * @file telemetry_host.c
+ * @brief telemetry.h와 command.h의 호스트 구현. USB가 없으므로 프레임은 telemetry_host_hook(hal_host.h)에만 전달한다.
+ */
+
+#include "telemetry.h"
+#include "command.h"
+#include "hal_host.h"
+
+volatile uint telemetry_streams = 0;
+volatile uint telemetry_dropped = 0;
+
+void (*telemetry_host_hook)(uint type, const void *payload, uint length) = NULL;
+
+void telemetry_push(uint type, const void *payload, uint length) {
+    if (telemetry_host_hook) {
+        telemetry_host_hook(type, payload, length);
+    }
+}
+
+void telemetry_flush(void) {
+}
+
+bool telemetry_connected(void) {
+    return false;
+}
+
+uint telemetry_pending(void) {
+    return 0;
+}
+
+void telemetry_start(uint streams) {
+    (void)streams;
+}
+
+void telemetry_stop(void) {
+}
+
+void telemetry_print(const char *text) {
+    (void)text;
+}
+
+void command_poll(void) {
+}
@@ -0,0 +1,248 @@
+/**
+ * @file telemetry_loopback_main.c
+ * @brief telemetry.c가 보낸 바이트열을 호스트 parser(telemetry_protocol.h)로 다시 읽어 프레임이 그대로 오는지 검사하는 테스트
+ *
+ *   linetracer_telemetry_loopback
+ *
+ * USB 대신 hal_host.usb_write로 바이트를 받아 모은다. 펌웨어와 같은 ring buffer, COBS, CRC 코드를 거친다.
+ * 1. 왕복: 센싱, 제어, 마크 프레임을 넣고 중간중간 보낸다. 받은 프레임은 넣은 순서, 내용과 같아야 한다.
+ * 2. 송신 버퍼: USB 송신 버퍼의 빈 자리가 작으면 한 번에 그 안에 들어가는 완전한 프레임만 보내야 한다.
+ * 3. 버림: ring buffer가 가득 차서 버려진 프레임 수와 수신 측이 seq로 센 빠진 프레임 수가 같아야 한다.
+ * 4. CRC: 전송 중 한 바이트가 바뀐 프레임은 버려지고, 뒤의 프레임은 그대로 받아야 한다.
+ * 실패하면 종료 코드 1을 반환한다.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hal_host.h"
+#include "telemetry.h"
+
+#define LOOPBACK_CAPACITY (64 * 1024)
+#define LOOPBACK_FRAME_MAX (1024)
+
+// 받은 바이트열과, usb_write 한 번에 받은 길이들
+static uint8_t received[LOOPBACK_CAPACITY];
+static uint received_length;
+static uint write_count;
+static uint write_over_budget; // 빈 자리보다 길게 보낸 횟수
+static uint write_split; // 프레임 중간에서 끝난 횟수
+
+// 넣은 프레임들 (seq는 telemetry.c와 같이 넣을 때마다 1씩 증가한다)
+static struct loopback_frame_t {
+    uint8_t type;
+    uint8_t seq;
+    uint8_t length;
+    uint8_t payload[TELEMETRY_PAYLOAD_MAX];
+} sent[LOOPBACK_FRAME_MAX];
+static uint sent_count;
+static uint8_t next_seq;
+
+static void loopback_write(const void *data, uint length) {
+    if (length > hal_host.usb_write_available) {
+        write_over_budget++;
+    }
+    if (length > 0 && ((const uint8_t *)data)[length - 1] != 0x00) {
+        write_split++;
+    }
+    if (received_length + length <= sizeof(received)) {
+        memcpy(&received[received_length], data, length);
+        received_length += length;
+    }
+    write_count++;
+}
+
+static void loopback_reset(uint write_available) {
+    received_length = 0;
+    write_count = write_over_budget = write_split = 0;
+    sent_count = 0;
+    hal_host.usb_write = loopback_write;
+    hal_host.usb_write_available = write_available;
+    telemetry_start(TELEMETRY_STREAM_ALL);
+}
+
+/**
+ * @brief 번호 n으로부터 정해지는 내용의 프레임을 만들어 넣는다. 버려진 프레임도 seq는 증가한다.
+ */
+static void loopback_push(uint n) {
+    struct loopback_frame_t frame = { .seq = next_seq++ };
+
+    switch (n % 3) {
+    case 0: {
+        struct telemetry_sensing_t f = {
+            .time_us = n * 500, .ir_state = n * 31, .position = n * 97 - 30000, .position_limited = n, .voltage_mv = 7400,
+        };
+        for (int i = 0; i < 16; i++) {
+            f.normalized[i] = n + i; // 0x00도 섞이도록 COBS 블록을 여러 개 만든다.
+        }
+        frame.type = TELEMETRY_FRAME_SENSING;
+        frame.length = sizeof(f);
+        memcpy(frame.payload, &f, sizeof(f));
+        break;
+    }
+    case 1: {
+        const struct telemetry_control_t f = {
+            .time_us = n * 500, .current = { -(int32_t)n * 1000, n * 1000 }, .target = { 0, n }, .error = { -1, 0 },
+        };
+        frame.type = TELEMETRY_FRAME_CONTROL;
+        frame.length = sizeof(f);
+        memcpy(frame.payload, &f, sizeof(f));
+        break;
+    }
+    default: {
+        const struct telemetry_mark_t f = { .time_us = n * 500, .mark = n & 3, .distance = n * 69630 };
+        frame.type = TELEMETRY_FRAME_MARK;
+        frame.length = sizeof(f);
+        memcpy(frame.payload, &f, sizeof(f));
+        break;
+    }
+    }
+
+    const uint dropped = telemetry_dropped;
+    telemetry_push(frame.type, frame.payload, frame.length);
+    if (telemetry_dropped == dropped && sent_count < LOOPBACK_FRAME_MAX) {
+        sent[sent_count++] = frame;
+    }
+}
+
+static void loopback_drain(void) {
+    for (uint i = 0; i < 10000 && telemetry_pending() > 0; i++) {
+        telemetry_flush();
+    }
+}
+
+/**
+ * @brief 받은 바이트열을 parser로 읽어 넣은 프레임들과 순서대로 비교한다.
+ *
+ * @return 넣은 적이 없거나 내용이 다른 프레임 수
+ */
+static uint loopback_compare(const uint8_t *bytes, uint length, struct telemetry_parser_t *parser) {
+    uint8_t frame[TELEMETRY_FRAME_MAX];
+    uint index = 0, mismatch = 0;
+
+    telemetry_parser_init(parser);
+    for (uint i = 0; i < length; i++) {
+        const int payload_length = telemetry_parser_feed(parser, bytes[i], frame);
+        if (payload_length < 0) {
+            continue;
+        }
+        // CRC 오류로 버려진 프레임은 seq로 건너뛴다.
+        while (index < sent_count && sent[index].seq != frame[1]) {
+            index++;
+        }
+        if (index == sent_count) {
+            mismatch++;
+            continue;
+        }
+        const struct loopback_frame_t *expected = &sent[index++];
+        if (frame[0] != expected->type || payload_length != expected->length ||
+            memcmp(&frame[2], expected->payload, expected->length) != 0) {
+            mismatch++;
+        }
+    }
+
+    return mismatch;
+}
+
+static int loopback_report(const char *name, bool passed, const struct telemetry_parser_t *parser) {
+    printf("%-10s  sent %3u  frames %3lu  lost %3lu  crc errors %lu  format errors %lu  writes %3u  %s\n", name,
+           sent_count, parser->frames, parser->lost, parser->crc_errors, parser->format_errors, write_count,
+           passed ? "OK" : "FAILED");
+
+    return !passed;
+}
+
+static int loopback_round_trip(void) {
+    struct telemetry_parser_t parser;
+
+    loopback_reset(4096);
+    for (uint n = 0; n < 300; n++) {
+        loopback_push(n);
+        if (n % 7 == 6) {
+            telemetry_flush();
+        }
+    }
+    loopback_drain();
+
+    const uint mismatch = loopback_compare(received, received_length, &parser);
+    const bool passed = mismatch == 0 && parser.frames == sent_count && parser.lost == 0 && parser.crc_errors == 0 &&
+                        parser.format_errors == 0 && write_split == 0;
+
+    return loopback_report("round trip", passed, &parser);
+}
+
+static int loopback_budget(void) {
+    struct telemetry_parser_t parser;
+
+    // 가장 긴 프레임(센싱) 하나가 겨우 들어가는 크기
+    loopback_reset(sizeof(struct telemetry_sensing_t) + 8);
+    for (uint n = 0; n < 30; n++) {
+        loopback_push(n);
+    }
+    loopback_drain();
+
+    const uint mismatch = loopback_compare(received, received_length, &parser);
+    const bool passed = mismatch == 0 && parser.frames == sent_count && parser.lost == 0 && write_over_budget == 0 &&
+                        write_split == 0 && write_count >= sent_count / 2;
+
+    return loopback_report("budget", passed, &parser);
+}
+
+static int loopback_drop(void) {
+    struct telemetry_parser_t parser;
+
+    // 보내지 않고 센싱 프레임만 넣어 ring buffer를 넘치게 한 뒤, 조금 보내고 하나를 더 넣어 빠진 seq가 드러나게 한다.
+    // 버려지는 프레임 수는 seq(8비트)로 셀 수 있도록 255개보다 적게 한다.
+    loopback_reset(4096);
+    const uint count = TELEMETRY_BUFFER_SIZE / (sizeof(struct telemetry_sensing_t) + 3) + 50;
+    for (uint n = 0; n < count; n++) {
+        loopback_push(n * 3);
+    }
+    const uint dropped = telemetry_dropped;
+    telemetry_flush();
+    loopback_push(count * 3);
+    loopback_drain();
+
+    const uint mismatch = loopback_compare(received, received_length, &parser);
+    const bool passed = dropped > 0 && telemetry_dropped == dropped && mismatch == 0 && parser.lost == dropped &&
+                        parser.frames == count + 1 - dropped;
+
+    return loopback_report("drop", passed, &parser);
+}
+
+static int loopback_crc(void) {
+    struct telemetry_parser_t parser;
+
+    loopback_reset(4096);
+    for (uint n = 0; n < 3; n++) {
+        loopback_push(n);
+        telemetry_flush(); // 프레임마다 따로 보내 두 번째 프레임의 위치를 알 수 있게 한다.
+    }
+
+    // 두 번째 프레임(첫 구분자 다음)에서 COBS 코드가 아닌 첫 바이트를 바꾼다. 0x00이 되지 않게 한다.
+    uint start = 0;
+    while (received[start] != 0x00) {
+        start++;
+    }
+    start++;
+    const uint corrupt = start + 1 < received_length && received[start] > 1 ? start + 1 : start + 2;
+    received[corrupt] ^= received[corrupt] == 0x01 ? 0x03 : 0x01;
+
+    const uint mismatch = loopback_compare(received, received_length, &parser);
+    const bool passed =
+        mismatch == 0 && parser.crc_errors == 1 && parser.frames == sent_count - 1 && parser.lost == 1 && parser.format_errors == 0;
+
+    return loopback_report("crc", passed, &parser);
+}
+
+int main(void) {
+    int failed = 0;
+
+    hal_host_reset();
+    failed |= loopback_round_trip();
+    failed |= loopback_budget();
+    failed |= loopback_drop();
+    failed |= loopback_crc();
+
+    return failed;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file timer_host.c
+ * @brief timer.h의 호스트 구현. 가상의 시계(hal_host.h)에 맞춰 주기적으로 핸들러를 실행한다.
+ */
+
+#include "timer.h"
+#include "hal_host.h"
+
+static struct timer_host_slot_t {
+    bool running;
+    uint interval;
+    uint32_t deadline;
+    void (*handler)(void);
+} slots[TIMER_SLOT_COUNT];
+
+static struct timer_stats_t stats[TIMER_SLOT_COUNT];
+
+void timer_periodic_start(enum timer_slot_index index, uint interval, void (*handler)(void)) {
+    slots[index].handler = handler;
+    slots[index].interval = interval;
+    slots[index].deadline = hal_host.time_us + interval;
+    slots[index].running = true;
+}
+
+void timer_periodic_stop(enum timer_slot_index index) {
+    slots[index].running = false;
+}
+
+int timer_host_next(uint32_t *deadline) {
+    bool found = false;
+
+    for (int i = 0; i < TIMER_SLOT_COUNT; i++) {
+        if (slots[i].running && (!found || (int32_t)(slots[i].deadline - *deadline) < 0)) {
+            *deadline = slots[i].deadline;
+            found = true;
+        }
+    }
+
+    return !found;
+}
+
+void timer_host_dispatch(uint32_t now) {
+    for (int i = 0; i < TIMER_SLOT_COUNT; i++) {
+        // 핸들러 안에서 다른 타이머를 멈출 수 있으므로, 실행 직전에 다시 확인한다.
+        if (slots[i].running && (int32_t)(slots[i].deadline - now) <= 0) {
+            slots[i].deadline += slots[i].interval;
+
+            const uint32_t begin = hal_cycle_count();
+            slots[i].handler();
+            const uint32_t elapsed = hal_cycle_count() - begin;
+
+            stats[i].count++;
+            stats[i].total += elapsed;
+            stats[i].max = MAX(stats[i].max, elapsed);
+        }
+    }
+}
+
+struct timer_stats_t timer_get_stats(enum timer_slot_index index) {
+    return stats[index];
+}
+
+void timer_reset_stats(void) {
+    for (int i = 0; i < TIMER_SLOT_COUNT; i++) {
+        stats[i] = (struct timer_stats_t) { 0 };
+    }
+}
+
+void timer_host_reset(void) {
+    for (int i = 0; i < TIMER_SLOT_COUNT; i++) {
+        slots[i].running = false;
+        slots[i].handler = NULL;
+    }
+    timer_reset_stats();
+}
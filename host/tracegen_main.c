@@ -0,0 +1,229 @@
+/**
+ * @file tracegen_main.c
+ * @brief linetracer_replay용 합성 트레이스 생성기. host/traces의 트레이스들은 이 프로그램으로 만든다.
+ *
+ *   linetracer_tracegen <output directory>
+ *
+ * 레코드는 블랙박스와 같이 제어 주기(MOTOR_CONTROL_INTERVAL_US)마다 하나씩 만든다.
+ * 센서 k는 ir_state의 (15 - k)번째 비트이며, position은 라인 중심이 센서 c에 있을 때 (c - 7.5) * 4000 이다.
+ * 왼쪽 마크는 라인 중심에서 센서 4 ~ 7개 왼쪽(센서 번호가 작은 쪽), 오른쪽 마크는 5 ~ 8개 오른쪽에 놓인다.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "config.h"
+#include "sensing.h"
+
+#define TRACE_VELOCITY 1.5f // m/s
+#define TRACE_POSITION_PER_SENSOR 4000
+
+enum trace_feature_t {
+    TRACE_LINE = 0,
+    TRACE_LEFT = 0x01,
+    TRACE_RIGHT = 0x02,
+    TRACE_CROSS = 0x04,
+};
+
+static FILE *file;
+static uint32_t time_us;
+static double distance; // m
+static float center = 7.5f; // 라인 중심이 있는 센서 위치 (0 ~ 15)
+static uint32_t random_state = 1;
+
+static uint trace_random(uint range) {
+    random_state = random_state * 1103515245u + 12345u;
+    return (random_state >> 16) % range;
+}
+
+static inline sensing_ir_state_t sensor_bit(int k) {
+    return k >= 0 && k < SENSING_IR_COUNT ? 1u << (SENSING_IR_COUNT - 1 - k) : 0;
+}
+
+/**
+ * @brief 레코드 하나를 쓴다.
+ *
+ * @param width 라인이 덮는 센서 수 (곡선에서는 라인이 비스듬히 지나가 더 많은 센서가 잡힌다)
+ * @param feature 라인 옆에 함께 보이는 마크
+ * @param noise 참이면 라인 가장자리의 센서가 가끔 꺼진다.
+ */
+static void trace_record(int width, uint feature, bool noise) {
+    const int base = (int)floorf(center);
+    sensing_ir_state_t state = 0;
+
+    for (int k = base - (width - 1) / 2; k <= base + width / 2; k++) {
+        state |= sensor_bit(k);
+    }
+    if (feature & TRACE_LEFT) {
+        for (int k = base - 7; k <= base - 4; k++) {
+            state |= sensor_bit(k);
+        }
+    }
+    if (feature & TRACE_RIGHT) {
+        for (int k = base + 5; k <= base + 8; k++) {
+            state |= sensor_bit(k);
+        }
+    }
+    if (feature & TRACE_CROSS) {
+        state = 0xFFFF;
+    }
+    if (noise && trace_random(8) == 0) { // 라인 양 끝의 센서 중 하나를 놓친다.
+        state &= ~sensor_bit(trace_random(2) ? base - (width - 1) / 2 : base + width / 2);
+    }
+
+    const int32_t tick = distance * MOTOR_TICK_PER_METER;
+    const int position = (center - 7.5f) * TRACE_POSITION_PER_SENSOR;
+
+    // 왼쪽 엔코더 값은 앞으로 갈수록 감소한다. (drive.c의 속도 지령 참고)
+    fprintf(file, "%u,0x%04x,%d,%d,%d\n", time_us, state, position, -tick, tick);
+
+    time_us += MOTOR_CONTROL_INTERVAL_US;
+    distance += TRACE_VELOCITY * MOTOR_CONTROL_INTERVAL_US * 1e-6;
+}
+
+/**
+ * @brief length(m) 동안 라인 중심을 center_to까지 옮기며 레코드를 쓴다.
+ */
+static void trace_segment(float length, float center_to, int width, uint feature, bool noise) {
+    const int count = length / (TRACE_VELOCITY * MOTOR_CONTROL_INTERVAL_US * 1e-6f);
+    const float center_from = center;
+
+    for (int i = 0; i < count; i++) {
+        center = center_from + (center_to - center_from) * (i + 1) / count;
+        trace_record(width, feature, noise);
+    }
+}
+
+static inline void trace_line(float length) {
+    trace_segment(length, center, 2, TRACE_LINE, false);
+}
+
+static inline void trace_mark(uint feature) {
+    trace_segment(0.02f, center, 2, feature, false);
+}
+
+static int trace_open(const char *directory, const char *name) {
+    char path[512];
+
+    snprintf(path, sizeof(path), "%s/%s.csv", directory, name);
+    file = fopen(path, "w");
+    if (!file) {
+        perror(path);
+        return 1;
+    }
+
+    fprintf(file, "time_us,ir_state,position,encoder_l,encoder_r\n");
+    time_us = 0;
+    distance = 0;
+    center = 7.5f;
+    random_state = 1;
+
+    return 0;
+}
+
+static void trace_close(void) {
+    fclose(file);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <output directory>\n", argv[0]);
+        return 1;
+    }
+    const char *directory = argv[1];
+
+    // 왼쪽 마크: 깨끗한 마크, 가장자리가 깜빡이는 마크, 마크 중간이 한 주기 끊기는 마크
+    if (trace_open(directory, "left")) {
+        return 1;
+    }
+    trace_line(0.2f);
+    trace_mark(TRACE_LEFT);
+    trace_line(0.3f);
+    trace_segment(0.02f, center, 2, TRACE_LEFT, true);
+    trace_line(0.3f);
+    trace_segment(0.008f, center, 2, TRACE_LEFT, false);
+    trace_segment(0.001f, center, 2, TRACE_LINE, false);
+    trace_segment(0.011f, center, 2, TRACE_LEFT, false);
+    trace_line(0.3f);
+    trace_close();
+
+    // 오른쪽 마크: 왼쪽과 같은 구성
+    if (trace_open(directory, "right")) {
+        return 1;
+    }
+    trace_line(0.2f);
+    trace_mark(TRACE_RIGHT);
+    trace_line(0.3f);
+    trace_segment(0.02f, center, 2, TRACE_RIGHT, true);
+    trace_line(0.3f);
+    trace_segment(0.008f, center, 2, TRACE_RIGHT, false);
+    trace_segment(0.001f, center, 2, TRACE_LINE, false);
+    trace_segment(0.011f, center, 2, TRACE_RIGHT, false);
+    trace_line(0.3f);
+    trace_close();
+
+    // 양쪽 마크: 정렬된 마크, 한쪽이 1cm 늦게 보이는 마크(로봇이 비스듬히 들어감)
+    if (trace_open(directory, "both")) {
+        return 1;
+    }
+    trace_line(0.2f);
+    trace_mark(TRACE_LEFT | TRACE_RIGHT);
+    trace_line(0.3f);
+    trace_segment(0.01f, center, 2, TRACE_LEFT, false);
+    trace_segment(0.01f, center, 2, TRACE_LEFT | TRACE_RIGHT, false);
+    trace_segment(0.01f, center, 2, TRACE_RIGHT, false);
+    trace_line(0.3f);
+    trace_close();
+
+    // 크로스: 정렬된 크로스, 양 끝이 조금씩 어긋나게 보이는 크로스
+    if (trace_open(directory, "cross")) {
+        return 1;
+    }
+    trace_line(0.2f);
+    trace_mark(TRACE_CROSS);
+    trace_line(0.3f);
+    trace_segment(0.005f, center, 2, TRACE_LEFT, false);
+    trace_segment(0.015f, center, 2, TRACE_CROSS, false);
+    trace_segment(0.005f, center, 2, TRACE_RIGHT, false);
+    trace_line(0.3f);
+    trace_close();
+
+    /*
+     * 곡선: 라인이 비스듬히 지나가 센서가 많이(6 ~ 7개) 잡히고, 라인 중심이 좌우로 움직인다.
+     * 마크 window가 라인을 따라가므로 마크로 판단하면 안 된다. 마지막에는 곡선 안에서 왼쪽 마크를 하나 본다.
+     */
+    if (trace_open(directory, "curve")) {
+        return 1;
+    }
+    trace_line(0.2f);
+    trace_segment(0.15f, 4.5f, 6, TRACE_LINE, false);
+    trace_segment(0.20f, 4.5f, 7, TRACE_LINE, true);
+    trace_segment(0.15f, 7.5f, 6, TRACE_LINE, false);
+    trace_segment(0.15f, 10.5f, 6, TRACE_LINE, false);
+    trace_segment(0.20f, 10.5f, 7, TRACE_LINE, true);
+    trace_segment(0.15f, 7.5f, 6, TRACE_LINE, false);
+    trace_line(0.2f);
+    trace_segment(0.10f, 9.5f, 3, TRACE_LINE, false);
+    trace_segment(0.02f, 9.5f, 3, TRACE_LEFT, false);
+    trace_segment(0.10f, 7.5f, 3, TRACE_LINE, false);
+    trace_line(0.2f);
+    trace_close();
+
+    // 여러 마크가 이어지는 짧은 주행
+    if (trace_open(directory, "sequence")) {
+        return 1;
+    }
+    static const uint sequence[] = {
+        TRACE_LEFT | TRACE_RIGHT, TRACE_RIGHT, TRACE_RIGHT, TRACE_CROSS, TRACE_LEFT, TRACE_LEFT, TRACE_LEFT | TRACE_RIGHT,
+    };
+    trace_line(0.2f);
+    for (uint i = 0; i < sizeof(sequence) / sizeof(sequence[0]); i++) {
+        trace_mark(sequence[i]);
+        trace_line(0.15f + 0.05f * trace_random(6));
+    }
+    trace_close();
+
+    return 0;
+}
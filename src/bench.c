@@ -0,0 +1,155 @@
+/**
+ * @file bench.c
+ * @brief hot path 함수 벤치마크
+ */
+
+#include <stdio.h>
+
+#include "hal.h"
+#include "bench.h"
+#include "sensing.h"
+#include "mark.h"
+
+static volatile int sink; // 결과를 버리지 않도록 해서 컴파일러가 호출을 없애지 못하게 한다.
+
+/*
+ * 입력 패턴: 라인이 센서 배열 위를 조금씩 옮겨 다니도록 하여, 분기와 window가 한 가지 경우로만 측정되지 않게 한다.
+ */
+
+static void bench_set_line(uint i) {
+    const int center = 4 + (i & 7);
+
+    for (int k = 0; k < SENSING_IR_COUNT; k++) {
+        const int d = k - center;
+        sensing_ir_normalized[k] = d == 0 ? 0xff : (d == -1 || d == 1) ? 0x80 : 0;
+    }
+    sensing_ir_position = (center - 7) * 4000 - 2000;
+    sensing_ir_state = 0x7 << (SENSING_IR_COUNT - 2 - center);
+}
+
+static void bench_baseline(uint i) {
+    sink = i;
+}
+
+static void bench_normalize_ir(uint i) {
+    sink = sensing_bench_normalize_ir(i & 0xff, 0x20, 0xc0);
+}
+
+static void bench_calc_position(uint i) {
+    (void)i;
+    sensing_bench_calc_position();
+}
+
+static void bench_calc_position_limited(uint i) {
+    sensing_ir_position = (i & 0x3f) * 500 - 16000;
+    sensing_bench_calc_position_limited();
+}
+
+static struct mark_state_t mark_state;
+
+static void bench_mark_update_window(uint i) {
+    mark_update_window(&mark_state, (int)(i & 0xf) * 4000 - 30000);
+}
+
+static void bench_mark_update_state(uint i) {
+    // 라인만 보이는 상태와 왼쪽 마크가 보이는 상태를 번갈아 넣어 모든 상태를 거치게 한다.
+    sensing_ir_state = (i & 0x40) ? 0xF180 : 0x0180;
+    sink = mark_update_state(&mark_state);
+}
+
+static void bench_motor_control_dt(uint i) {
+    motor_bench_control_dt(i & 1 ? MOTOR_RIGHT : MOTOR_LEFT);
+}
+
+static void bench_velocity_commander(uint i) {
+    static int32_t left = 0, right = 0;
+
+    sensing_ir_position = (i & 0xf) * 4000 - 30000;
+    drive_bench_velocity_commander(&left, &right);
+}
+
+static const struct bench_kernel_t {
+    const char *name;
+    const char *label; // OLED에 표시할 짧은 이름 (9자 이하)
+    void (*setup)(uint i); // 측정 시간에 포함되지 않는 입력 준비 (batch마다 한 번)
+    void (*run)(uint i);
+} kernels[] = {
+    { "baseline",                      "baseline",  NULL,           bench_baseline },
+    { "sensing_normalize_ir",          "normalize", NULL,           bench_normalize_ir },
+    { "sensing_calc_position",         "position",  bench_set_line, bench_calc_position },
+    { "sensing_calc_position_limited", "pos limit", NULL,           bench_calc_position_limited },
+    { "mark_update_window",            "mark win",  NULL,           bench_mark_update_window },
+    { "mark_update_state",             "mark fsm",  bench_set_line, bench_mark_update_state },
+    { "motor_control_dt",              "motor dt",  NULL,           bench_motor_control_dt },
+    { "drive_velocity_commander",      "commander", NULL,           bench_velocity_commander },
+};
+
+/**
+ * @brief 함수 하나를 BENCH_SAMPLE_COUNT번 측정하고, batch 하나(BENCH_BATCH번 호출)에 걸린 시간을 정렬해 samples에 담는다.
+ */
+static void bench_measure(const struct bench_kernel_t *kernel, uint32_t *samples) {
+    uint call = 0;
+
+    // 캐시와 분기 예측을 데우기 위해 한 batch를 먼저 실행한다.
+    for (int j = 0; j < BENCH_BATCH; j++) {
+        kernel->run(call++);
+    }
+
+    for (int s = 0; s < BENCH_SAMPLE_COUNT; s++) {
+        if (kernel->setup) {
+            kernel->setup(s);
+        }
+
+        const uint32_t status = hal_irq_save(); // 측정 중 인터럽트(USB 등)가 끼어들지 않게 한다.
+        const uint32_t begin = hal_cycle_count();
+        for (int j = 0; j < BENCH_BATCH; j++) {
+            kernel->run(call++);
+        }
+        const uint32_t end = hal_cycle_count();
+        hal_irq_restore(status);
+
+        // 삽입 정렬
+        const uint32_t elapsed = (end - begin) & HAL_CYCLE_MASK;
+        int k = s;
+        while (k > 0 && samples[k - 1] > elapsed) {
+            samples[k] = samples[k - 1];
+            k--;
+        }
+        samples[k] = elapsed;
+    }
+}
+
+void bench_run(void (*report)(const struct bench_result_t *result)) {
+    static uint32_t samples[BENCH_SAMPLE_COUNT];
+    float baseline = 0;
+
+    hal_cycle_counter_init();
+    sensing_supply_voltage = 8.0f; // motor_control_dt에서 0으로 나누지 않도록 한다.
+    mark_state = mark_init_state();
+    bench_set_line(0);
+
+    for (uint i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++) {
+        bench_measure(&kernels[i], samples);
+
+        const float offset = i == 0 ? 0 : baseline;
+        const float median = (float)samples[BENCH_SAMPLE_COUNT / 2] / BENCH_BATCH;
+        if (i == 0) {
+            baseline = median;
+        }
+
+        const struct bench_result_t result = {
+            .name = kernels[i].name,
+            .label = kernels[i].label,
+            .calls = BENCH_BATCH * BENCH_SAMPLE_COUNT,
+            .min = MAX((float)samples[0] / BENCH_BATCH - offset, 0.0f),
+            .median = MAX(median - offset, 0.0f),
+            .max = MAX((float)samples[BENCH_SAMPLE_COUNT - 1] / BENCH_BATCH - offset, 0.0f),
+        };
+        report(&result);
+    }
+}
+
+void bench_format_csv(const struct bench_result_t *result, char *buffer, uint size) {
+    snprintf(buffer, size, "%s,%s,%u,%.1f,%.1f,%.1f",
+             result->name, HAL_CYCLE_UNIT, result->calls, result->min, result->median, result->max);
+}
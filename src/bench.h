@@ -0,0 +1,52 @@
+/**
+ * @file bench.h
+ * @brief 인터럽트 핸들러와 주행 루프에서 매 주기 실행되는 함수(hot path)들의 실행 시간을 재는 벤치마크
+ *
+ * 펌웨어에서는 SysTick으로 사이클을, 호스트에서는 실제 시간(ns)을 잰다. (hal_cycle_count 참고)
+ * 결과는 함수마다 CSV 한 줄이며, 펌웨어와 호스트가 같은 형식을 사용하므로 기준 결과와 비교해 성능 저하를 찾을 수 있다.
+ */
+
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include "pico/types.h"
+#include "config.h"
+#include "motor.h"
+
+#define BENCH_CSV_HEADER "kernel,unit,calls,min,median,max"
+
+/**
+ * @brief 함수 하나의 측정 결과. 값은 호출 한 번당 시간이며, 빈 루프(baseline)의 중앙값을 뺀 값이다.
+ * 첫 번째 결과인 baseline은 빈 루프 자체의 값이다.
+ */
+struct bench_result_t {
+    const char *name;
+    const char *label; // OLED에 표시할 짧은 이름
+    uint calls; // 측정에 사용한 총 호출 수
+    float min, median, max;
+};
+
+/**
+ * @brief 모든 함수를 차례로 측정한다. 센싱, 모터 제어 타이머가 멈춰 있는 상태에서 호출해야 한다.
+ * 측정에 쓰인 센서, 모터 제어 상태 변수들은 임의의 값으로 바뀐다.
+ *
+ * @param report 함수 하나의 측정이 끝날 때마다 호출된다.
+ */
+void bench_run(void (*report)(const struct bench_result_t *result));
+
+/**
+ * @brief 측정 결과를 BENCH_CSV_HEADER 형식의 CSV 한 줄로 만든다. (줄바꿈 제외)
+ */
+void bench_format_csv(const struct bench_result_t *result, char *buffer, uint size);
+
+/*
+ * 각 모듈이 벤치마크를 위해 내보내는 진입점. 모듈 안의 static 함수를 한 번 호출한다.
+ */
+
+int sensing_bench_normalize_ir(int raw, int bias, int range);
+void sensing_bench_calc_position(void);
+void sensing_bench_calc_position_limited(void);
+void motor_bench_control_dt(enum motor_index index);
+void drive_bench_velocity_commander(int32_t *const left, int32_t *const right);
+
+#endif
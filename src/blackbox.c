@@ -0,0 +1,154 @@
+/**
+ * @file blackbox.c
+ * @brief 주행 중 마지막 몇 초 동안의 기록을 보관하는 블랙박스
+ */
+
+#include "hal.h"
+#include "blackbox.h"
+#include "telemetry.h"
+#include "oled.h"
+#include "switch.h"
+
+_Static_assert((BLACKBOX_RECORD_COUNT & (BLACKBOX_RECORD_COUNT - 1)) == 0, "BLACKBOX_RECORD_COUNT must be a power of two");
+
+/**
+ * @brief 레코드를 담는 circular buffer. head는 지금까지 기록된 레코드의 총 개수이며,
+ * head를 BLACKBOX_RECORD_COUNT로 나눈 나머지가 다음 레코드를 쓸 위치이다.
+ */
+static struct telemetry_blackbox_t records[BLACKBOX_RECORD_COUNT];
+static volatile uint32_t head = 0;
+static volatile enum blackbox_freeze_t freeze_reason = BLACKBOX_FREEZE_NONE;
+static volatile bool recording = false;
+
+void blackbox_start(void) {
+    recording = false;
+    head = 0;
+    freeze_reason = BLACKBOX_FREEZE_NONE;
+    hal_memory_barrier();
+    recording = true;
+}
+
+void HAL_ISR_FUNC(blackbox_record)(const struct telemetry_blackbox_t *record) {
+    if (!recording) {
+        return;
+    }
+
+    records[head & (BLACKBOX_RECORD_COUNT - 1)] = *record;
+    head++;
+}
+
+void blackbox_freeze(enum blackbox_freeze_t reason) {
+    if (!recording) {
+        return;
+    }
+
+    recording = false;
+    freeze_reason = reason;
+}
+
+enum blackbox_freeze_t blackbox_freeze_reason(void) {
+    return freeze_reason;
+}
+
+uint blackbox_count(void) {
+    return MIN(head, BLACKBOX_RECORD_COUNT);
+}
+
+const struct telemetry_blackbox_t *blackbox_get(uint index) {
+    const uint count = blackbox_count();
+
+    if (index >= count) {
+        return NULL;
+    }
+
+    return &records[(head - count + index) & (BLACKBOX_RECORD_COUNT - 1)];
+}
+
+int blackbox_dump(void) {
+    if (!telemetry_connected()) {
+        return 1;
+    }
+
+    telemetry_start(TELEMETRY_STREAM_BLACKBOX);
+    for (uint i = 0; i < blackbox_count(); i++) {
+        // ring buffer가 넘쳐 레코드가 버려지지 않도록, 절반 이상 차 있으면 먼저 보낸다.
+        while (telemetry_pending() > TELEMETRY_BUFFER_SIZE / 2) {
+            if (!telemetry_connected()) {
+                telemetry_stop();
+                return 1;
+            }
+            telemetry_flush();
+        }
+        telemetry_push(TELEMETRY_FRAME_BLACKBOX, blackbox_get(i), sizeof(struct telemetry_blackbox_t));
+    }
+    while (telemetry_pending() > 0 && telemetry_connected()) {
+        telemetry_flush();
+    }
+    telemetry_stop();
+
+    return 0;
+}
+
+/**
+ * @brief index 번째 레코드를 OLED에 표시한다. 시각은 마지막 레코드를 기준으로 한 상대 시각(ms)이다.
+ */
+static void blackbox_display(uint index) {
+    const struct telemetry_blackbox_t *record = blackbox_get(index);
+    const struct telemetry_blackbox_t *last = blackbox_get(blackbox_count() - 1);
+    char ir[SENSING_IR_COUNT + 1];
+
+    for (int i = 0; i < SENSING_IR_COUNT; i++) {
+        ir[i] = record->ir_state & (1 << (SENSING_IR_COUNT - 1 - i)) ? '1' : '0';
+    }
+    ir[SENSING_IR_COUNT] = '\0';
+
+    oled_printf("/0/gt/w%8.1f ms", -(float)(last->time_us - record->time_us) / 1000);
+    oled_printf("/1/w%s", ir);
+    oled_printf("/2/gpos /w%6d", record->position);
+    oled_printf("/3/rL/w%5d /bR/w%5d", record->encoder[0], record->encoder[1]);
+    oled_printf("/4/gv   /w%5u mm//s", record->velocity_mm);
+    oled_printf("/5/gmark/w%2u /gst/w%2u", record->mark, record->mark_state);
+    oled_printf("/6/K%4u//%4u", index + 1, blackbox_count());
+}
+
+void blackbox_view(void) {
+    oled_clear();
+
+    if (blackbox_count() == 0) {
+        oled_printf("/0/gBlack Box/1/wNo record.");
+        switch_wait_until_input();
+        return;
+    }
+
+    oled_printf("/0/gBlack Box");
+    oled_printf("/1/w%u records", blackbox_count());
+    oled_printf("/2%s", blackbox_freeze_reason() == BLACKBOX_FREEZE_LINE_OUT ? "/rby line out" : "/wby end mark");
+    oled_printf("/4(DUMP // VIEW)");
+
+    enum switch_event_t sw = switch_wait_until_input();
+    if (sw == SWITCH_EVENT_LEFT) {
+        oled_printf("/6Dumping ...");
+        const int result = blackbox_dump();
+        oled_printf("/6%s", result ? "/rNo USB.    " : "/gDone.      ");
+        switch_wait_until_input();
+        return;
+    } else if (sw != SWITCH_EVENT_RIGHT) {
+        return;
+    }
+
+    // 기록이 멈춘 시점(마지막 레코드)부터 거꾸로 살펴본다.
+    int index = blackbox_count() - 1;
+    oled_clear();
+    for (;;) {
+        blackbox_display(index);
+
+        sw = switch_wait_until_input();
+        if (sw == SWITCH_EVENT_BOTH) {
+            break;
+        } else if (sw == SWITCH_EVENT_LEFT) {
+            index = MAX(index - BLACKBOX_VIEW_STEP, 0);
+        } else if (sw == SWITCH_EVENT_RIGHT) {
+            index = MIN(index + BLACKBOX_VIEW_STEP, (int)blackbox_count() - 1);
+        }
+    }
+}
@@ -0,0 +1,72 @@
+/**
+ * @file blackbox.h
+ * @brief 주행 중 마지막 몇 초 동안의 센서, 엔코더, 속도, 마크 정보를 RAM에 계속 기록해두는 블랙박스
+ *
+ * 주행이 시작되면 기록을 시작하고, 라인 이탈이나 주행 종료 시 기록을 멈춘다(freeze).
+ * 멈춘 기록은 다음 주행을 시작하기 전까지 유지되며, OLED로 살펴보거나 USB로 내보낼 수 있다.
+ * 레코드를 기록하는 비용은 16 bytes 복사 한 번이므로 실제 주행에서도 켜둘 수 있다.
+ */
+
+#ifndef _BLACKBOX_H_
+#define _BLACKBOX_H_
+
+#include "pico/types.h"
+#include "config.h"
+#include "telemetry_protocol.h"
+
+/**
+ * @brief 기록이 멈춘 이유
+ */
+enum blackbox_freeze_t {
+    BLACKBOX_FREEZE_NONE = 0, // 기록 중이거나 아직 기록한 적이 없음
+    BLACKBOX_FREEZE_LINE_OUT, // 라인 이탈
+    BLACKBOX_FREEZE_END, // 엔드 마크를 보고 정상적으로 정지
+};
+
+/**
+ * @brief 이전 기록을 지우고 새로 기록을 시작한다.
+ */
+void blackbox_start(void);
+
+/**
+ * @brief 레코드 하나를 기록한다. 인터럽트 핸들러에서 호출한다. 기록이 멈춘 상태라면 아무것도 하지 않는다.
+ */
+void blackbox_record(const struct telemetry_blackbox_t *record);
+
+/**
+ * @brief 기록을 멈춘다. 이후의 blackbox_record 호출은 무시된다.
+ *
+ * @param reason 기록을 멈춘 이유
+ */
+void blackbox_freeze(enum blackbox_freeze_t reason);
+
+/**
+ * @brief 마지막으로 기록이 멈춘 이유를 반환한다. 기록 중이라면 BLACKBOX_FREEZE_NONE이다.
+ */
+enum blackbox_freeze_t blackbox_freeze_reason(void);
+
+/**
+ * @brief 보관 중인 레코드 수를 반환한다. (최대 BLACKBOX_RECORD_COUNT)
+ */
+uint blackbox_count(void);
+
+/**
+ * @brief index 번째 레코드를 반환한다. 0번이 가장 오래된 레코드이다.
+ *
+ * @return const struct telemetry_blackbox_t * 범위를 벗어나면 NULL
+ */
+const struct telemetry_blackbox_t *blackbox_get(uint index);
+
+/**
+ * @brief 보관 중인 레코드를 모두 telemetry BLACKBOX 프레임으로 USB에 내보낸다.
+ *
+ * @return 0: 성공, 1: USB가 연결되어 있지 않거나 도중에 연결이 끊김
+ */
+int blackbox_dump(void);
+
+/**
+ * @brief 블랙박스 기록을 OLED로 살펴보거나 USB로 내보내는 메뉴 함수
+ */
+void blackbox_view(void);
+
+#endif
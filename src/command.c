@@ -0,0 +1,167 @@
+/**
+ * @file command.c
+ * @brief USB CDC로 받은 텍스트 명령으로 파라미터를 읽고 쓰는 기능
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "command.h"
+#include "hal.h"
+#include "param.h"
+#include "telemetry.h"
+
+static char line[COMMAND_LINE_MAX + 1];
+static uint line_length = 0;
+static bool line_overflow = false; // 줄이 너무 길면 '\n'이 올 때까지 버린다.
+
+/**
+ * @brief 번호 또는 이름('_'는 공백으로 본다)으로 파라미터를 찾는다.
+ */
+static const struct param_t *command_find_param(const char *key) {
+    char *end;
+    const long index = strtol(key, &end, 10);
+    if (*key != '\0' && *end == '\0') {
+        return param_get(index);
+    }
+
+    char name[COMMAND_LINE_MAX + 1];
+    uint i;
+    for (i = 0; key[i] != '\0' && i < COMMAND_LINE_MAX; i++) {
+        name[i] = key[i] == '_' ? ' ' : key[i];
+    }
+    name[i] = '\0';
+
+    return param_find(name);
+}
+
+/**
+ * @brief 파라미터 이름을 '_'로 공백을 바꾸어 buffer에 쓴다.
+ */
+static void command_param_key(const struct param_t *param, char *buffer, uint size) {
+    uint i;
+    for (i = 0; param->name[i] != '\0' && i + 1 < size; i++) {
+        buffer[i] = param->name[i] == ' ' ? '_' : param->name[i];
+    }
+    buffer[i] = '\0';
+}
+
+static void command_list(void) {
+    char key[32];
+    char reply[COMMAND_LINE_MAX];
+
+    for (uint i = 0; i < param_count(); i++) {
+        const struct param_t *param = param_get(i);
+        command_param_key(param, key, sizeof(key));
+        snprintf(reply, sizeof(reply), "%u %s %g %g %g\n", i, key, param_read(param), param->min, param->max);
+        telemetry_print(reply);
+    }
+    telemetry_print("ok\n");
+}
+
+static void command_get(const char *key) {
+    char reply[COMMAND_LINE_MAX];
+    const struct param_t *param = key ? command_find_param(key) : NULL;
+
+    if (!param) {
+        telemetry_print("err unknown parameter\n");
+        return;
+    }
+
+    snprintf(reply, sizeof(reply), "ok %s %g\n", key, param_read(param));
+    telemetry_print(reply);
+}
+
+/**
+ * @brief 한 줄에 있는 파라미터들을 한꺼번에 바꾼다.
+ * 모든 항목을 먼저 확인하고, 인터럽트를 막은 채로 값을 쓰므로 제어 인터럽트는 바뀌기 전이나 바뀐 후의 값만 보게 된다.
+ */
+static void command_set(char **saveptr) {
+    const char *key[COMMAND_SET_MAX];
+    const struct param_t *param[COMMAND_SET_MAX];
+    float value[COMMAND_SET_MAX];
+    uint count = 0;
+
+    for (const char *token; (token = strtok_r(NULL, " ", saveptr)) != NULL;) {
+        if (count == COMMAND_SET_MAX) {
+            telemetry_print("err too many parameters\n");
+            return;
+        }
+
+        key[count] = token;
+        token = strtok_r(NULL, " ", saveptr);
+        char *end;
+
+        if (!(param[count] = command_find_param(key[count]))) {
+            telemetry_print("err unknown parameter\n");
+            return;
+        }
+        if (!token || (value[count] = strtof(token, &end), *end != '\0')) {
+            telemetry_print("err invalid value\n");
+            return;
+        }
+        count++;
+    }
+    if (count == 0) {
+        telemetry_print("err no parameter\n");
+        return;
+    }
+
+    uint32_t status = hal_irq_save();
+    for (uint i = 0; i < count; i++) {
+        value[i] = param_write(param[i], value[i]);
+    }
+    hal_irq_restore(status);
+
+    // 범위 제한과 반올림이 적용된 실제 값을 돌려준다.
+    char reply[COMMAND_LINE_MAX];
+    uint length = snprintf(reply, sizeof(reply), "ok");
+    for (uint i = 0; i < count && length < sizeof(reply); i++) {
+        length += snprintf(&reply[length], sizeof(reply) - length, " %s %g", key[i], value[i]);
+    }
+    telemetry_print(reply);
+    telemetry_print("\n");
+}
+
+static void command_execute(char *command) {
+    char *saveptr;
+    const char *name = strtok_r(command, " ", &saveptr);
+
+    if (!name) { // 빈 줄
+        return;
+    }
+
+    if (strcmp(name, "list") == 0) {
+        command_list();
+    } else if (strcmp(name, "get") == 0) {
+        command_get(strtok_r(NULL, " ", &saveptr));
+    } else if (strcmp(name, "set") == 0) {
+        command_set(&saveptr);
+    } else {
+        telemetry_print("err unknown command\n");
+    }
+}
+
+void command_poll(void) {
+    for (int c; (c = hal_usb_read_char()) >= 0;) {
+        if (c == '\r') {
+            continue;
+        }
+
+        if (c == '\n') {
+            if (line_overflow) {
+                telemetry_print("err line too long\n");
+            } else {
+                line[line_length] = '\0';
+                command_execute(line);
+            }
+            line_length = 0;
+            line_overflow = false;
+        } else if (line_length < COMMAND_LINE_MAX) {
+            line[line_length++] = c;
+        } else {
+            line_overflow = true;
+        }
+    }
+}
@@ -0,0 +1,24 @@
+/**
+ * @file command.h
+ * @brief USB CDC로 받은 텍스트 명령으로 파라미터를 읽고 쓰는 기능
+ *
+ * 명령은 한 줄에 하나이며 '\n'으로 끝난다. 파라미터는 레지스트리 순서의 번호 또는 이름으로 지정하며,
+ * 이름 안의 공백은 '_'로 대신 쓴다 (예: curvature_coefficient).
+ *   list                         모든 파라미터를 "번호 이름 값 최소값 최대값" 형식으로 한 줄씩 보낸다.
+ *   get <param>                  파라미터 값을 보낸다.
+ *   set <param> <value> [...]    한 줄에 있는 값들을 한꺼번에 적용한다.
+ * 응답은 telemetry의 TEXT 프레임으로 보내며, 마지막 줄은 항상 "ok ..." 또는 "err ..." 이다.
+ */
+
+#ifndef _COMMAND_H_
+#define _COMMAND_H_
+
+#include "config.h"
+
+/**
+ * @brief USB로 받은 문자들을 읽고, 완성된 명령이 있으면 실행한다. 메인 루프에서만 호출한다.
+ * 받은 문자가 없으면 바로 반환하므로 주행 루프 안에서 매번 호출해도 된다.
+ */
+void command_poll(void);
+
+#endif
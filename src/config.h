@@ -14,6 +14,22 @@
 
 /* COMMON END */
 
+/* CLOCK BEGIN */
+
+/**
+ * @brief 시스템 클럭(clk_sys, MHz). 125, 200, 250 중 하나이며 CMake 옵션 LINETRACER_CLOCK_MHZ로 고른다.
+ * 클럭에 맞는 코어 전압은 hal_clock_init이 설정한다. PWM, OLED SPI, 엔코더 PIO 설정은 각 초기화 함수가
+ * 실제 클럭에서 다시 계산하므로, hal_clock_init은 다른 모든 초기화보다 먼저 호출해야 한다.
+ */
+#ifndef CLOCK_SYS_MHZ
+#define CLOCK_SYS_MHZ (125)
+#endif
+
+#define CLOCK_PERI_MAX_MHZ (133) // clk_peri(SPI, UART)의 최대 클럭. 넘으면 clk_peri를 PLL_USB(48MHz)에서 가져온다.
+#define CLOCK_VREG_SETTLE_US (1000) // 코어 전압을 바꾼 뒤 클럭을 올리기 전까지 기다리는 시간
+
+/* CLOCK END */
+
 /* SWITCH BEGIN */
 
 #define SWITCH_GPIO_LEFT  (0)
@@ -40,6 +56,14 @@
 
 /* OLED END */
 
+/* PLOT BEGIN */
+
+#define PLOT_TRACE_MAX     (2) // 그래프 하나에 그릴 수 있는 최대 신호 수
+#define PLOT_HISTORY       (96) // 신호마다 보관하는 샘플 수 (OLED 가로 픽셀 수)
+#define PLOT_FPS_DEFAULT   (30) // 96x46 그래프는 프레임마다 8.8 KB를 보내므로 8 MHz SPI의 약 27%를 쓴다.
+
+/* PLOT END */
+
 /* SENSING BEGIN */
 
 #define SENSING_IR_COUNT             (16)
@@ -57,9 +81,13 @@
  */
 #define SENSING_EXPR_RAW_TO_VOLTAGE(X) (((3.3f) / (4096.0f) * (21.0f) / (1.0f)) * (X))
 #define SENSING_VOLTAGE_GPIO           (26)
+#define SENSING_LOW_VOLTAGE            (6.8f) // 이 전압 아래로 떨어지면 EVENT_LOW_VOLTAGE를 보낸다. (2셀 기준 셀당 3.4V)
+#define SENSING_LOW_VOLTAGE_HYSTERESIS (0.2f) // 다시 보내기 위해서는 이만큼 더 높은 전압으로 올라와야 한다.
 
-#define SENSING_TIMER_SLOT        (TIMER_SLOT_0)
-#define SENSING_TIMER_INTERVAL_US (500)
+#define SENSING_TIMER_SLOT          (TIMER_SLOT_0)
+#define SENSING_TIMER_INTERVAL_US   (500)
+#define SENSING_IR_FRAME_US         ((SENSING_TIMER_INTERVAL_US) * (SENSING_IR_COUNT / 2)) // 모든 IR 센서가 한 번씩 갱신되는 주기
+#define SENSING_IR_FRAME_TIMEOUT_US (2 * (SENSING_IR_FRAME_US)) // frame 간격이 이보다 길면 position 변화율을 구하지 않는다.
 
 /* SENSING END */
 
@@ -77,13 +105,16 @@
 #define MOTOR_ENCODER_COMP_LEFT       (-1)
 #define MOTOR_ENCODER_COMP_RIGHT      (-1)
 #define MOTOR_ENCODER_RESOLUTION      (2048)
+#define MOTOR_ENCODER_MAX_STEP_RATE   (2000000) // PIO가 놓치지 않고 세야 하는 최대 step/s (약 29 m/s, peak velocity 최대값의 2배)
 #define MOTOR_WHEEL_DIAMETER_M        (0.038f) // 바퀴의 지름(m)
 #define MOTOR_GEAR_RATIO              (17.f / 69.f) // 모터(17) / 바퀴(69) 기어비
+#define MOTOR_TRACK_WIDTH_M           (0.10f) // 좌우 바퀴 사이의 거리(m)
 
 #define MOTOR_CONTROL_TIMER_SLOT  (TIMER_SLOT_1)
 #define MOTOR_CONTROL_INTERVAL_US (500)
 #define MOTOR_CONTROL_GAIN_P      (0.2f)
 #define MOTOR_CONTROL_GAIN_D      (0.1f)
+#define MOTOR_CONTROL_OVERRUN_US  (2 * MOTOR_CONTROL_INTERVAL_US) // 제어 주기가 이보다 길어지면 EVENT_CONTROL_OVERRUN을 보낸다.
 
 /**
  * @brief 바퀴 지름 1미터 당 엔코더 몇 틱인지에 대한 상수
@@ -96,9 +127,93 @@
 /* MARK BEGIN */
 
 #define MARK_LENGTH_TICK ((MOTOR_TICK_PER_METER) * (0.02))
+#define MARK_EVENT_QUEUE_SIZE (16) // 결정된 마크를 메인 루프로 넘기는 큐의 크기 (2의 거듭제곱)
 
 /* MARK END */
 
+/* MAP BEGIN */
+
+/*
+ * n차 주행의 마크 매칭 (map.h). 마지막으로 맞춘 마크에서 주행한 거리만큼 맵에서 나아간 위치를 예측하고,
+ * 그 주변에서 같은 종류의 맵 마크를 찾는다.
+ */
+#define MAP_MATCH_WINDOW_TICK    ((MOTOR_TICK_PER_METER) * (0.10)) // 예측 위치와 맵 마크 위치의 허용 차이
+#define MAP_MATCH_WINDOW_RATIO   (0.05f) // 마지막 매칭 이후 주행 거리에 비례해 늘어나는 허용 차이
+#define MAP_MATCH_SKIP_COST_TICK ((MOTOR_TICK_PER_METER) * (0.05)) // 맵 마크 하나를 놓친 것으로 볼 때의 비용
+
+/*
+ * 위치 보정. 맞춘 마크 사이의 맵 거리와 현재 주행 거리를 각각 누적하고, 그 비율을 거리 배율로 쓴다.
+ * 구간 길이로 가중되므로 짧은 구간의 마크 위치 오차(약 MARK_LENGTH_TICK)는 배율에 적게 반영된다.
+ * 누적 거리가 짧을 때 배율이 흔들리지 않도록 비율이 1인 가상의 구간(MAP_LOCATE_PRIOR_TICK)을 더해 계산하고,
+ * 오래된 구간은 마크를 맞출 때마다 MAP_LOCATE_FORGET을 곱해 점점 잊는다.
+ */
+#define MAP_LOCATE_PRIOR_TICK ((MOTOR_TICK_PER_METER) * (2.0)) // 배율 1로 가정하는 가상의 구간 길이
+#define MAP_LOCATE_FORGET     (0.95f) // 이전 구간들의 누적 거리에 곱하는 비율 (1이면 출발부터 모두 같은 비중)
+#define MAP_LOCATE_SCALE_MAX  (0.1f) // 배율이 1에서 벗어날 수 있는 최대 범위
+
+/*
+ * 여러 1차 주행의 맵 합치기 (map_merge). 합친 맵의 마크 위치는 주행들의 평균이고, 분산으로 안전 거리를 정한다.
+ */
+#define MAP_MERGE_MATCH_RATIO (0.9f) // 맵 마크 중 이 비율 이상을 맞춰야 합친다.
+#define MAP_MERGE_ERROR_TICK  ((MOTOR_TICK_PER_METER) * (0.05)) // 예측 위치와의 평균 차이가 이보다 크면 합치지 않는다.
+#define MAP_MERGE_MIN_RUNS    (3) // 이만큼 합친 후부터 분산으로 안전 거리를 정하고, 절반 넘게 보지 못한 마크를 지우고 절반 넘게 본 후보를 넣는다.
+#define MAP_MERGE_RUN_MAX     (1000) // 저장된 주행 수가 이보다 크면 통계가 없는 이전 맵으로 본다.
+#define MAP_CANDIDATE_MAX     (32) // 맵에 없는 마크 후보의 최대 수. 가득 차면 가장 적게 본 후보를 바꾼다.
+#define MAP_SAFE_SIGMA        (3.0f) // 안전 거리 = MAP_SAFE_MIN_TICK + MAP_SAFE_SIGMA * 마크 위치의 표준편차
+#define MAP_SAFE_MIN_TICK     ((MOTOR_TICK_PER_METER) * (0.18)) // 제동 지연 등 마크 위치와 상관없는 여유
+
+/* MAP END */
+
+/* SEGMENT BEGIN */
+
+/*
+ * 1차 주행의 좌우 엔코더 차이로 트랙을 직선과 곡선 구간으로 나눈다 (segment.h).
+ * SEGMENT_SAMPLE_TICK마다 곡률을 구해, 반지름이 SEGMENT_STRAIGHT_RADIUS_M보다 크면 직선으로 본다.
+ */
+#define SEGMENT_COUNT_MAX         (128)
+#define SEGMENT_SAMPLE_TICK       ((MOTOR_TICK_PER_METER) * (0.10)) // 곡률을 구하는 단위 거리
+#define SEGMENT_STRAIGHT_RADIUS_M (1.5f) // 이보다 반지름이 크면 직선
+#define SEGMENT_STRAIGHT_MIN_TICK ((MOTOR_TICK_PER_METER) * (0.30)) // 이보다 짧은 직선은 앞의 곡선에 합친다.
+#define SEGMENT_CURVE_MIN_ANGLE   (10.0f * PI / 180) // 방향이 이보다 적게 바뀐 곡선은 앞의 직선에 합친다. (rad)
+#define SEGMENT_SNAP_TICK         ((MOTOR_TICK_PER_METER) * (0.20)) // 구간 경계를 옮길 수 있는 곡선 마크까지의 최대 거리
+
+/* SEGMENT END */
+
+/* SLIP BEGIN */
+
+/*
+ * 바퀴 슬립 추정 (slip.h). 모터 제어 주기마다 종방향 비율과 횡방향 각도를 구해 한계와 비교한다.
+ * 슬립을 감지하면 SLIP_HOLD_US 동안 가감속도에 SLIP_ACCEL_SCALE을 곱한다.
+ */
+#define SLIP_FILTER              (0.05f) // low-pass filter 계수 (주기당, 약 10ms 시정수)
+#define SLIP_MIN_VELOCITY        (0.5f) // 종방향 비율을 구할 때 지령 속도의 하한 (m/s)
+#define SLIP_LONGITUDINAL_RATIO  (0.4f) // 지령 증가량에 대한 엔코더 증가량 차이의 한계
+#define SLIP_LATERAL_ANGLE       (0.5f) // 곡선에서 엔코더로 잰 회전이 맵 곡률보다 더 돈 각도의 한계 (rad)
+#define SLIP_LATERAL_LEAK_S      (0.2f) // 더 돈 각도가 새어 나가는 시상수 (s)
+#define SLIP_TRACK_CURVATURE_MAX (10.0f) // 맵이 없을 때 기준으로 삼는 트랙의 최대 곡률 (1/m, 반지름 10cm)
+#define SLIP_HOLD_US             ((100) * (1000)) // 마지막으로 슬립을 감지한 후 가감속도 제한을 유지하는 시간
+#define SLIP_ACCEL_SCALE         (0.5f) // 슬립하는 동안 가감속도에 곱하는 비율
+
+/* SLIP END */
+
+/* ESCALATE BEGIN */
+
+/*
+ * n차 주행을 거듭하며 구간별 최고 속도를 올린다 (escalate.h). 완주할 때마다 여유가 남은 구간을 한 단계 올리고,
+ * 라인 이탈한 구간은 내린다. 지표 하나라도 아래 한계를 넘은 구간은 더 올리지 않는다.
+ */
+#define ESCALATE_STEP_STRAIGHT  (0.3f) // 직선 구간 속도를 한 번에 올리는 양 (m/s)
+#define ESCALATE_STEP_CURVE     (0.1f) // 곡선 구간 속도를 한 번에 올리는 양 (m/s)
+#define ESCALATE_BACKOFF_STEPS  (2) // 라인 이탈한 구간은 이만큼의 단계를 내린다.
+#define ESCALATE_POSITION_MAX   (12000) // IR position (가장자리 센서가 약 30000, 센서 사이가 4000)
+#define ESCALATE_STEER_MAX      (0.8f) // 조향 비율 (1이면 안쪽 바퀴가 멈춘다)
+#define ESCALATE_SLIP_MAX_TICK  ((MOTOR_TICK_PER_METER) * (0.01)) // 모터 위치 제어 오차
+#define ESCALATE_SLIP_LEVEL_MAX (1.0f) // 슬립 정도 (slip.h). 슬립을 감지한 구간은 더 올리지 않는다.
+#define ESCALATE_FINISH_TICK    ((MOTOR_TICK_PER_METER) * (0.3)) // 두 번째 엔드 마크가 맵의 끝에서 이 안에 있어야 완주로 본다.
+#define ESCALATE_RUN_MAX        (1000) // 저장된 주행 수가 이보다 크면 저장한 적 없는 표로 본다.
+
+/* ESCALATE END */
+
 /* DRIVE BEGIN */
 
 #define DRIVE_MARK_COUNT_MAX   (400)
@@ -108,10 +223,57 @@
 
 /* DRIVE END */
 
+/* EVENT BEGIN */
+
+#define EVENT_QUEUE_SIZE (16) // 라인 이탈, 오류 이벤트를 메인 루프로 넘기는 큐의 크기 (2의 거듭제곱)
+
+/* EVENT END */
+
 /* FLASH BEGIN */
 
 #define FLASH_LOAD_DEFAULT (true)
 
 /* FLASH END */
 
+/* TELEMETRY BEGIN */
+
+#define TELEMETRY_BUFFER_SIZE      (16 * 1024) // 2의 거듭제곱이어야 한다.
+#define TELEMETRY_FLUSH_BYTES      (512) // telemetry_flush 한 번에 보내는 최대 바이트 수
+#define TELEMETRY_DRAIN_TIMEOUT_US ((100) * (1000))
+
+/* TELEMETRY END */
+
+/* BLACKBOX BEGIN */
+
+/**
+ * @brief 블랙박스에 보관하는 레코드 수 (2의 거듭제곱). 모터 제어 주기마다 하나씩 기록되므로 약 2초 분량이다.
+ * 레코드 하나는 16 bytes이다.
+ */
+#define BLACKBOX_RECORD_COUNT (4096)
+#define BLACKBOX_VIEW_STEP    (10) // OLED로 볼 때 스위치를 한 번 누를 때마다 넘어가는 레코드 수
+
+/* BLACKBOX END */
+
+/* COMMAND BEGIN */
+
+#define COMMAND_LINE_MAX (96) // 명령 한 줄의 최대 길이 ('\n' 제외)
+#define COMMAND_SET_MAX  (4) // set 명령 하나로 한꺼번에 바꿀 수 있는 파라미터의 최대 개수
+
+/* COMMAND END */
+
+/* PARAM BEGIN */
+
+/** @brief flash에 저장할 수 있는 파라미터의 최대 개수 */
+#define PARAM_COUNT_MAX (32)
+
+/* PARAM END */
+
+/* BENCH BEGIN */
+
+#define BENCH_BATCH        (32) // 한 번에 시간을 재는 연속 호출 수
+#define BENCH_SAMPLE_COUNT (64) // 함수마다 재는 batch 수. 최소, 중앙값, 최대를 구한다.
+#define BENCH_ISR_PHASE_MS (2000) // ISR Timing 메뉴에서 main loop 부하 조건 하나를 유지하는 시간
+
+/* BENCH END */
+
 #endif
\ No newline at end of file
@@ -1,82 +1,158 @@
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include "pico.h"
-#include "hardware/timer.h"
-#include "hardware/gpio.h"
-
+#include <math.h>
+#include "hal.h"
 #include "drive.h"
 #include "oled.h"
 #include "switch.h"
 #include "sensing.h"
 #include "motor.h"
 #include "mark.h"
+#include "map.h"
+#include "segment.h"
+#include "escalate.h"
+#include "slip.h"
 #include "fs.h"
+#include "param.h"
+#include "telemetry.h"
+#include "command.h"
+#include "blackbox.h"
 #include "buzzer.h"
+#include "bench.h"
+#include "event.h"
 
 static inline bool _is_on_line(void) {
     return __builtin_popcount(sensing_ir_state & 0xFFFF);
 }
 
-#define DRIVE_LINE_OUT_STATE_IDLE 0x00
-#define DRIVE_LINE_OUT_STATE_TRIG 0x01
-#define DRIVE_LINE_OUT_STATE_EXIT 0x04
-
-static bool drive_check_line_out(uint *state) {
-    static uint32_t time;
+/*
+ * 라인 이탈 판단: 모터 제어 주기마다 라인을 마지막으로 본 시각을 갱신하고,
+ * DRIVE_LINE_OUT_TIME_US 동안 라인을 보지 못하면 EVENT_LINE_OUT을 한 번 보낸다.
+ */
+static uint32_t line_seen_us;
+static bool line_out_sent;
+
+static inline void drive_check_line_out(void) {
+    const uint32_t now_us = hal_time_us_32();
+
+    if (_is_on_line()) {
+        line_seen_us = now_us;
+        line_out_sent = false;
+    } else if (!line_out_sent && now_us - line_seen_us > DRIVE_LINE_OUT_TIME_US) {
+        line_out_sent = true;
+        event_push(EVENT_LINE_OUT, now_us - line_seen_us);
+    }
+}
 
-    switch (*state) {
-    case DRIVE_LINE_OUT_STATE_IDLE:
-        if (!_is_on_line()) {
-            *state = DRIVE_LINE_OUT_STATE_TRIG;
-            time = time_us_32();
-        }
-        break;
+static uint slip_count; // 주행 중 슬립을 감지한 횟수
 
-    case DRIVE_LINE_OUT_STATE_TRIG:
-        if (_is_on_line()) {
-            *state = DRIVE_LINE_OUT_STATE_IDLE;
-        } else {
-            if (time_us_32() - time > DRIVE_LINE_OUT_TIME_US) {
-                *state = DRIVE_LINE_OUT_STATE_EXIT;
-            }
+/**
+ * @brief IRQ에서 보낸 이벤트(event.h)를 모두 꺼내 처리한다. 제어 주기 밀림, 저전압과 슬립은 telemetry로 알린다.
+ *
+ * @return 라인 이탈 이벤트를 받았으면 true
+ */
+static bool drive_handle_events(void) {
+    struct event_t event;
+    bool line_out = false;
+    char text[48];
+
+    while (event_poll(&event)) {
+        switch (event.type) {
+        case EVENT_LINE_OUT:
+            line_out = true;
+            break;
+        case EVENT_CONTROL_OVERRUN:
+            snprintf(text, sizeof(text), "%u: control overrun %d us\n", event.time_us, event.value);
+            telemetry_print(text);
+            break;
+        case EVENT_LOW_VOLTAGE:
+            snprintf(text, sizeof(text), "%u: low voltage %d mV\n", event.time_us, event.value);
+            telemetry_print(text);
+            break;
+        case EVENT_SLIP:
+            slip_count++;
+            snprintf(text, sizeof(text), "%u: slip level %d%%\n", event.time_us, event.value);
+            telemetry_print(text);
+            break;
+        default:
+            break;
         }
-        break;
-
-    case DRIVE_LINE_OUT_STATE_EXIT:
-        *state = DRIVE_LINE_OUT_STATE_IDLE;
-        return true;
     }
 
-    return false;
+    return line_out;
 }
 
+volatile float drive_v_default = 3.0f;
+volatile float drive_v_peak = 8.0f;
+volatile float drive_accel = 4.0f;
+volatile float drive_decel = 6.0f;
+volatile int drive_curve_decel = 16000;
+volatile float drive_curve_coef = 0.00008f;
+volatile float drive_look_ahead = 0.0f;
+volatile float drive_steer_velocity = 0.0f;
+volatile float drive_fit_in = 0.18f;
+volatile float drive_safe_distance = 0.2f;
+volatile int drive_mark_recover = 1;
+volatile int drive_escalate = 0;
+volatile float drive_steer_feedforward = 0.0f;
+
 volatile static float v_command = 0.0f; // 지령 속도: 모터에 직접 인가되는 속도
 volatile static float v_target = 0.0f; // 목표 속도: 가감속도 제어의 목표 속도
-volatile static float accel = 4.0f; // 가속도
-volatile static float decel = 6.0f; // 감속도
-volatile static int curve_decel = 16000; // 커브 감속 (작을 수록 곡선에서 감속을 많이 한다)
-volatile static float curve_coef = 0.00008f; // 곡률 계수
+
+/*
+ * 현재 주행에 적용되는 가감속도. 주행 루프에서 매번 파라미터로부터 복사된다.
+ * 엔드 마크를 본 후에는 정지 거리에 맞춰 감속도가 바뀌므로, 파라미터와 따로 둔다.
+ */
+volatile static float accel;
+volatile static float decel;
+
+/*
+ * 블랙박스에 함께 기록할 마지막 마크. 마크는 메인 루프가 큐에서 꺼낼 때 여기에 옮겨둔다.
+ * (state machine의 상태는 센싱 IRQ에 있으므로 mark_get_state로 바로 읽는다)
+ */
+volatile static uint8_t blackbox_mark = MARK_NONE;
+
+/*
+ * [n차 주행 반복 모드] 모터 제어 주기마다 잰 여유 지표(escalate.h)의 최댓값.
+ * 메인 루프가 읽어 현재 구간에 더한 뒤 지운다. 읽고 지우는 사이의 한 주기는 놓칠 수 있다.
+ */
+volatile static struct escalate_margin_t margin_peak;
+
+/*
+ * [n차 주행] 현재 위치의 맵 곡률. 메인 루프가 구간으로부터 구해 두면 슬립 추정(slip.h)에 쓴다.
+ */
+volatile static float path_curvature;
+volatile static bool is_path_curvature_known;
+
+/*
+ * [n차 주행] 앞먹임 조향 비율. 메인 루프가 구간 곡률로부터 구해 두면 position에 따른 조향 비율에 더한다.
+ * 맵 위치가 어긋나 곡선 밖에서 미리 도는 일이 없도록 안전 거리 안에서는 0으로 둔다.
+ */
+volatile static float steer_feedforward;
 
 /**
  * @brief 모터 제어 시 호출되는 함수를 정의한다. 모터 제어를 시작할 때 이 함수를 전달한다.
- * 1. 가감속도 제어를 수행한다.
+ * 1. 가감속도 제어를 수행한다. 슬립을 감지하고 있으면 가감속도를 줄인다.
  * 2. position에 따른 곡선 감속 제어를 수행한다.
- * 3. 모터 좌우 속도를 position에 따라 제어한다.
+ * 3. 모터 좌우 속도를 position(과 그 변화율, 맵 곡률)에 따라 제어한다.
+ * 4. 지령과 엔코더, 맵 곡률로 슬립을 추정한다.
  *
  * @param left 왼쪽 모터 지령 속도 포인터
  * @param right 오른쪽 모터 지령 속도 포인터
  */
-static void drive_velocity_commander(int32_t *const left, int32_t *const right) {
+static void HAL_ISR_FUNC(drive_velocity_commander)(int32_t *const left, int32_t *const right) {
     const static float dt_s = (float)MOTOR_CONTROL_INTERVAL_US / (1000 * 1000);
 
-    // 가감속도 제어
+    // 가감속도 제어: 바퀴가 미끄러지고 있으면 접지력을 되찾을 때까지 가감속도를 줄인다.
+    const float traction_scale = slip_is_detected() ? SLIP_ACCEL_SCALE : 1.0f;
     if (v_command < v_target) {
-        v_command += accel * dt_s;
+        v_command += accel * traction_scale * dt_s;
         if (v_command > v_target) { // limit
             v_command = v_target;
         }
     } else if (v_command > v_target) {
-        v_command -= decel * dt_s;
+        v_command -= decel * traction_scale * dt_s;
         if (v_command < v_target) { // limit
             v_command = v_target;
         }
@@ -86,16 +162,70 @@ static void drive_velocity_commander(int32_t *const left, int32_t *const right)
     const int position_limited = sensing_ir_position_limited;
 
     // 곡선 감속
-    float v_center = v_command / (1 + position_limited / (float)curve_decel);
+    float v_center = v_command / (1 + position_limited / (float)drive_curve_decel);
+
+    /*
+     * 조향 비율 결정
+     * - look ahead: position과 그 변화율로 drive_look_ahead 뒤의 position을 예측하여 조향한다. (D 제어)
+     * - steer velocity: 같은 조향 비율이라도 빠를수록 빠르게 돌므로, 기준 속도보다 빠르면 곡률 계수를 속도에 반비례하여 줄인다.
+     * - feedforward: 맵 곡률만큼의 조향 비율을 미리 더해, position은 곡률과 맞지 않는 만큼만 보정한다.
+     */
+    const float position_ahead = position + drive_look_ahead * sensing_ir_position_rate;
+    float curve_coef = drive_curve_coef;
+    if (drive_steer_velocity > 0 && v_command > drive_steer_velocity) {
+        curve_coef *= drive_steer_velocity / v_command;
+    }
 
     // 좌우 모터 속도 결정
-    float kp = curve_coef * position;
+    float kp = curve_coef * position_ahead + steer_feedforward;
     float v_left = v_center * (1.f - kp);
     float v_right = v_center * (1.f + kp);
 
     // 좌우 모터 속도 인가
     *left -= MOTOR_TICK_PER_METER * v_left * dt_s;
     *right += MOTOR_TICK_PER_METER * v_right * dt_s;
+
+    drive_check_line_out();
+
+    const struct motor_control_state_t control_left = motor_get_control_state(MOTOR_LEFT);
+    const struct motor_control_state_t control_right = motor_get_control_state(MOTOR_RIGHT);
+
+    // 슬립 추정
+    if (slip_update(&control_left, &control_right, path_curvature, is_path_curvature_known, position,
+                    sensing_ir_position_rate)) {
+        event_push(EVENT_SLIP, slip_state.level * 100);
+    }
+
+    // 여유 지표
+    const float steer = fabsf(kp);
+    const float slip = fmaxf(abs(control_left.error), abs(control_right.error));
+    if (abs(position) > margin_peak.position) {
+        margin_peak.position = abs(position);
+    }
+    if (steer > margin_peak.steer) {
+        margin_peak.steer = steer;
+    }
+    if (slip > margin_peak.slip) {
+        margin_peak.slip = slip;
+    }
+    if (slip_state.level > margin_peak.slip_level) {
+        margin_peak.slip_level = slip_state.level;
+    }
+
+    const struct telemetry_blackbox_t record = {
+        .time_us = hal_time_us_32(),
+        .ir_state = sensing_ir_state,
+        .position = position,
+        .encoder = { control_left.current, control_right.current },
+        .velocity_mm = v_command * 1000,
+        .mark = blackbox_mark,
+        .mark_state = mark_get_state().state,
+    };
+    blackbox_record(&record);
+}
+
+void drive_bench_velocity_commander(int32_t *const left, int32_t *const right) {
+    drive_velocity_commander(left, right);
 }
 
 /**
@@ -104,6 +234,17 @@ static void drive_velocity_commander(int32_t *const left, int32_t *const right)
 static void drive_start(void) {
     v_command = 0.0f;
     v_target = 0.0f;
+    blackbox_mark = MARK_NONE;
+    blackbox_start();
+    line_seen_us = hal_time_us_32();
+    line_out_sent = false;
+    event_reset();
+    slip_reset();
+    slip_count = 0;
+    is_path_curvature_known = false;
+    steer_feedforward = 0.0f;
+    accel = drive_accel;
+    decel = drive_decel;
     motor_control_start(drive_velocity_commander);
 }
 
@@ -121,95 +262,165 @@ static void drive_stop(bool force) {
 
     v_target = 0.0f;
     while (v_command > 0.1f) {
-        tight_loop_contents();
+        hal_tight_loop();
     }
-    busy_wait_ms(100);
+    hal_busy_wait_ms(100);
     motor_control_stop();
 }
 
-#define DRIVE_SET_PARAMETER(param, name, format, delta)                   \
-    oled_clear();                                                         \
-    for (;;) {                                                            \
-        oled_printf("/0/gSet Parameter/1/w" name "/2:=" format, (param)); \
-        enum switch_event_t sw = switch_read();                           \
-        if (sw == SWITCH_EVENT_BOTH)                                      \
-            break;                                                        \
-        else if (sw == SWITCH_EVENT_LEFT)                                 \
-            (param) -= (delta);                                           \
-        else if (sw == SWITCH_EVENT_RIGHT)                                \
-            (param) += (delta);                                           \
+/**
+ * @brief 맵의 index번째 마크가 직선 구간의 시작인지 구한다.
+ * 같은 마크(크로스 제외)가 두 번 연속되면 두 번째 마크부터 다음 마크까지를 직선 구간으로 본다.
+ * 직선 구간이 끝난 후 또 같은 마크가 나올 수 있으므로(이런 경우는 직선 구간이 아님), 쌍을 이룬 마크는 다음 쌍에 쓰지 않는다.
+ */
+static bool drive_is_straight_start(const enum mark_t *marks, uint index) {
+    enum mark_t previous = MARK_BOTH;
+
+    for (uint i = 0; i < index; i++) {
+        previous = (marks[i] == previous && marks[i] != MARK_CROSS) ? MARK_NONE : marks[i];
     }
+    return marks[index] == previous && marks[index] != MARK_CROSS;
+}
 
-void drive(const enum drive_t type) {
-    static int mark_recover_enabled = 0;
-    static float v_default = 3.0f;
-    static float v_peak = 8.0f;
-    static float fit_in = 0.18f;
-    static float safe_distance = 0.2f;
-
-    // 상수 설정
-    DRIVE_SET_PARAMETER(v_default, "default velocity", "%1.2f", 0.1f);
-    DRIVE_SET_PARAMETER(curve_coef, "curvature coefficient", "%1.6f", 0.00001f);
-    DRIVE_SET_PARAMETER(curve_decel, "curve deceleration", "%5d", 1000);
-    DRIVE_SET_PARAMETER(fit_in, "fit in", "%1.2f", 0.01f);
-    if (type != DRIVE_FIRST) {
-        DRIVE_SET_PARAMETER(v_peak, "peak velocity", "%1.2f", 0.1f);
-        DRIVE_SET_PARAMETER(accel, "accel", "%1.2f", 1.0f);
-        DRIVE_SET_PARAMETER(decel, "decel", "%1.2f", 1.0f);
-        DRIVE_SET_PARAMETER(mark_recover_enabled, "mark recover", "%d", 1);
+/**
+ * @brief [n차 주행] 구간 index의 최고 속도. 반복 모드이면(table) 학습한 속도, 아니면 직선은 v_peak, 곡선은 v_default이다.
+ * 구간 밖(맵의 처음과 끝 너머)은 v_default이다.
+ */
+static float drive_segment_velocity(const struct segment_list_t *segments, const struct escalate_table_t *table,
+                                    int index, float v_default, float v_peak) {
+    if (index < 0 || index >= (int)segments->count) {
+        return v_default;
+    }
+    if (table) {
+        return table->limit[index].velocity;
+    }
+    return segments->segment[index].type == SEGMENT_STRAIGHT ? v_peak : v_default;
+}
+
+/*
+ * [n차 주행 반복 모드] 구간별 여유 지표. (크기가 커서 스택 대신 정적 영역에 둔다)
+ */
+static struct escalate_margin_t segment_margin[SEGMENT_COUNT_MAX];
+
+/*
+ * [1차 주행] 좌우 엔코더 차이로 분류한 직선, 곡선 구간. 저장하기로 하면 flash에 복사된다.
+ * (크기가 커서 스택 대신 정적 영역에 둔다)
+ */
+static struct segment_list_t segment_list;
+
+void drive(const enum drive_t type, const bool quick) {
+    // 파라미터 설정: quick 모드에서는 저장된 파라미터로 바로 주행한다.
+    if (!quick) {
+        param_edit(type == DRIVE_FIRST ? PARAM_GROUP_DRIVE : PARAM_GROUP_DRIVE | PARAM_GROUP_DRIVE_SECOND);
     }
     oled_clear();
 
     // [1차, n차 주행] 마크 및 거리 정보
     enum mark_t detected_mark[DRIVE_MARK_COUNT_MAX];
     uint detected_mark_count = 0;
-    int32_t detected_tick[DRIVE_MARK_COUNT_MAX];
-    int mark_index = 0;
+    int32_t detected_tick[DRIVE_MARK_COUNT_MAX]; // 마크를 처음 본 위치
+    int32_t detected_exit_tick[DRIVE_MARK_COUNT_MAX]; // 마크를 마지막으로 본 위치
+    struct map_match_t match;
 
-    // [n차 주행] 직선 가속에 사용될 변수들
-    enum mark_t previous_mark = MARK_BOTH;
+    // [n차 주행] 직선 가속에 사용될 변수들. 위치는 모두 맵 좌표(map_locate)이다.
     bool is_mark_valid = true;
-    uint d_straight_end = 0;
-    uint d_straight_start = 0;
+    int32_t d_straight_end = 0;
+    int32_t d_straight_start = 0;
 
     struct fs_data_t *const fs_data = fs_get_data();
 
+    /*
+     * [n차 주행] 1차 주행에서 분류한 구간이 있으면 직선 구간에서 가속하고, 없으면(이전에 저장한 맵) 마크 쌍으로 찾은 직선에서 가속한다.
+     * 구간을 저장한 적 없는 flash에는 임의의 값이 있을 수 있으므로 개수를 확인한다.
+     */
+    const struct segment_list_t *const segments = &fs_data->segment_list;
+    const bool use_segments = segments->count > 0 && segments->count <= SEGMENT_COUNT_MAX;
+    int segment_index = 0;
+    int safe_segment_index = -1; // 아래 안전 거리를 구한 구간
+    int32_t safe_start_tick = 0, safe_end_tick = 0; // 구간 시작, 끝의 안전 거리 (map_safe_tick)
+
+    /*
+     * [n차 주행 반복 모드] 구간별 최고 속도를 flash의 표(escalate.h)에서 읽고, 주행이 끝나면 결과로 표를 갱신한다.
+     * 표가 현재 구간들에 대한 것이 아니면 모든 구간을 기본 속도로 하여 새로 시작한다.
+     */
+    struct escalate_table_t *const escalate_table =
+        type != DRIVE_FIRST && use_segments && drive_escalate ? &fs_data->escalate : NULL;
+    int line_segment_index = ESCALATE_NONE; // 마지막으로 라인을 본 구간
+
+    if (escalate_table) {
+        if (!escalate_is_valid(escalate_table, segments)) {
+            escalate_reset(escalate_table, segments, drive_v_default);
+        }
+        escalate_margin_reset(segment_margin, segments->count);
+    }
+
     // [n차 주행] 플래시에서 마크와 거리 정보 불러오기
     if (type != DRIVE_FIRST) {
         detected_mark_count = fs_data->detected_mark_count;
-        memcpy(detected_mark, fs_data->detected_mark, DRIVE_MARK_COUNT_MAX);
-        memcpy(detected_tick, fs_data->detected_tick, DRIVE_MARK_COUNT_MAX);
+        memcpy(detected_mark, fs_data->detected_mark, sizeof(detected_mark));
+        memcpy(detected_tick, fs_data->detected_tick, sizeof(detected_tick));
+        memcpy(detected_exit_tick, fs_data->detected_exit_tick, sizeof(detected_exit_tick));
     }
+    map_match_init(&match, detected_mark, detected_tick, detected_mark_count);
 
-    // state machine 초기화
-    struct mark_state_t mark_state = mark_init_state();
-    uint line_out_state = DRIVE_LINE_OUT_STATE_IDLE;
     uint mark_end_count = 0;
+    int32_t d_end_located = 0; // [n차 주행] 두 번째 엔드 마크의 맵 좌표
+
+    if (type == DRIVE_FIRST) {
+        segment_begin(&segment_list);
+    }
 
     buzzer_init();
+    telemetry_start(TELEMETRY_STREAM_ALL);
     sensing_start();
+    mark_start(); // 마크 state machine은 센싱 IRQ에서 매 주기 수행된다.
+    margin_peak = (struct escalate_margin_t){ 0 };
     drive_start();
 
-    while (!drive_check_line_out(&line_out_state)) {
+    while (!drive_handle_events()) {
         buzzer_update();
-
-        // mark state machine 업데이트
-        mark_update_window(&mark_state, sensing_ir_position);
-        const enum mark_t mark = mark_update_state(&mark_state);
+        telemetry_flush();
+
+        // 파라미터는 주행 중에도 USB 명령으로 바뀔 수 있으므로, 매 루프마다 한 번씩 읽어 루프 안에서는 같은 값을 사용한다.
+        command_poll();
+        const float v_default = drive_v_default;
+        const float v_peak = drive_v_peak;
+        const float fit_in = drive_fit_in;
+        const float safe_distance = drive_safe_distance;
+        const int mark_recover_enabled = drive_mark_recover;
+        accel = drive_accel;
+        decel = drive_decel;
+
+        // 센싱 IRQ에서 결정된 마크를 하나 꺼낸다. 루프가 늦어 여러 개가 쌓였다면 다음 루프에서 차례로 처리한다.
+        struct mark_event_t event;
+        const enum mark_t mark = mark_poll(&event) ? event.mark : MARK_NONE;
+        if (mark) {
+            blackbox_mark = mark;
+        }
 
         // 엔코더로부터 현재 위치 구하기
         const int32_t d_current =
             (abs(motor_get_encoder_value(MOTOR_LEFT)) + abs(motor_get_encoder_value(MOTOR_RIGHT))) / 2;
 
+        /*
+         * 마크의 위치. 마크가 결정되는 시점은 마크를 지난 뒤 재확인 횟수에 따라 2 ~ 4cm 늦어지므로,
+         * 마크를 처음 본 위치(entry)를 맵과 직선 구간 계산의 기준으로 사용한다.
+         */
+        const int32_t d_mark = mark ? event.entry : d_current;
+
         if (type == DRIVE_FIRST) {
             /*
              * 1차 주행에서는, 기본 속도로 주행하고, 감지된 마크와 그 위치를 저장해둔다.
              */
             v_target = v_default;
 
-            if (mark) {
+            segment_update(&segment_list, abs(motor_get_encoder_value(MOTOR_LEFT)),
+                           abs(motor_get_encoder_value(MOTOR_RIGHT)));
+
+            if (mark && detected_mark_count < DRIVE_MARK_COUNT_MAX) {
                 detected_mark[detected_mark_count] = mark; // 마크 기록
-                detected_tick[detected_mark_count] = d_current; // 엔코더 값 기록
+                detected_tick[detected_mark_count] = d_mark; // 엔코더 값 기록
+                detected_exit_tick[detected_mark_count] = event.exit;
                 detected_mark_count++;
 
                 if (mark != MARK_CROSS) { // 크로스가 아닌 마크를 보면 부저를 울린다.
@@ -218,94 +429,170 @@ void drive(const enum drive_t type) {
             }
         } else {
             /*
-             * n차 주행에서는, 똑같은 마크가 두 번 반복된다면 직선 구간이라고 판단하고,
+             * n차 주행에서는, 본 마크를 맵에 맞추고(map.h), 맞춘 맵 마크가 직선 구간의 시작이라면
              * 직선 구간의 시작 위치와, 종료 위치를 구해 놓는다.
+             * 맵에 없는 마크는 무시하고, 놓친 마크는 건너뛰어 다음 마크에서 바로 맵 위치를 되찾는다.
              */
-            if (mark && is_mark_valid && mark_index < detected_mark_count) {
-                // 마크를 제대로 본 경우
-                if (mark == detected_mark[mark_index]) {
-                    // 이전에 본 마크와 현재 본 마크가 같다면 -> 직선 구간
-                    if (mark == previous_mark && mark != MARK_CROSS) {
-                        // 가속을 시작하는 위치 구하기
-                        d_straight_start = d_current;
-                        d_straight_start += safe_distance * MOTOR_TICK_PER_METER; // 안전 거리
-
-                        // 가속을 끝내는 위치 구하기
-                        int start = mark_index; // 직선 구간 시작 위치 인덱스
-                        int end = mark_index + 1; // 직선 구간 종료 위치 인덱스
-                        while (detected_mark[end] == MARK_CROSS && (end + 1) < detected_mark_count) {
-                            end++; // 직선 구간 종료 위치 구하기: 크로스 구간은 건너 뛴다.
-                        }
-                        d_straight_end = d_current + (detected_tick[end] - detected_tick[start]);
-                        d_straight_end -= safe_distance * MOTOR_TICK_PER_METER; // 안전 거리
-
-                        // 직선 구간이 끝난 후 또 같은 마크가 나올 수 있으므로(이런 경우는 직선 구간이 아님) MARK_NONE으로 설정하여 예외 처리한다.
-                        previous_mark = MARK_NONE;
-                    } else {
-                        previous_mark = mark;
-                    }
+            if (mark && is_mark_valid) {
+                const uint skipped = match.skipped;
+                const int index = map_match(&match, mark, d_mark);
+                const bool is_exact = index != MAP_MATCH_NONE && match.skipped == skipped;
 
-                    mark_index++;
-                    if (mark != MARK_CROSS) { // 크로스가 아닌 마크를 보면 부저를 울린다.
-                        buzzer_out(80, false);
+                if (!is_exact) {
+                    buzzer_out(1000, true);
+                    // 마크 복구를 사용하지 않으면, 맵과 어긋난 이후로는 직선 가속을 하지 않는다.
+                    if (!mark_recover_enabled) {
+                        is_mark_valid = false;
                     }
+                } else if (mark != MARK_CROSS) { // 크로스가 아닌 마크를 보면 부저를 울린다.
+                    buzzer_out(80, false);
                 }
-                // 마크를 놓친 경우: 직선 가속 구간 설정 일단 중지
-                else {
-                    is_mark_valid = false;
-                    previous_mark = MARK_NONE;
-                    buzzer_out(1000, true);
+
+                if (is_mark_valid && index != MAP_MATCH_NONE && index + 1 < detected_mark_count &&
+                    drive_is_straight_start(detected_mark, index)) {
+                    // 가속을 시작하는 위치 구하기: 방금 맞춘 마크의 맵 좌표는 detected_tick[index]이다.
+                    const int32_t safe_tick = safe_distance * MOTOR_TICK_PER_METER;
+                    d_straight_start = detected_tick[index];
+                    d_straight_start += map_safe_tick(fs_data, d_straight_start, safe_tick); // 안전 거리
+
+                    // 가속을 끝내는 위치 구하기
+                    int end = index + 1; // 직선 구간 종료 위치 인덱스
+                    while (detected_mark[end] == MARK_CROSS && (end + 1) < detected_mark_count) {
+                        end++; // 직선 구간 종료 위치 구하기: 크로스 구간은 건너 뛴다.
+                    }
+                    d_straight_end = detected_tick[end];
+                    d_straight_end -= map_safe_tick(fs_data, d_straight_end, safe_tick); // 안전 거리
                 }
             }
 
             /*
-             * 마크를 놓친 경우, 다음 크로스 마크가 올 때까지 기다린다(마크 복구).
+             * 현재 라인트레이서가 가속 구간에 위치한다면, 가속을 진행한다.
+             * 가속을 끝낼 때에는, 감속도에 의해 적절히 다음 구간의 속도로 되돌아 가야 한다.
+             * 이를 위해 2as = (v' + v) * (v' - v) 식을 이용하여 현재 속도 v'에서 다음 속도 v로 되돌아 가기 위한 거리를 구한다.
+             *
+             * 직선 구간은 맵 좌표로 구해 두었으므로, 현재 위치도 마지막으로 맞춘 마크와 거리 배율로 보정한 맵 좌표로 비교한다.
+             * 감속 거리는 현재 주행의 거리이므로 배율을 곱해 맵 거리로 바꾼다.
+             * 직선 도중에 크로스 마크를 맞추면 보정이 갱신되어 감속 위치도 함께 옮겨진다.
              */
-            if (mark_recover_enabled && mark == MARK_CROSS && !is_mark_valid) {
-                is_mark_valid = true; // 일단 복구 성공했다고 가정
+            const int32_t d_located = map_locate(&match, d_current);
+
+            if (use_segments) {
+                segment_index = segment_find(segments, d_located, segment_index);
+                const struct segment_t *const segment =
+                    segment_index >= 0 ? &segments->segment[segment_index] : NULL;
+
+                // 안전 거리는 여러 1차 주행을 합친 맵이면 구간 끝 마크의 위치 분산으로, 아니면 파라미터로 정한다.
+                if (segment && segment_index != safe_segment_index) {
+                    const int32_t safe_tick = safe_distance * MOTOR_TICK_PER_METER;
+                    safe_start_tick = map_safe_tick(fs_data, segment->start, safe_tick);
+                    safe_end_tick = map_safe_tick(fs_data, segment->end, safe_tick);
+                    safe_segment_index = segment_index;
+                }
 
-                while (detected_mark[++mark_index] != MARK_CROSS) { // 크로스 마크일 때까지 인덱스 증가
-                    if (mark_index >= detected_mark_count) { // 마크 수를 넘겨 버리면 invalid
-                        is_mark_valid = false;
-                        break;
+                /*
+                 * 슬립 추정에 쓸 곡률. 맵 위치가 조금 어긋나도 곡선에 먼저 들어간 것을 슬립으로 보지 않도록,
+                 * 안전 거리 안에서는 앞뒤 구간 중 더 크게 도는 쪽의 곡률을 쓴다.
+                 */
+                if (segment) {
+                    float curvature = segment_curvature(segment);
+                    int neighbor = -1;
+                    if (d_located <= segment->start + safe_start_tick) {
+                        neighbor = segment_index - 1;
+                    } else if (d_located >= segment->end - safe_end_tick) {
+                        neighbor = segment_index + 1;
                     }
-                }
 
-                if (is_mark_valid) {
-                    previous_mark = MARK_CROSS;
-                    mark_index++;
+                    // 앞먹임 조향: 곡률 k로 돌려면 좌우 속도 차이가 k * 바퀴 간격 * 속도이므로 조향 비율은 k * 바퀴 간격 / 2
+                    steer_feedforward = neighbor < 0 && is_mark_valid
+                                            ? drive_steer_feedforward * curvature * MOTOR_TRACK_WIDTH_M / 2
+                                            : 0.0f;
+
+                    if (neighbor >= 0 && neighbor < (int)segments->count &&
+                        fabsf(segment_curvature(&segments->segment[neighbor])) > fabsf(curvature)) {
+                        curvature = segment_curvature(&segments->segment[neighbor]);
+                    }
+                    path_curvature = curvature;
+                }
+                is_path_curvature_known = segment != NULL;
+                if (!segment) {
+                    steer_feedforward = 0.0f;
                 }
-            }
 
-            /*
-             * 현재 라인트레이서가 가속 구간에 위치한다면, 가속을 진행한다.
-             * 가속을 끝낼 때에는, 감속도에 의해 적절히 원래 속도로 되돌아 가야 한다.
-             * 이를 위해 2as = (v' + v) * (v' - v) 식을 이용하여 현재 속도 v'에서 원래 속도 v로 되돌아 가기 위한 거리를 구한다.
-             */
-            const float decel_section = // Unit: m * (tick / m) -> tick
-                ((v_command + v_default) * (v_command - v_default)) / (2.0f * decel) * MOTOR_TICK_PER_METER;
+                /*
+                 * 구간의 최고 속도로 주행하되, 안전 거리 안에서는 앞뒤 구간 중 느린 쪽의 속도를 따른다.
+                 * 반복 모드가 아니면 직선만 v_peak이므로, 직선의 안전 거리 사이에서만 가속하는 것과 같다.
+                 */
+                if (segment && is_mark_valid) {
+                    const float v_here =
+                        drive_segment_velocity(segments, escalate_table, segment_index, v_default, v_peak);
+                    const float v_previous =
+                        drive_segment_velocity(segments, escalate_table, segment_index - 1, v_default, v_peak);
+                    const float v_next =
+                        drive_segment_velocity(segments, escalate_table, segment_index + 1, v_default, v_peak);
+                    const float decel_section = // Unit: m * (tick / m) -> tick
+                        ((v_command + v_next) * (v_command - v_next)) / (2.0f * decel) * MOTOR_TICK_PER_METER;
+
+                    if (d_located <= segment->start + safe_start_tick) {
+                        v_target = fminf(v_here, v_previous);
+                    } else if (d_located >= segment->end - safe_end_tick - decel_section * match.scale) {
+                        v_target = fminf(v_here, v_next);
+                    } else {
+                        v_target = v_here;
+                    }
+                } else {
+                    v_target = v_default;
+                }
 
-            if (d_straight_start < d_current && d_current < (d_straight_end - decel_section)) {
-                v_target = v_peak; // 가속 구간: 최대 속도로 주행한다.
+                // 반복 모드: 이번 루프까지 잰 여유 지표를 현재 구간에 더한다.
+                if (escalate_table && segment_index >= 0) {
+                    const struct escalate_margin_t peak = margin_peak;
+                    margin_peak = (struct escalate_margin_t){ 0 };
+                    escalate_margin_add(&segment_margin[segment_index], &peak);
+                    if (_is_on_line()) {
+                        line_segment_index = segment_index;
+                    }
+                }
             } else {
-                v_target = v_default; // 원래 속도로 되돌아 간다.
+                const float decel_section = // Unit: m * (tick / m) -> tick
+                    ((v_command + v_default) * (v_command - v_default)) / (2.0f * decel) * MOTOR_TICK_PER_METER;
+
+                if (d_straight_start < d_located && d_located < (d_straight_end - decel_section * match.scale)) {
+                    v_target = v_peak; // 가속 구간: 최대 속도로 주행한다.
+                } else {
+                    v_target = v_default; // 원래 속도로 되돌아 간다.
+                }
             }
         }
 
         if (mark) {
+            const struct telemetry_mark_t frame = {
+                .time_us = event.time_us,
+                .mark = mark,
+                .distance = d_mark,
+            };
+            telemetry_push(TELEMETRY_FRAME_MARK, &frame, sizeof(frame));
+
             if (mark == MARK_BOTH) { // 엔드 마크 증가
                 mark_end_count++;
             }
 
             if (mark_end_count == 2) { // 엔드 마크를 두 번 봤으면 주행을 종료한다.
+                d_end_located = map_locate(&match, d_mark);
                 decel = (v_command * v_command) / (2.0f * fit_in);
                 drive_stop(false); // 속도가 0으로 떨어질 때까지 계속 주행한다.
                 break;
             }
         }
     }
+    if (type == DRIVE_FIRST) {
+        segment_end(&segment_list);
+        segment_snap(&segment_list, detected_mark, detected_tick, detected_mark_count);
+    }
+    blackbox_freeze(mark_end_count == 2 ? BLACKBOX_FREEZE_END : BLACKBOX_FREEZE_LINE_OUT);
     drive_stop(true); // 모터 및 모터 컨트롤을 바로 중단한다.
+    mark_stop();
     sensing_stop();
+    telemetry_stop();
 
     oled_clear();
     if (mark_end_count == 2) {
@@ -313,6 +600,28 @@ void drive(const enum drive_t type) {
     } else {
         oled_printf("/0Drive finished");
     }
+    if (type != DRIVE_FIRST) {
+        oled_printf("/6Slip /g%u", slip_count);
+    }
+
+    /*
+     * 반복 모드: 완주했으면 여유가 남은 구간을 올리고, 라인 이탈했으면 그 구간을 내린 뒤 flash에 저장한다.
+     * 어느 구간에서 이탈했는지 모르면 표를 바꾸지 않는다.
+     * 라인을 벗어나 흔들리는 동안 엔드 마크를 잘못 볼 수 있으므로, 두 번째 엔드 마크가 맵의 끝 근처일 때만 완주로 본다.
+     */
+    if (escalate_table) {
+        const bool is_completed = mark_end_count == 2 && detected_mark_count > 0 &&
+                                  d_end_located > detected_tick[detected_mark_count - 1] - ESCALATE_FINISH_TICK;
+        const uint changed = escalate_update(escalate_table, segments, segment_margin, is_completed,
+                                             line_segment_index, drive_v_default, drive_v_peak);
+        const char *result = is_completed ? "raised" : "backed off";
+        if (!is_completed && line_segment_index == ESCALATE_NONE) {
+            result = "skipped";
+        }
+        oled_printf("/2Lap /g%u/w: %s /g%u", escalate_table->run_count, result, changed);
+        oled_printf("/3Saving ...");
+        fs_flush_data();
+    }
 
     if (type == DRIVE_FIRST) {
         // 마크 개수 확인
@@ -332,17 +641,48 @@ void drive(const enum drive_t type) {
         oled_printf("/3Do you want/4to /gsave/w mark?/5 (YES // NO)");
         enum switch_event_t sw = switch_wait_until_input();
         if (sw == SWITCH_EVENT_LEFT) {
-            oled_printf("/6Saving ...");
-            fs_data->detected_mark_count = detected_mark_count;
-            for (int i = 0; i < DRIVE_MARK_COUNT_MAX; i++) {
-                if (i < detected_mark_count) {
-                    fs_data->detected_mark[i] = detected_mark[i];
-                    fs_data->detected_tick[i] = detected_tick[i];
-                } else {
-                    fs_data->detected_mark[i] = MARK_NONE;
-                    fs_data->detected_tick[i] = 0;
+            // 저장된 맵이 있으면, 새 맵으로 바꿀지 이번 주행을 합칠지(map_merge) 묻는다.
+            bool merge = false;
+            if (fs_data->detected_mark_count > 0 && fs_data->detected_mark_count <= DRIVE_MARK_COUNT_MAX) {
+                oled_clear();
+                oled_printf("/0Merge with/1saved map?/2 (YES // NO)");
+                merge = switch_wait_until_input() == SWITCH_EVENT_LEFT;
+            }
+
+            if (merge) {
+                if (map_merge(fs_data, detected_mark, detected_tick, detected_exit_tick, detected_mark_count)) {
+                    oled_printf("/4/rRejected:/5/wrun differs");
+                    return;
                 }
+                // 마크 위치가 평균으로 옮겨졌으므로 구간 경계를 다시 맞춘다.
+                segment_snap(&fs_data->segment_list, fs_data->detected_mark, fs_data->detected_tick,
+                             fs_data->detected_mark_count);
+
+                float std_max = 0.0f;
+                for (uint i = 0; i < fs_data->detected_mark_count; i++) {
+                    const float std = map_stat_std(&fs_data->detected_stat[i]);
+                    std_max = std > std_max ? std : std_max;
+                }
+                oled_printf("/4Merged /g%u/w runs/5max std /g%.1f/w mm", fs_data->map_run_count,
+                            std_max / MOTOR_TICK_PER_METER * 1000);
+            } else {
+                fs_data->detected_mark_count = detected_mark_count;
+                for (int i = 0; i < DRIVE_MARK_COUNT_MAX; i++) {
+                    if (i < detected_mark_count) {
+                        fs_data->detected_mark[i] = detected_mark[i];
+                        fs_data->detected_tick[i] = detected_tick[i];
+                        fs_data->detected_exit_tick[i] = detected_exit_tick[i];
+                    } else {
+                        fs_data->detected_mark[i] = MARK_NONE;
+                        fs_data->detected_tick[i] = 0;
+                        fs_data->detected_exit_tick[i] = 0;
+                    }
+                }
+                fs_data->segment_list = segment_list;
+                fs_data->escalate.count = 0; // 새 맵이므로 구간별 속도를 다시 배운다.
+                map_stat_reset(fs_data);
             }
+            oled_printf("/6Saving ...");
             fs_flush_data();
         }
     }
@@ -1,6 +1,7 @@
 #ifndef _DRIVE_H_
 #define _DRIVE_H_
 
+#include "pico/types.h"
 #include "config.h"
 
 enum drive_t {
@@ -8,14 +9,45 @@ enum drive_t {
     DRIVE_SECOND,
 };
 
-void drive(const enum drive_t type);
+/*
+ * 주행 파라미터. 파라미터 레지스트리(param.h)에 등록되어 편집 및 flash 저장이 가능하다.
+ */
+extern volatile float drive_v_default; // 기본 속도
+extern volatile float drive_v_peak; // 직선 구간 최대 속도
+extern volatile float drive_accel; // 가속도
+extern volatile float drive_decel; // 감속도
+extern volatile int drive_curve_decel; // 커브 감속 (작을 수록 곡선에서 감속을 많이 한다)
+extern volatile float drive_curve_coef; // 곡률 계수
+extern volatile float drive_look_ahead; // 조향에 쓸 position을 예측하는 시간 (s, 0이면 현재 position으로 조향한다)
+extern volatile float drive_steer_velocity; // 이 속도보다 빠르면 곡률 계수를 속도에 반비례하여 줄인다 (m/s, 0이면 줄이지 않는다)
+extern volatile float drive_fit_in; // 엔드 마크 이후 정지할 거리
+extern volatile float drive_safe_distance; // 직선 가속 구간의 안전 거리
+extern volatile int drive_mark_recover; // 마크 복구 사용 여부 (0이면 맵과 어긋난 이후로 직선 가속을 하지 않는다)
+extern volatile int drive_escalate; // n차 주행 반복 모드 (1이면 구간별 최고 속도를 flash의 표로 정하고, 주행마다 갱신한다)
+extern volatile float drive_steer_feedforward; // 맵 곡률 앞먹임 조향 비율 (n차 주행에서 구간 곡률로 구한 조향 비율에 곱한다, 0이면 쓰지 않는다)
+
+/**
+ * @brief 주행을 수행한다.
+ *
+ * @param type DRIVE_FIRST(1차 주행) 또는 DRIVE_SECOND(n차 주행)
+ * @param quick 참이면 파라미터 편집 화면을 건너뛰고 저장된 파라미터로 바로 주행을 시작한다.
+ */
+void drive(const enum drive_t type, const bool quick);
 
 static inline void drive_first() {
-    drive(DRIVE_FIRST);
+    drive(DRIVE_FIRST, false);
 }
 
 static inline void drive_second() {
-    drive(DRIVE_SECOND);
+    drive(DRIVE_SECOND, false);
+}
+
+static inline void drive_first_quick() {
+    drive(DRIVE_FIRST, true);
+}
+
+static inline void drive_second_quick() {
+    drive(DRIVE_SECOND, true);
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,83 @@
+/**
+ * @file escalate.c
+ * @brief 구간별 최고 속도 학습 구현
+ *
+ * 곡선에서의 라인 이탈은 곡선 속도가 높아서일 수도 있지만, 앞 직선에서 늦게 감속해서일 수도 있다.
+ * 어느 쪽인지 구분할 수 없으므로 두 구간을 함께 내린다.
+ */
+
+#include "escalate.h"
+
+void escalate_reset(struct escalate_table_t *table, const struct segment_list_t *list, float v_initial) {
+    table->count = list->count;
+    table->run_count = 0;
+    for (uint i = 0; i < SEGMENT_COUNT_MAX; i++) {
+        table->limit[i] = (struct escalate_limit_t){ .velocity = v_initial, .state = ESCALATE_RAISING };
+    }
+}
+
+void escalate_margin_reset(struct escalate_margin_t *margins, uint count) {
+    for (uint i = 0; i < count; i++) {
+        margins[i] = (struct escalate_margin_t){ 0 };
+    }
+}
+
+/**
+ * @brief 구간 index의 속도를 ESCALATE_BACKOFF_STEPS 단계 내린다.
+ */
+static void escalate_back_off(struct escalate_table_t *table, const struct segment_list_t *list, int index,
+                              float v_min) {
+    struct escalate_limit_t *const limit = &table->limit[index];
+    const float step =
+        list->segment[index].type == SEGMENT_STRAIGHT ? ESCALATE_STEP_STRAIGHT : ESCALATE_STEP_CURVE;
+
+    limit->velocity -= step * ESCALATE_BACKOFF_STEPS;
+    if (limit->velocity < v_min) {
+        limit->velocity = v_min;
+    }
+    limit->state = ESCALATE_BACKED_OFF;
+}
+
+uint escalate_update(struct escalate_table_t *table, const struct segment_list_t *list,
+                     const struct escalate_margin_t *margins, bool is_completed, int line_out_index, float v_min,
+                     float v_max) {
+    uint changed = 0;
+
+    if (!is_completed) {
+        if (line_out_index == ESCALATE_NONE) {
+            return 0; // 내릴 구간을 모르는 주행은 완주로도, 실패로도 세지 않는다.
+        }
+
+        table->run_count++;
+        for (int i = line_out_index - 1; i <= line_out_index; i++) {
+            if (i >= 0 && i < (int)table->count) {
+                escalate_back_off(table, list, i, v_min);
+                changed++;
+            }
+        }
+        return changed;
+    }
+
+    table->run_count++;
+    for (uint i = 0; i < table->count; i++) {
+        struct escalate_limit_t *const limit = &table->limit[i];
+        const float step = list->segment[i].type == SEGMENT_STRAIGHT ? ESCALATE_STEP_STRAIGHT : ESCALATE_STEP_CURVE;
+
+        if (limit->state != ESCALATE_RAISING) {
+            continue;
+        }
+        if (!escalate_margin_ok(&margins[i])) {
+            limit->state = ESCALATE_HELD;
+            continue;
+        }
+        if (limit->velocity + step > v_max) {
+            continue; // 올릴 수 있는 최대 속도
+        }
+
+        limit->velocity += step;
+        limit->raise_count++;
+        changed++;
+    }
+
+    return changed;
+}
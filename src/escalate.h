@@ -0,0 +1,110 @@
+/**
+ * @file escalate.h
+ * @brief n차 주행을 거듭하며 구간(segment.h)별 최고 속도를 올리는 모듈
+ *
+ * 구간마다 최고 속도를 두고, 완주한 주행마다 여유가 남은 구간의 속도를 한 단계씩 올린다.
+ * 여유는 주행 중 그 구간에서 잰 지표들의 최댓값으로 판단한다.
+ * - position: IR position의 절댓값. 라인이 센서 보드 끝으로 갈수록 커진다.
+ * - steer: 조향 비율(curve_coef * position)의 절댓값. 1이면 안쪽 바퀴가 멈춘다.
+ * - slip: 모터 위치 제어의 오차(목표 - 엔코더). 바퀴가 지령을 따라가지 못하면 커진다.
+ * - slip_level: 슬립 정도(slip.h). 1 이상이면 바퀴가 미끄러진 것이다.
+ * 지표 하나라도 한계를 넘은 구간은 더 올리지 않고, 라인 이탈한 구간과 그 앞 구간은 속도를 내린 뒤 더 올리지 않는다.
+ * 구간 표는 flash에 저장되므로 주행을 반복하면 랩 타임이 수렴한다.
+ *
+ *   escalate_margin_reset(margins, count); // 주행 시작
+ *   escalate_margin_add(&margins[index], &peak); // 메인 루프마다 (현재 구간에서 잰 최댓값)
+ *   escalate_update(&table, list, margins, is_completed, line_out_index, v_min, v_max); // 주행 종료 후 flash에 저장한다.
+ */
+
+#ifndef _ESCALATE_H_
+#define _ESCALATE_H_
+
+#include "pico/types.h"
+#include "config.h"
+#include "segment.h"
+
+#define ESCALATE_NONE (-1)
+
+enum escalate_state_t {
+    ESCALATE_RAISING = 0, // 여유가 있어 완주할 때마다 속도를 올린다.
+    ESCALATE_HELD, // 지표가 한계에 닿아 속도를 유지한다.
+    ESCALATE_BACKED_OFF, // 라인 이탈로 속도를 내렸다.
+};
+
+/**
+ * @brief 한 구간에서 잰 여유 지표의 최댓값
+ */
+struct escalate_margin_t {
+    float position; // IR position 절댓값
+    float steer; // 조향 비율 절댓값
+    float slip; // 모터 위치 제어 오차 (tick)
+    float slip_level; // 슬립 정도 (slip.h)
+};
+
+struct escalate_limit_t {
+    float velocity; // 구간 최고 속도 (m/s)
+    uint8_t state; // enum escalate_state_t
+    uint8_t raise_count; // 속도를 올린 횟수
+    uint16_t reserved;
+};
+
+/**
+ * @brief 구간별 최고 속도 표. 구간 수(count)가 저장된 구간 목록과 같을 때에만 유효하다.
+ */
+struct escalate_table_t {
+    uint count;
+    uint run_count; // 표를 갱신한 주행 수
+    struct escalate_limit_t limit[SEGMENT_COUNT_MAX];
+};
+
+/**
+ * @brief 표가 list의 구간들에 대한 것인지 확인한다. 아니면(새 맵, 저장한 적 없는 flash) escalate_reset으로 다시 만든다.
+ */
+static inline bool escalate_is_valid(const struct escalate_table_t *table, const struct segment_list_t *list) {
+    return table->count == list->count && table->run_count <= ESCALATE_RUN_MAX;
+}
+
+/**
+ * @brief 모든 구간의 최고 속도를 v_initial로 하여 표를 새로 만든다.
+ */
+void escalate_reset(struct escalate_table_t *table, const struct segment_list_t *list, float v_initial);
+
+/**
+ * @brief 지표를 주행 시작 상태(0)로 되돌린다.
+ */
+void escalate_margin_reset(struct escalate_margin_t *margins, uint count);
+
+/**
+ * @brief peak의 지표들 중 margin보다 큰 값을 margin에 넣는다.
+ */
+static inline void escalate_margin_add(struct escalate_margin_t *margin, const struct escalate_margin_t *peak) {
+    margin->position = peak->position > margin->position ? peak->position : margin->position;
+    margin->steer = peak->steer > margin->steer ? peak->steer : margin->steer;
+    margin->slip = peak->slip > margin->slip ? peak->slip : margin->slip;
+    margin->slip_level = peak->slip_level > margin->slip_level ? peak->slip_level : margin->slip_level;
+}
+
+/**
+ * @brief 지표가 모두 한계 안에 있는지 확인한다.
+ */
+static inline bool escalate_margin_ok(const struct escalate_margin_t *margin) {
+    return margin->position < ESCALATE_POSITION_MAX && margin->steer < ESCALATE_STEER_MAX &&
+           margin->slip < ESCALATE_SLIP_MAX_TICK && margin->slip_level < ESCALATE_SLIP_LEVEL_MAX;
+}
+
+/**
+ * @brief 주행 결과로 표를 갱신한다.
+ * 완주했으면 올리는 중인 구간 중 여유가 남은 구간은 한 단계 올리고(v_max까지), 여유가 없는 구간은 유지한다.
+ * 라인 이탈했으면 그 구간과 앞 구간을 ESCALATE_BACKOFF_STEPS 단계 내린다(v_min까지).
+ * 라인 이탈했는데 어느 구간인지 모르면(첫 구간을 찾기 전에 이탈) 표를 바꾸지 않고 run_count에도 세지 않는다.
+ *
+ * @param margins 구간별 지표 (list의 구간 수만큼)
+ * @param is_completed 완주 여부
+ * @param line_out_index 라인 이탈한 구간의 인덱스, 모르면 ESCALATE_NONE (완주했으면 쓰지 않는다)
+ * @return 속도를 바꾼 구간 수
+ */
+uint escalate_update(struct escalate_table_t *table, const struct segment_list_t *list,
+                     const struct escalate_margin_t *margins, bool is_completed, int line_out_index, float v_min,
+                     float v_max);
+
+#endif
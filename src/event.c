@@ -0,0 +1,33 @@
+/**
+ * @file event.c
+ * @brief 인터럽트 핸들러에서 메인 루프로 보내는 이벤트 큐
+ */
+
+#include "hal.h"
+#include "event.h"
+#include "queue.h"
+
+QUEUE_DEFINE(events, struct event_t, EVENT_QUEUE_SIZE);
+
+void HAL_ISR_FUNC(event_push)(enum event_type_t type, int32_t value) {
+    const struct event_t event = {
+        .type = type,
+        .value = value,
+        .time_us = hal_time_us_32(),
+    };
+    queue_push(&events, &event);
+}
+
+bool event_poll(struct event_t *event) {
+    return queue_pop(&events, event);
+}
+
+void event_reset(void) {
+    const uint32_t status = hal_irq_save();
+    queue_reset(&events);
+    hal_irq_restore(status);
+}
+
+uint event_dropped(void) {
+    return events.overflow;
+}
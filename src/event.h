@@ -0,0 +1,53 @@
+/**
+ * @file event.h
+ * @brief 인터럽트 핸들러가 메인 루프에 알리는 이벤트 (라인 이탈, 제어 주기 밀림, 저전압, 슬립)
+ *
+ * 이벤트는 발생한 IRQ 안에서 큐(queue.h)에 넣고, 메인 루프는 event_poll로 꺼내 처리한다.
+ * 전역 변수를 계속 확인하지 않아도 되며, 메인 루프가 늦어도 이벤트를 잃지 않는다.
+ * 센싱과 모터 제어 IRQ는 같은 우선순위로 서로 끼어들지 않으므로 둘 다 event_push를 호출할 수 있다.
+ */
+
+#ifndef _EVENT_H_
+#define _EVENT_H_
+
+#include "pico/types.h"
+#include "config.h"
+
+enum event_type_t {
+    EVENT_NONE = 0,
+    EVENT_LINE_OUT, // 라인 이탈 (value: 라인을 마지막으로 본 후 경과 시간, us)
+    EVENT_CONTROL_OVERRUN, // 모터 제어 주기가 MOTOR_CONTROL_OVERRUN_US보다 길어짐 (value: 실제 주기, us)
+    EVENT_LOW_VOLTAGE, // 전원 전압이 SENSING_LOW_VOLTAGE 아래로 떨어짐 (value: 전압, mV)
+    EVENT_SLIP, // 바퀴 슬립을 감지함 (value: 슬립 정도 * 100, slip.h)
+};
+
+struct event_t {
+    enum event_type_t type;
+    int32_t value;
+    uint32_t time_us; // 이벤트가 발생한 시각
+};
+
+/**
+ * @brief [IRQ] 이벤트를 큐에 넣는다. 큐가 가득 차면 버리고 event_dropped를 증가시킨다.
+ */
+void event_push(enum event_type_t type, int32_t value);
+
+/**
+ * @brief 가장 오래된 이벤트를 하나 꺼낸다.
+ *
+ * @return 꺼냈으면 true, 큐가 비어 있으면 false
+ */
+bool event_poll(struct event_t *event);
+
+/**
+ * @brief 쌓인 이벤트를 버리고 event_dropped를 0으로 되돌린다. 주행을 시작하기 전에 호출한다.
+ * 다른 IRQ가 event_push를 호출할 수 있는 동안에는 인터럽트를 막고 비운다.
+ */
+void event_reset(void);
+
+/**
+ * @brief 큐가 가득 차 버려진 이벤트 수
+ */
+uint event_dropped(void);
+
+#endif
@@ -5,11 +5,11 @@
 #include "hardware/sync.h"
 
 /**
- * @brief flash의 size를 4KB로 설정한다.
- * flash에 쓸 수 있는 최소 크기인 FLASH_PAGE_SIZE(256 bytes)와 맞아 떨어지며,
- * flash를 지울 수 있는 최소 크기인 FLASH_SECTOR_SIZE(4096 bytes)와 맞아 떨어진다.
+ * @brief flash의 size를 12KB로 설정한다.
+ * flash에 쓸 수 있는 최소 크기인 FLASH_PAGE_SIZE(256 bytes)의 배수이며,
+ * flash를 지울 수 있는 최소 크기인 FLASH_SECTOR_SIZE(4096 bytes)의 배수(3개)이다.
  */
-#define FLASH_DATA_SIZE ((4) * (1024))
+#define FLASH_DATA_SIZE ((12) * (1024))
 
 /**
  * @brief flash의 offset을 정의한다.
@@ -18,6 +18,9 @@
  */
 #define FLASH_DATA_OFFSET ((1024) * (1024))
 
+_Static_assert(sizeof(struct fs_data_t) <= FLASH_DATA_SIZE, "struct fs_data_t does not fit in FLASH_DATA_SIZE");
+_Static_assert(FLASH_DATA_SIZE % FLASH_SECTOR_SIZE == 0, "FLASH_DATA_SIZE must be a multiple of FLASH_SECTOR_SIZE");
+
 union flash_memory {
     uint8_t memory[FLASH_DATA_SIZE];
     struct fs_data_t data;
@@ -43,6 +46,16 @@ int fs_format(void) {
     for (int i = 0; i < DRIVE_MARK_COUNT_MAX; i++) {
         data->detected_mark[i] = MARK_NONE;
         data->detected_tick[i] = 0;
+        data->detected_exit_tick[i] = 0;
+    }
+    data->segment_list.count = 0;
+    data->escalate.count = 0;
+    map_stat_reset(data);
+
+    // 서명이 일치하지 않으므로 다음 부팅부터 파라미터 기본값이 사용된다.
+    data->param_signature = 0;
+    for (int i = 0; i < PARAM_COUNT_MAX; i++) {
+        data->param_value[i] = 0.0f;
     }
 
     return fs_flush_data();
@@ -53,8 +66,8 @@ int fs_flush_data(void) {
     uint status = save_and_disable_interrupts();
     int ret = 0;
 
-    // flash 메모리에 쓰기 앞서 그 공간을 지운다.
-    flash_range_erase(FLASH_DATA_OFFSET, FLASH_SECTOR_SIZE);
+    // flash 메모리에 쓰기 앞서 그 공간을 지운다. (FLASH_DATA_SIZE에 해당하는 모든 sector)
+    flash_range_erase(FLASH_DATA_OFFSET, FLASH_DATA_SIZE);
 
     // flash 메모리에 내용을 쓴다.
     flash_range_program(FLASH_DATA_OFFSET, (uint8_t *)&buffer, FLASH_DATA_SIZE);
@@ -3,6 +3,9 @@
 
 #include "config.h"
 #include "mark.h"
+#include "segment.h"
+#include "map.h"
+#include "escalate.h"
 
 struct fs_data_t {
     int sensing_ir_bias[SENSING_IR_COUNT];
@@ -10,7 +13,16 @@ struct fs_data_t {
     float sensing_ir_threshold;
     enum mark_t detected_mark[DRIVE_MARK_COUNT_MAX];
     uint detected_mark_count;
-    int32_t detected_tick[DRIVE_MARK_COUNT_MAX];
+    int32_t detected_tick[DRIVE_MARK_COUNT_MAX]; // 마크를 처음 본 위치 (struct mark_event_t의 entry)
+    uint32_t param_signature; // 파라미터 레지스트리 서명 (param.c 참고)
+    float param_value[PARAM_COUNT_MAX];
+    int32_t detected_exit_tick[DRIVE_MARK_COUNT_MAX]; // 마크를 마지막으로 본 위치 (struct mark_event_t의 exit)
+    struct segment_list_t segment_list; // 1차 주행에서 분류한 직선, 곡선 구간
+    uint map_run_count; // 맵에 합친 1차 주행 수 (map_merge)
+    struct map_stat_t detected_stat[DRIVE_MARK_COUNT_MAX]; // 마크 위치의 통계
+    struct escalate_table_t escalate; // 구간별 최고 속도 (n차 주행 반복 모드)
+    uint map_candidate_count;
+    struct map_candidate_t map_candidate[MAP_CANDIDATE_MAX]; // 맵에 없는 마크 후보 (map_merge)
 };
 
 /**
@@ -0,0 +1,243 @@
+/**
+ * @file hal.h
+ * @brief 센싱, 마크, 모터 제어, 주행 로직이 사용하는 하드웨어 접근 함수들 (Hardware Abstraction Layer)
+ *
+ * 로직 모듈(sensing.c, mark.c, motor.c, drive.c 등)은 Pico SDK를 직접 호출하지 않고 이 함수들을 사용한다.
+ * - 펌웨어 빌드: 대부분 Pico SDK를 그대로 호출하는 static inline 함수이므로 추가 비용이 없다.
+ *   초기화처럼 길거나 상태가 필요한 함수는 hal_pico.c에 있다.
+ * - 호스트 빌드(HAL_HOST): host/hal_host.c의 구현이 연결된다. 가상의 시각, GPIO, ADC, PWM, 엔코더를 두어
+ *   시뮬레이터나 벤치마크가 하드웨어를 흉내낼 수 있다. (host/hal_host.h 참고)
+ *   사이클 카운터(hal_cycle_count)는 호스트에서 실제 시간(ns)을 센다.
+ */
+
+#ifndef _HAL_H_
+#define _HAL_H_
+
+#include "pico/types.h"
+#include "config.h"
+
+#if HAL_HOST
+
+int hal_clock_init(void);
+uint32_t hal_clock_sys_hz(void);
+
+uint32_t hal_time_us_32(void);
+void hal_busy_wait_us(uint32_t us);
+void hal_busy_wait_ms(uint32_t ms);
+void hal_tight_loop(void);
+void hal_memory_barrier(void);
+uint32_t hal_irq_save(void);
+void hal_irq_restore(uint32_t status);
+
+void hal_adc_init(void);
+void hal_adc_gpio_init(uint gpio);
+uint hal_adc_read(uint channel);
+
+void hal_gpio_init_output(uint gpio);
+void hal_gpio_put(uint gpio, bool value);
+void hal_gpio_set_mask(uint32_t mask);
+void hal_gpio_clr_mask(uint32_t mask);
+
+void hal_pwm_init(uint slice, uint32_t freq_hz, uint gpio_a, uint gpio_b);
+uint16_t hal_pwm_get_top(uint slice);
+void hal_pwm_set_level(uint slice, uint channel, uint16_t level);
+void hal_pwm_set_enabled(uint slice, bool enabled);
+
+#define HAL_CYCLE_MASK (0xFFFFFFFFu)
+#define HAL_CYCLE_UNIT "ns"
+
+void hal_cycle_counter_init(void);
+uint32_t hal_cycle_count(void);
+
+#define HAL_ISR_FUNC(name) name
+#define HAL_ISR_DATA
+
+#else
+
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+#include "hardware/adc.h"
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+#include "hardware/pwm.h"
+#include "hardware/clocks.h"
+#include "hardware/structs/systick.h"
+#include "hardware/regs/m0plus.h"
+
+/**
+ * @brief CLOCK_SYS_MHZ에 맞게 코어 전압과 시스템 클럭을 설정한다. (hal_pico.c)
+ *
+ * @return 0: 성공, 1: 클럭을 설정하지 못해 기본 클럭(125MHz)으로 동작 중
+ */
+int hal_clock_init(void);
+
+/**
+ * @brief 실제 시스템 클럭(Hz). 사이클 수를 시간으로 바꿀 때 사용한다.
+ */
+static inline uint32_t hal_clock_sys_hz(void) {
+    return clock_get_hz(clk_sys);
+}
+
+static inline uint32_t hal_time_us_32(void) {
+    return time_us_32();
+}
+
+static inline void hal_busy_wait_us(uint32_t us) {
+    busy_wait_us_32(us);
+}
+
+static inline void hal_busy_wait_ms(uint32_t ms) {
+    busy_wait_ms(ms);
+}
+
+static inline void hal_tight_loop(void) {
+    tight_loop_contents();
+}
+
+static inline void hal_memory_barrier(void) {
+    __dmb();
+}
+
+static inline uint32_t hal_irq_save(void) {
+    return save_and_disable_interrupts();
+}
+
+static inline void hal_irq_restore(uint32_t status) {
+    restore_interrupts(status);
+}
+
+static inline void hal_adc_init(void) {
+    adc_init();
+}
+
+static inline void hal_adc_gpio_init(uint gpio) {
+    adc_gpio_init(gpio);
+}
+
+/**
+ * @brief ADC 채널을 선택하고 한 번 변환한 값을 반환한다. (12비트)
+ */
+static inline uint hal_adc_read(uint channel) {
+    adc_select_input(channel);
+    return adc_read();
+}
+
+static inline void hal_gpio_init_output(uint gpio) {
+    gpio_init(gpio);
+    gpio_set_dir(gpio, GPIO_OUT);
+}
+
+static inline void hal_gpio_put(uint gpio, bool value) {
+    gpio_put(gpio, value);
+}
+
+static inline void hal_gpio_set_mask(uint32_t mask) {
+    gpio_set_mask(mask);
+}
+
+static inline void hal_gpio_clr_mask(uint32_t mask) {
+    gpio_clr_mask(mask);
+}
+
+/**
+ * @brief PWM slice를 freq_hz 주파수로 초기화하고 두 GPIO를 PWM 출력으로 설정한다. 초기화 후 PWM은 꺼져 있다.
+ */
+void hal_pwm_init(uint slice, uint32_t freq_hz, uint gpio_a, uint gpio_b);
+
+static inline uint16_t hal_pwm_get_top(uint slice) {
+    return pwm_hw->slice[slice].top;
+}
+
+static inline void hal_pwm_set_level(uint slice, uint channel, uint16_t level) {
+    pwm_set_chan_level(slice, channel, level);
+}
+
+static inline void hal_pwm_set_enabled(uint slice, bool enabled) {
+    pwm_set_enabled(slice, enabled);
+}
+
+/*
+ * 사이클 카운터: Cortex-M0+에는 DWT가 없으므로 SysTick(24비트, 시스템 클럭으로 감소)을 사용한다.
+ * 두 값의 차이를 HAL_CYCLE_MASK로 자르면 2^24 사이클(125MHz에서 약 134ms, 250MHz에서 약 67ms)까지의 경과 사이클을 구할 수 있다.
+ */
+#define HAL_CYCLE_MASK (0x00FFFFFFu)
+#define HAL_CYCLE_UNIT "cycles"
+
+/**
+ * @brief SysTick을 인터럽트 없이 최대 주기로 돌린다. pico-sdk는 SysTick을 사용하지 않는다.
+ */
+static inline void hal_cycle_counter_init(void) {
+    systick_hw->csr = 0;
+    systick_hw->rvr = HAL_CYCLE_MASK;
+    systick_hw->cvr = 0;
+    systick_hw->csr = M0PLUS_SYST_CSR_CLKSOURCE_BITS | M0PLUS_SYST_CSR_ENABLE_BITS;
+}
+
+/**
+ * @brief 증가하는 방향의 사이클 카운터 값. 두 값의 차이는 HAL_CYCLE_MASK로 잘라 사용한다.
+ */
+static inline uint32_t hal_cycle_count(void) {
+    return HAL_CYCLE_MASK - systick_hw->cvr;
+}
+
+/**
+ * @brief 인터럽트에서 실행되는 함수를 정의할 때 이름을 감싼다. 예) static void HAL_ISR_FUNC(sensing_handler)(void)
+ * HAL_ISR_IN_RAM 빌드(CMake 옵션 LINETRACER_ISR_IN_RAM)에서는 함수가 SRAM에 놓여 XIP 캐시 miss 없이 실행된다.
+ * 그렇지 않으면 일반 함수와 같이 flash에 놓인다.
+ */
+#ifndef HAL_ISR_IN_RAM
+#define HAL_ISR_IN_RAM 0
+#endif
+
+#if HAL_ISR_IN_RAM
+#define HAL_ISR_FUNC(name) __not_in_flash_func(name)
+#else
+#define HAL_ISR_FUNC(name) name
+#endif
+
+/**
+ * @brief 인터럽트에서 읽는 const 표(table)에 붙인다. HAL_ISR_IN_RAM 빌드에서는 flash 대신 SRAM에 놓인다.
+ */
+#if HAL_ISR_IN_RAM
+#define HAL_ISR_DATA __not_in_flash("isr")
+#else
+#define HAL_ISR_DATA
+#endif
+
+#endif
+
+/**
+ * @brief 엔코더 state machine을 초기화한다. 엔코더의 B상은 항상 A상 GPIO(base_gpio)의 바로 다음 번호이다.
+ */
+void hal_encoder_init(uint sm, uint base_gpio);
+
+/**
+ * @brief 엔코더의 현재 누적 값을 반환한다.
+ */
+int32_t hal_encoder_get_count(uint sm);
+
+/*
+ * USB CDC: telemetry(telemetry.h)와 명령(command.h)이 사용한다. 메인 루프에서만 호출한다.
+ */
+
+/**
+ * @brief USB가 연결되어 있는지 반환한다.
+ */
+bool hal_usb_connected(void);
+
+/**
+ * @brief 기다리지 않고 바로 보낼 수 있는 바이트 수를 반환한다.
+ */
+uint hal_usb_write_available(void);
+
+/**
+ * @brief length 바이트를 보낸다. hal_usb_write_available보다 길면 자리가 날 때까지 기다릴 수 있다.
+ */
+void hal_usb_write(const void *data, uint length);
+
+/**
+ * @brief 받은 문자 하나를 반환한다. 받은 문자가 없으면 기다리지 않고 음수를 반환한다.
+ */
+int hal_usb_read_char(void);
+
+#endif
@@ -0,0 +1,154 @@
+/**
+ * @file hal_pico.c
+ * @brief hal.h의 Raspberry Pi Pico 구현 중 static inline으로 두기 어려운 함수들
+ */
+
+#include "pico/stdio_usb.h"
+#include "pico/stdio/driver.h"
+#include "hardware/pio.h"
+#include "hardware/clocks.h"
+#include "hardware/vreg.h"
+#include "tusb.h"
+
+#include "hal.h"
+
+#if CLOCK_SYS_MHZ != 125 && CLOCK_SYS_MHZ != 200 && CLOCK_SYS_MHZ != 250
+#error "CLOCK_SYS_MHZ must be 125, 200 or 250"
+#endif
+
+/**
+ * @brief 시스템 클럭과 그 클럭에서 안정적으로 동작하는 코어 전압.
+ * 125MHz는 pico-sdk의 기본 설정과 같다. 200, 250MHz는 RP2040 사용자들이 흔히 쓰는 오버클럭 설정이다.
+ */
+static const struct hal_clock_profile_t {
+    uint32_t sys_mhz;
+    enum vreg_voltage vreg;
+} clock_profiles[] = {
+    { 125, VREG_VOLTAGE_1_10 },
+    { 200, VREG_VOLTAGE_1_15 },
+    { 250, VREG_VOLTAGE_1_20 },
+};
+
+int hal_clock_init(void) {
+    const struct hal_clock_profile_t *profile = NULL;
+
+    for (uint i = 0; i < sizeof(clock_profiles) / sizeof(clock_profiles[0]); i++) {
+        if (clock_profiles[i].sys_mhz == CLOCK_SYS_MHZ) {
+            profile = &clock_profiles[i];
+        }
+    }
+
+    // 클럭을 올리기 전에 코어 전압을 먼저 올리고, 전압이 안정될 때까지 기다린다.
+    vreg_set_voltage(profile->vreg);
+    busy_wait_us(CLOCK_VREG_SETTLE_US);
+
+    if (!set_sys_clock_khz(profile->sys_mhz * 1000, false)) {
+        return 1;
+    }
+
+    /*
+     * set_sys_clock_khz는 clk_peri를 clk_sys에 연결한다. clk_peri가 최대 클럭을 넘으면 USB용 PLL(48MHz)로 옮긴다.
+     * clk_adc(PLL_USB 48MHz)와 1us 타이머(clk_ref 12MHz)는 시스템 클럭과 무관하므로,
+     * ADC 변환 시간과 hal_busy_wait_us, timer_periodic_start의 주기는 어느 클럭에서나 그대로이다.
+     */
+    if (profile->sys_mhz > CLOCK_PERI_MAX_MHZ) {
+        clock_configure(clk_peri, 0, CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB, 48 * MHZ, 48 * MHZ);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 2개의 PIO(Programmable Input Ouput) 장치가 있다.
+ * 이 장치를 이용하면 PIO 전용 명령어들을 이용하여 GPIO에 대해 간단한 연산들을 수행할 수 있는데,
+ * 이는 CPU 자원을 이용하지 않고 PIO 장치에서 독립적으로 작동하기에 빠르고 효율적이다.
+ * 우리는 하나의 PIO에 quadrature encoder 프로그램을 올리고 이를 이용하고자 한다.
+ */
+static const PIO encoder_pio = MOTOR_ENCODER_PIO;
+
+#include "quadrature_encoder.pio.h"
+
+void hal_encoder_init(uint sm, uint base_gpio) {
+    static int instruction_offset = -1;
+
+    // 모든 state machine이 같은 프로그램을 사용하므로, 프로그램은 한 번만 올린다.
+    if (instruction_offset < 0) {
+        instruction_offset = pio_add_program(encoder_pio, &quadrature_encoder_program);
+    }
+
+    /*
+     * state machine 한 바퀴는 최대 14 사이클이므로, clk_sys(hal_clock_sys_hz)를 14 * MOTOR_ENCODER_MAX_STEP_RATE로 나누어
+     * 클럭 프로파일과 관계없이 같은 주기로 엔코더를 샘플링한다. (125MHz에서 분주비 약 4.5, 250MHz에서 약 8.9)
+     */
+    _Static_assert(CLOCK_SYS_MHZ * 1000000ull >= 14ull * MOTOR_ENCODER_MAX_STEP_RATE, "encoder clock divider below 1");
+    quadrature_encoder_program_init(encoder_pio, sm, instruction_offset, base_gpio, MOTOR_ENCODER_MAX_STEP_RATE);
+}
+
+int32_t HAL_ISR_FUNC(hal_encoder_get_count)(uint sm) {
+    /*
+     * 엔코더 값은 state machine에 요청을 보내고 응답을 RX FIFO에서 꺼내는 방식으로 읽는다.
+     * 메인 루프가 요청과 응답 사이에 IRQ(센싱의 마크 판단, 모터 제어)에 끼어들기를 당하면
+     * IRQ가 메인 루프의 응답을 가져가고, 메인 루프는 아직 도착하지 않은 응답(빈 FIFO)을 읽을 수 있다.
+     * 요청부터 응답까지 약 11 사이클이므로 그동안만 인터럽트를 막는다.
+     */
+    const uint32_t status = hal_irq_save();
+    const int32_t count = quadrature_encoder_get_count(encoder_pio, sm);
+    hal_irq_restore(status);
+
+    return count;
+}
+
+void hal_pwm_init(uint slice, uint32_t freq_hz, uint gpio_a, uint gpio_b) {
+    const uint32_t freq_sys = clock_get_hz(clk_sys);
+
+    /**
+     * @brief PWM 주파수를 결정하기 위한 변수.
+     * PWM의 카운터 레지스터가 계속 증가하면서 TOP에 도달하면 다시 초기화되는 형태로 동작한다.
+     *
+     * RP2040 datasheet 4.5.2.6절에 따르면 PWM 주파수는 다음과 같이 구한다.
+     * freq_pwm = freq_sys / ( (TOP + 1) * (CSR_PH_CORRECT + 1) * ( DIV_INT + (DIV_FRAC / 16) ) )
+     *
+     * 1. CSR_PH_CORRECT는 카운터 레지스터가 TOP에 도달했을 때 0으로 떨어지는 것이 아니라 그대로 감소하는 설정을 말하며,
+     *    우리는 이 기능을 사용하지 않기 때문에 0으로 둔다.
+     * 2. TOP 레지스터 크기는 16비트로 기본적으로 65535 값을 가진다.
+     * 3. DIV_INT 및 DIV_FRAC는 클럭을 나눌 때 사용하며, 보통은 1과 0으로 두어 사용하지 않는다.
+     *
+     * 위의 조건에 따라 TOP 레지스터를 좌항으로 두어 식을 정리하면,
+     * TOP = freq_sys / freq_pwm - 1
+     *
+     * 예를 들어, freq_sys가 125,000,000Hz이고 freq_pwm이 20,000Hz이면 TOP은 6,250이 될 것이다.
+     *
+     * 시스템 클럭이 높아 TOP이 16비트를 넘으면 DIV_INT를 올려 TOP이 65535 이하가 되도록 한다.
+     * 이 경우 TOP = freq_sys / (freq_pwm * DIV_INT) - 1 이다.
+     */
+    const uint32_t div = (freq_sys / freq_hz + 0xFFFF) / 0x10000;
+    const uint16_t top = freq_sys / (freq_hz * div) - 1;
+
+    // PWM 장치 기본 설정을 가져오고, PWM 주파수 설정
+    pwm_config pwm_conf = pwm_get_default_config();
+    pwm_config_set_clkdiv_int(&pwm_conf, div);
+    pwm_config_set_wrap(&pwm_conf, top);
+
+    // PWM 초기화
+    pwm_init(slice, &pwm_conf, false);
+
+    // (참고) RP2040에는 총 8개의 PWM slice가 존재하고, 각 slice마다 2개의 channel(GPIO)을 가지고 있다.
+    gpio_set_function(gpio_a, GPIO_FUNC_PWM);
+    gpio_set_function(gpio_b, GPIO_FUNC_PWM);
+}
+
+bool hal_usb_connected(void) {
+    return stdio_usb_connected();
+}
+
+uint hal_usb_write_available(void) {
+    return tud_cdc_write_available();
+}
+
+void hal_usb_write(const void *data, uint length) {
+    stdio_usb.out_chars((const char *)data, length);
+}
+
+int hal_usb_read_char(void) {
+    return getchar_timeout_us(0); // 받은 문자가 없으면 PICO_ERROR_TIMEOUT(음수)
+}
@@ -1,16 +1,24 @@
 #include <stdio.h>
 #include <string.h>
 #include "pico/stdlib.h"
+#include "hardware/structs/xip_ctrl.h"
 
 #include "drive.h"
 #include "fs.h"
 #include "mark.h"
 #include "motor.h"
 #include "oled.h"
+#include "param.h"
+#include "plot.h"
 #include "sensing.h"
 #include "switch.h"
+#include "telemetry.h"
+#include "command.h"
+#include "blackbox.h"
 #include "timer.h"
 #include "buzzer.h"
+#include "bench.h"
+#include "hal.h"
 
 #define UPDATE_PARAMETER(sw, param, delta) \
     if (sw == SWITCH_EVENT_BOTH)           \
@@ -51,8 +59,16 @@ void test_motor_control(void) {
     _position_right = motor_get_encoder_value(MOTOR_RIGHT);
 
     oled_clear();
+    telemetry_start(TELEMETRY_STREAM_SENSING | TELEMETRY_STREAM_CONTROL);
     sensing_start();
     motor_control_start(_position_commander);
+
+    // 좌우 모터의 위치 오차를 그래프로 표시한다.
+    struct plot_t plot;
+    plot_init(&plot, 0, 18, 96, 46, 0.0f, 0.0f, 0);
+    plot_add_trace(&plot, OLED_COLOR_RED);
+    plot_add_trace(&plot, OLED_COLOR_BLUE);
+
     for (;;) {
         uint sw = switch_read();
 
@@ -64,11 +80,19 @@ void test_motor_control(void) {
             break;
 
         oled_printf("/0Motor Ctrl Test");
-        oled_printf("/1position left /2%10d", _position_left);
-        oled_printf("/3position right/4%10d", _position_right);
+        oled_printf("/1/rL%6d /bR%6d", _position_left, _position_right);
+
+        const float error[] = {
+            motor_get_control_state(MOTOR_LEFT).error,
+            motor_get_control_state(MOTOR_RIGHT).error,
+        };
+        plot_update(&plot, error);
+        telemetry_flush();
+        command_poll();
     }
     motor_control_stop();
     sensing_stop();
+    telemetry_stop();
 }
 
 static void _display_ir(volatile const int *const arr) {
@@ -123,11 +147,40 @@ void test_ir_state(void) {
 }
 
 void test_ir_position(void) {
+    telemetry_start(TELEMETRY_STREAM_SENSING);
     sensing_start();
     oled_clear();
+
+    struct plot_t plot;
+    plot_init(&plot, 0, 18, 96, 46, -30000.0f, 30000.0f, 0);
+    plot_add_trace(&plot, OLED_COLOR_WHITE);
+    plot_add_trace(&plot, OLED_COLOR_RED);
+
     while (!switch_read()) {
         oled_printf("/0position: %6d", sensing_ir_position);
         oled_printf("/1/rlimitpos: %6d", sensing_ir_position_limited);
+
+        const float position[] = { sensing_ir_position, sensing_ir_position_limited };
+        plot_update(&plot, position);
+        telemetry_flush();
+        command_poll();
+    }
+    sensing_stop();
+    telemetry_stop();
+}
+
+void test_voltage(void) {
+    sensing_start();
+    oled_clear();
+
+    struct plot_t plot;
+    plot_init(&plot, 0, 18, 96, 46, 0.0f, 0.0f, 0);
+    plot_add_trace(&plot, OLED_COLOR_YELLOW);
+
+    while (!switch_read()) {
+        const float voltage = sensing_supply_voltage;
+        oled_printf("/0Voltage Test/1/y%2.2f V", voltage);
+        plot_update(&plot, &voltage);
     }
     sensing_stop();
 }
@@ -176,6 +229,12 @@ void print_saved_map(void) {
         }
 
         oled_printf("/2/gposition/3/w%d", fs_data->detected_tick[index]);
+        // 여러 1차 주행을 합친 맵이면 마크 위치의 표준편차와 이 마크를 본 주행 수를 보여준다.
+        if (fs_data->map_run_count > 1 && fs_data->map_run_count <= MAP_MERGE_RUN_MAX) {
+            oled_printf("/4/gstd/5/w%.1f mm %u//%u",
+                        map_stat_std(&fs_data->detected_stat[index]) / MOTOR_TICK_PER_METER * 1000,
+                        fs_data->detected_stat[index].count, fs_data->map_run_count);
+        }
         oled_printf("/6%d//%d", index, fs_data->detected_mark_count - 1);
 
         uint sw = switch_wait_until_input();
@@ -184,6 +243,56 @@ void print_saved_map(void) {
     }
 }
 
+/**
+ * @brief n차 주행 반복 모드(escalate.h)에서 배운 구간별 최고 속도를 보여준다.
+ */
+static void print_escalate_table(void) {
+    static const char *const state_name[] = { "raising", "held", "backed off" };
+    const struct fs_data_t *const fs_data = fs_get_data();
+    const struct escalate_table_t *const table = &fs_data->escalate;
+    int index = 0;
+
+    oled_clear();
+    if (!escalate_is_valid(table, &fs_data->segment_list) || table->count == 0) {
+        oled_printf("/0No table");
+        switch_wait_until_input();
+        return;
+    }
+
+    for (;;) {
+        if (index < 0) {
+            index = table->count - 1;
+        } else if (index >= (int)table->count) {
+            index = 0;
+        }
+
+        const struct escalate_limit_t *const limit = &table->limit[index];
+        oled_printf("/0/gsegment/1/w%s", fs_data->segment_list.segment[index].type == SEGMENT_STRAIGHT ? "straight"
+                                                                                                   : "curve");
+        oled_printf("/2/gvelocity/3/w%.2f m//s", limit->velocity);
+        oled_printf("/4/w%s (%u)", state_name[limit->state], limit->raise_count);
+        oled_printf("/6%d//%d  lap %u", index, table->count - 1, table->run_count);
+
+        uint sw = switch_wait_until_input();
+        UPDATE_PARAMETER(sw, index, 1);
+        oled_clear();
+    }
+}
+
+/**
+ * @brief 구간별 최고 속도 표를 지운다. 다음 반복 모드 주행부터 모든 구간을 기본 속도로 다시 배운다.
+ */
+static void reset_escalate_table(void) {
+    oled_clear();
+
+    oled_printf("/0Do you want/1to /rreset/w speed/2table?/3(YES // NO)");
+    if (switch_wait_until_input() == SWITCH_EVENT_LEFT) {
+        fs_get_data()->escalate.count = 0;
+        oled_printf("/6%s", fs_flush_data() ? "/rFailed." : "/gSuccess!");
+        switch_wait_until_input();
+    }
+}
+
 static void calibration(void) {
     enum switch_event_t sw;
     int temp[SENSING_IR_COUNT] = {
@@ -263,6 +372,122 @@ void do_format_flash(void) {
     }
 }
 
+static uint _bench_row = 0;
+
+static void _bench_report(const struct bench_result_t *result) {
+    char line[96];
+
+    // OLED에는 baseline을 뺀 나머지 함수들의 중앙값만(1 ~ 7번 줄), USB에는 모든 결과를 CSV로 보낸다.
+    const uint row = _bench_row++;
+    if (row > 0 && row < 8) {
+        oled_printf("/%u%-9s/w%6.0f", row, result->label, result->median);
+    }
+    if (telemetry_connected()) {
+        bench_format_csv(result, line, sizeof(line));
+        telemetry_print(line);
+        telemetry_print("\n");
+    }
+}
+
+void test_bench(void) {
+    oled_clear();
+    oled_printf("/0/gBenchmark /w(" HAL_CYCLE_UNIT ")");
+    if (telemetry_connected()) {
+        telemetry_print(BENCH_CSV_HEADER "\n");
+    }
+
+    _bench_row = 0;
+    bench_run(_bench_report);
+    switch_wait_until_input();
+}
+
+/*
+ * ISR Timing: 센싱과 모터 제어 타이머를 돌리면서 main loop의 부하를 바꿔 가며 IRQ 핸들러의 최악 실행 시간을 잰다.
+ * - idle:  main loop는 아무 일도 하지 않는다. 핸들러 코드가 XIP 캐시에 계속 남아 있는 조건
+ * - oled:  main loop가 화면을 계속 다시 그린다. 주행 중 화면 갱신처럼 다른 코드가 캐시 line을 밀어내는 조건
+ * - flush: main loop가 XIP 캐시를 계속 비운다. flash에서 실행되는 핸들러에게 가장 나쁜 조건
+ * LINETRACER_ISR_IN_RAM을 켠 빌드와 끈 빌드에서 각각 실행하여 비교한다.
+ */
+enum _isr_load_t {
+    ISR_LOAD_IDLE = 0,
+    ISR_LOAD_OLED,
+    ISR_LOAD_FLUSH,
+    ISR_LOAD_COUNT,
+};
+
+static const char *const _isr_load_names[ISR_LOAD_COUNT] = { "idle", "oled", "flush" };
+
+static void _isr_timing_commander(int32_t *const left, int32_t *const right) {
+    static int32_t drive_left = 0, drive_right = 0;
+
+    // 주행 중 제어 주기에 실행되는 함수들을 같이 실행하되, 모터는 제자리를 유지한다.
+    drive_bench_velocity_commander(&drive_left, &drive_right);
+    _position_commander(left, right);
+}
+
+void test_isr_timing(void) {
+    static const enum timer_slot_index slots[] = { SENSING_TIMER_SLOT, MOTOR_CONTROL_TIMER_SLOT };
+    struct timer_stats_t stats[ISR_LOAD_COUNT][2];
+    char line[64];
+
+    _position_left = motor_get_encoder_value(MOTOR_LEFT);
+    _position_right = motor_get_encoder_value(MOTOR_RIGHT);
+
+    sensing_start();
+    mark_start(); // 주행과 같이 마크 state machine도 센싱 IRQ에서 수행한다.
+    motor_control_start(_isr_timing_commander);
+
+    for (int load = 0; load < ISR_LOAD_COUNT; load++) {
+        oled_clear();
+        oled_printf("/0/gISR Timing/1/wload: %s", _isr_load_names[load]);
+
+        timer_reset_stats();
+        const uint32_t begin = hal_time_us_32();
+        while (hal_time_us_32() - begin < BENCH_ISR_PHASE_MS * 1000) {
+            if (load == ISR_LOAD_OLED) {
+                oled_printf("/3%8u", hal_time_us_32() - begin);
+            } else if (load == ISR_LOAD_FLUSH) {
+                xip_ctrl_hw->flush = 1;
+                (void)xip_ctrl_hw->flush; // 비우기가 끝날 때까지 기다린다.
+            }
+        }
+
+        for (int i = 0; i < 2; i++) {
+            stats[load][i] = timer_get_stats(slots[i]);
+        }
+    }
+
+    motor_control_stop();
+    mark_stop();
+    sensing_stop();
+
+    // 각 부하 조건에서의 최악 실행 시간 (왼쪽: 센싱, 오른쪽: 모터 제어)
+    oled_clear();
+    oled_printf("/0/gISR max /w%s", HAL_ISR_IN_RAM ? "(RAM)" : "(XIP)");
+    oled_printf("/1%-5s %6s %6s", HAL_CYCLE_UNIT, "sense", "motor");
+    for (int load = 0; load < ISR_LOAD_COUNT; load++) {
+        oled_printf("/%d%-5s /w%6u %6u", load + 2, _isr_load_names[load], stats[load][0].max, stats[load][1].max);
+    }
+    oled_printf("/6clk %u MHz", hal_clock_sys_hz() / 1000000);
+
+    if (telemetry_connected()) {
+        // 클럭 프로파일이 다른 빌드끼리 비교할 수 있도록 최악 실행 시간을 us로도 보낸다.
+        const float us_per_cycle = 1e6f / hal_clock_sys_hz();
+        telemetry_print("load,slot,count,mean,max,unit,max_us\n");
+        for (int load = 0; load < ISR_LOAD_COUNT; load++) {
+            for (int i = 0; i < 2; i++) {
+                const struct timer_stats_t *const stat = &stats[load][i];
+                snprintf(line, sizeof(line), "%s,%d,%u,%.1f,%u,%s,%.2f\n", _isr_load_names[load], slots[i], stat->count,
+                         stat->count ? (float)stat->total / stat->count : 0.0f, stat->max, HAL_CYCLE_UNIT,
+                         stat->max * us_per_cycle);
+                telemetry_print(line);
+            }
+        }
+    }
+
+    switch_wait_until_input();
+}
+
 static const struct menu_t {
     char *name;
     void (*func)(void);
@@ -271,25 +496,44 @@ static const struct menu_t {
     { "IR Sensor Test", test_ir_normalized },
     { "IR State Test", test_ir_state },
     { "IR Position Test", test_ir_position },
+    { "Voltage Test", test_voltage },
     { "Mark Live Test", mark_live_test },
     { "Motor PWM Test", test_motor_pwm },
     { "Motor Pos Test", test_motor_control },
     { "Flash Format", do_format_flash },
     { "Print Saved Map", print_saved_map },
+    { "Speed Table", print_escalate_table },
+    { "Reset Speeds", reset_escalate_table },
+    { "Black Box", blackbox_view },
     { "Buzzer Test", test_buzzer },
+    { "Benchmark", test_bench },
+    { "ISR Timing", test_isr_timing },
+    { "Parameters", param_edit_all },
     { "First Drive", drive_first },
     { "Second Drive", drive_second },
+    { "Quick 1st Drive", drive_first_quick },
+    { "Quick 2nd Drive", drive_second_quick },
 };
 
 int main(void) {
+    // 클럭을 바꾸면 주변 장치 설정이 달라지므로 가장 먼저 설정한다.
+    const int clock_failed = hal_clock_init();
     stdio_init_all();
+    hal_cycle_counter_init(); // IRQ 핸들러 실행 시간 통계(timer_get_stats)에 사용한다.
     fs_init();
+    param_init();
 
     switch_init();
     oled_init();
     sensing_init();
     motor_init();
 
+    if (clock_failed) {
+        oled_clear();
+        oled_printf("/0/rClock %d MHz/1/wfailed. Running/2at default clock.", CLOCK_SYS_MHZ);
+        switch_wait_until_input();
+    }
+
     const uint menu_index_max = sizeof(menu) / sizeof(struct menu_t) - 1;
     int menu_index = 0;
 
@@ -0,0 +1,277 @@
+/**
+ * @file map.c
+ * @brief n차 주행의 마크 매칭 구현
+ *
+ * Needleman-Wunsch 정렬을 마크가 들어올 때마다 한 열씩만 계산하는 형태로 줄인 것이다.
+ * 맵 마크는 위치 순으로 정렬되어 있으므로, 예측 위치에서 허용 범위를 넘는 마크를 만나면 탐색을 멈춘다.
+ * 마크 하나당 한 번, 메인 루프에서 호출된다. 맞춘 마크는 위치 보정(map_locate)의 새 기준점이 된다.
+ *
+ * 여러 1차 주행을 합칠 때(map_merge)도 같은 정렬을 쓰며, 마크 위치의 평균과 분산은 Welford 방식으로 누적한다.
+ */
+
+#include <stdlib.h>
+
+#include "map.h"
+#include "fs.h"
+
+void map_match_init(struct map_match_t *match, const enum mark_t *marks, const int32_t *ticks, uint count) {
+    match->marks = marks;
+    match->ticks = ticks;
+    match->count = count;
+    match->next = 0;
+    match->map_last = 0;
+    match->run_last = 0;
+    match->scale = 1.0f;
+    match->map_sum = 0.0f;
+    match->run_sum = 0.0f;
+    match->matched = 0;
+    match->skipped = 0;
+    match->inserted = 0;
+}
+
+int map_match(struct map_match_t *match, enum mark_t mark, int32_t distance) {
+    const int32_t travel = distance - match->run_last;
+    const int32_t predicted = map_locate(match, distance); // 맵 좌표에서 예측한 마크 위치
+    // 엔코더 오차는 주행 거리에 비례해 쌓이므로, 마지막 매칭에서 멀어질수록 허용 범위를 넓힌다.
+    const int32_t window = MAP_MATCH_WINDOW_TICK + MAP_MATCH_WINDOW_RATIO * abs(travel);
+
+    int best = MAP_MATCH_NONE;
+    int32_t best_cost = 0;
+
+    for (uint i = match->next; i < match->count; i++) {
+        const int32_t error = match->ticks[i] - predicted;
+
+        if (error > window) {
+            break; // 이후 마크들은 더 멀리 있다.
+        }
+        if (error < -window || match->marks[i] != mark) {
+            continue;
+        }
+
+        const int32_t cost = abs(error) + (int32_t)(MAP_MATCH_SKIP_COST_TICK * (i - match->next));
+        if (best == MAP_MATCH_NONE || cost < best_cost) {
+            best = i;
+            best_cost = cost;
+        }
+    }
+
+    if (best == MAP_MATCH_NONE) {
+        match->inserted++;
+        return MAP_MATCH_NONE;
+    }
+
+    /*
+     * 거리 배율 갱신. 구간 길이로 가중된 비율이므로 짧은 구간의 마크 위치 오차나 갑작스러운 슬립 한 번에
+     * 크게 흔들리지 않는다. 잘못 맞춘 경우를 대비해 범위를 제한한다.
+     */
+    match->map_sum = match->map_sum * MAP_LOCATE_FORGET + (match->ticks[best] - match->map_last);
+    match->run_sum = match->run_sum * MAP_LOCATE_FORGET + travel;
+    match->scale = (match->map_sum + MAP_LOCATE_PRIOR_TICK) / (match->run_sum + MAP_LOCATE_PRIOR_TICK);
+    if (match->scale > 1.0f + MAP_LOCATE_SCALE_MAX) {
+        match->scale = 1.0f + MAP_LOCATE_SCALE_MAX;
+    } else if (match->scale < 1.0f - MAP_LOCATE_SCALE_MAX) {
+        match->scale = 1.0f - MAP_LOCATE_SCALE_MAX;
+    }
+
+    match->skipped += best - match->next;
+    match->matched++;
+    match->next = best + 1;
+    match->map_last = match->ticks[best];
+    match->run_last = distance;
+
+    return best;
+}
+
+void map_stat_reset(struct fs_data_t *data) {
+    data->map_run_count = 1;
+    for (int i = 0; i < DRIVE_MARK_COUNT_MAX; i++) {
+        data->detected_stat[i] = (struct map_stat_t){ .count = 1, .m2 = 0.0f };
+    }
+    data->map_candidate_count = 0;
+}
+
+/**
+ * @brief 마크 위치의 평균과 분산에 새 주행에서 본 위치(맵 좌표)를 더한다.
+ */
+static void map_stat_add(struct map_stat_t *stat, int32_t *tick, int32_t *exit_tick, float new_tick,
+                         float new_exit_tick) {
+    const float delta = new_tick - *tick;
+
+    stat->count++;
+    *tick += (int32_t)(delta / stat->count);
+    *exit_tick += (int32_t)((new_exit_tick - *exit_tick) / stat->count);
+    stat->m2 += delta * (new_tick - *tick);
+}
+
+/**
+ * @brief 맵에 없는 마크를 같은 종류, 가까운 위치의 후보에 더하거나 새 후보로 넣는다.
+ * 후보가 가득 차면 가장 적게 본 후보(같으면 가장 오래 전에 본 후보)를 바꾼다.
+ */
+static void map_candidate_add(struct fs_data_t *data, enum mark_t mark, float tick, float exit_tick) {
+    const uint32_t run = data->map_run_count;
+    struct map_candidate_t *replace = NULL;
+
+    for (uint i = 0; i < data->map_candidate_count; i++) {
+        struct map_candidate_t *const candidate = &data->map_candidate[i];
+
+        if (candidate->mark == mark && candidate->last_run != run &&
+            fabsf(candidate->tick - tick) <= MAP_MATCH_WINDOW_TICK) {
+            map_stat_add(&candidate->stat, &candidate->tick, &candidate->exit_tick, tick, exit_tick);
+            candidate->last_run = run;
+            return;
+        }
+        if (!replace || candidate->stat.count < replace->stat.count ||
+            (candidate->stat.count == replace->stat.count && candidate->last_run < replace->last_run)) {
+            replace = candidate;
+        }
+    }
+
+    if (data->map_candidate_count < MAP_CANDIDATE_MAX) {
+        replace = &data->map_candidate[data->map_candidate_count++];
+    }
+    *replace = (struct map_candidate_t){
+        .mark = mark,
+        .tick = (int32_t)tick,
+        .exit_tick = (int32_t)exit_tick,
+        .stat = { .count = 1, .m2 = 0.0f },
+        .last_run = run,
+    };
+}
+
+/**
+ * @brief 절반 넘는 주행에서 본 후보를 위치 순서에 맞게 맵에 넣고 후보에서 뺀다.
+ */
+static void map_promote(struct fs_data_t *data) {
+    for (uint c = 0; c < data->map_candidate_count;) {
+        const struct map_candidate_t candidate = data->map_candidate[c];
+
+        if (candidate.stat.count * 2 <= data->map_run_count || data->detected_mark_count >= DRIVE_MARK_COUNT_MAX) {
+            c++;
+            continue;
+        }
+
+        uint at = data->detected_mark_count;
+        while (at > 0 && data->detected_tick[at - 1] > candidate.tick) {
+            data->detected_mark[at] = data->detected_mark[at - 1];
+            data->detected_tick[at] = data->detected_tick[at - 1];
+            data->detected_exit_tick[at] = data->detected_exit_tick[at - 1];
+            data->detected_stat[at] = data->detected_stat[at - 1];
+            at--;
+        }
+        data->detected_mark[at] = candidate.mark;
+        data->detected_tick[at] = candidate.tick;
+        data->detected_exit_tick[at] = candidate.exit_tick;
+        data->detected_stat[at] = candidate.stat;
+        data->detected_mark_count++;
+
+        data->map_candidate[c] = data->map_candidate[--data->map_candidate_count];
+    }
+}
+
+/**
+ * @brief 절반 넘는 주행에서 보지 못한 마크를 지우고 나머지를 앞으로 당긴다.
+ */
+static void map_prune(struct fs_data_t *data) {
+    uint kept = 0;
+
+    for (uint i = 0; i < data->detected_mark_count; i++) {
+        if (data->detected_stat[i].count * 2 < data->map_run_count) {
+            continue;
+        }
+        data->detected_mark[kept] = data->detected_mark[i];
+        data->detected_tick[kept] = data->detected_tick[i];
+        data->detected_exit_tick[kept] = data->detected_exit_tick[i];
+        data->detected_stat[kept] = data->detected_stat[i];
+        kept++;
+    }
+    for (uint i = kept; i < data->detected_mark_count; i++) {
+        data->detected_mark[i] = MARK_NONE;
+        data->detected_tick[i] = 0;
+        data->detected_exit_tick[i] = 0;
+    }
+    data->detected_mark_count = kept;
+}
+
+int map_merge(struct fs_data_t *data, const enum mark_t *marks, const int32_t *ticks, const int32_t *exit_ticks,
+              uint count) {
+    struct map_match_t match;
+    int64_t error_sum = 0;
+    double map_run_sum = 0, run_run_sum = 0;
+
+    if (data->map_run_count == 0 || data->map_run_count > MAP_MERGE_RUN_MAX) {
+        map_stat_reset(data); // 통계 없이 저장된 이전 맵
+    }
+    if (data->map_candidate_count > MAP_CANDIDATE_MAX) {
+        data->map_candidate_count = 0; // 후보 없이 저장된 이전 맵
+    }
+
+    // 1. 정렬만 해서 합칠 만한 주행인지 본다.
+    map_match_init(&match, data->detected_mark, data->detected_tick, data->detected_mark_count);
+    for (uint i = 0; i < count; i++) {
+        const int32_t predicted = map_locate(&match, ticks[i]);
+        const int index = map_match(&match, marks[i], ticks[i]);
+        if (index != MAP_MATCH_NONE) {
+            error_sum += abs(predicted - data->detected_tick[index]);
+            map_run_sum += (double)data->detected_tick[index] * ticks[i];
+            run_run_sum += (double)ticks[i] * ticks[i];
+        }
+    }
+    if (match.matched == 0 || match.matched < MAP_MERGE_MATCH_RATIO * data->detected_mark_count ||
+        error_sum / match.matched > MAP_MERGE_ERROR_TICK) {
+        return 1;
+    }
+
+    /*
+     * 주행 전체의 거리 배율 (맞춘 마크 위치의 최소제곱, 원점을 지남).
+     * 바퀴 마모 등으로 주행마다 전체 거리가 조금씩 다르므로, 이것을 맞춘 뒤에 남는 차이만 마크 위치의 분산으로 본다.
+     */
+    const float scale = run_run_sum > 0 ? map_run_sum / run_run_sum : 1.0f;
+    if (fabsf(scale - 1.0f) > MAP_LOCATE_SCALE_MAX) {
+        return 1;
+    }
+
+    /*
+     * 2. 같은 정렬을 다시 하며 맞춘 마크의 위치를 갱신하고, 맞추지 못한 마크는 후보에 더한다.
+     * map_match는 맞춘 마크 이후의 맵 위치만 읽으므로, 맞춘 마크의 위치를 바로 바꿔도 정렬 결과는 1과 같다.
+     */
+    map_match_init(&match, data->detected_mark, data->detected_tick, data->detected_mark_count);
+    for (uint i = 0; i < count; i++) {
+        const int index = map_match(&match, marks[i], ticks[i]);
+        if (index == MAP_MATCH_NONE) {
+            map_candidate_add(data, marks[i], ticks[i] * scale, exit_ticks[i] * scale);
+            continue;
+        }
+
+        map_stat_add(&data->detected_stat[index], &data->detected_tick[index], &data->detected_exit_tick[index],
+                     ticks[i] * scale, exit_ticks[i] * scale);
+    }
+    data->map_run_count++;
+
+    if (data->map_run_count >= MAP_MERGE_MIN_RUNS) {
+        map_prune(data);
+        map_promote(data);
+    }
+
+    return 0;
+}
+
+int32_t map_safe_tick(const struct fs_data_t *data, int32_t position, int32_t fallback) {
+    if (data->map_run_count < MAP_MERGE_MIN_RUNS || data->map_run_count > MAP_MERGE_RUN_MAX) {
+        return fallback;
+    }
+
+    int nearest = -1;
+    int32_t nearest_error = SEGMENT_SNAP_TICK;
+    for (uint i = 0; i < data->detected_mark_count; i++) {
+        const int32_t error = abs(data->detected_tick[i] - position);
+        if (error < nearest_error && data->detected_stat[i].count > 1) {
+            nearest = i;
+            nearest_error = error;
+        }
+    }
+
+    if (nearest < 0) {
+        return fallback;
+    }
+    return MAP_SAFE_MIN_TICK + MAP_SAFE_SIGMA * map_stat_std(&data->detected_stat[nearest]);
+}
@@ -0,0 +1,126 @@
+/**
+ * @file map.h
+ * @brief n차 주행에서 본 마크를 1차 주행의 마크 맵에 맞추는 모듈
+ *
+ * 마크 종류만 순서대로 비교하면 잘못 본 마크나 놓친 마크 하나로 이후의 맵 위치를 모두 잃는다.
+ * 여기서는 마크 종류와 함께 마지막으로 맞춘 마크 이후의 주행 거리를 사용하여, 맵에서 예측한 위치 주변의
+ * 같은 종류 마크를 찾는다. 맵 마크를 건너뛸 때마다 비용을 더해(서열 정렬의 gap 비용) 가장 비용이 낮은 마크를 고른다.
+ * - 맵에 없는 마크(삽입): 허용 범위 안에 같은 종류의 맵 마크가 없으면 무시하고, 맵 위치는 그대로 둔다.
+ * - 놓친 마크(삭제): 건너뛴 맵 마크 다음의 마크에 맞추고, 건너뛴 수를 skipped에 더한다.
+ *
+ *   struct map_match_t match;
+ *   map_match_init(&match, detected_mark, detected_tick, detected_mark_count);
+ *   const int index = map_match(&match, mark, distance); // 맞춘 맵 인덱스 또는 MAP_MATCH_NONE
+ *   const int32_t position = map_locate(&match, distance); // 현재 위치를 맵 좌표로
+ *
+ * 현재 주행 거리는 바퀴 마모, 슬립, 라인 위 주행 위치 차이로 맵과 조금씩 어긋난다.
+ * 마지막으로 맞춘 마크를 기준점(offset)으로, 그 뒤의 주행 거리에 거리 배율(scale)을 곱해 맵 좌표를 구하고,
+ * 배율은 마크를 맞출 때마다 맞춘 마크 사이의 맵 거리와 주행 거리를 누적한 비율로 갱신한다.
+ */
+
+#ifndef _MAP_H_
+#define _MAP_H_
+
+#include <math.h>
+
+#include "pico/types.h"
+#include "config.h"
+#include "mark.h"
+
+#define MAP_MATCH_NONE (-1)
+
+struct fs_data_t;
+
+/**
+ * @brief 맵 마크 하나의 위치 통계 (여러 1차 주행을 합친 맵, map_merge)
+ */
+struct map_stat_t {
+    uint32_t count; // 이 마크를 본 주행 수
+    float m2; // 평균과의 차이 제곱의 합 (tick², Welford 방식으로 누적)
+};
+
+/**
+ * @brief 맵에 없지만 합친 주행에서 본 마크 (map_merge). 절반 넘는 주행에서 보면 맵에 넣는다.
+ * 첫 주행(맵을 만든 주행)이 놓친 마크를 나중에라도 맵에 넣기 위해 쓴다.
+ */
+struct map_candidate_t {
+    enum mark_t mark;
+    int32_t tick, exit_tick; // 위치의 평균 (맵 좌표)
+    struct map_stat_t stat;
+    uint32_t last_run; // 마지막으로 본 주행의 번호 (그때의 map_run_count). 한 주행에서 두 번 세지 않는다.
+};
+
+struct map_match_t {
+    const enum mark_t *marks; // 맵의 마크 종류
+    const int32_t *ticks; // 맵의 마크 위치 (tick)
+    uint count;
+
+    uint next; // 다음에 맞출 것으로 예상하는 맵 인덱스
+    int32_t map_last; // 마지막으로 맞춘 맵 마크의 위치 (맵 좌표)
+    int32_t run_last; // 그 마크를 현재 주행에서 본 위치 (현재 주행 좌표)
+    float scale; // 현재 주행 거리 1 tick에 해당하는 맵 거리
+    float map_sum, run_sum; // 배율 계산에 쓰는 맞춘 마크 사이 거리의 누적 (맵, 현재 주행)
+
+    uint matched; // 맞춘 마크 수
+    uint skipped; // 놓친 것으로 보고 건너뛴 맵 마크 수
+    uint inserted; // 맵에 없어 무시한 마크 수
+};
+
+/**
+ * @brief 맵으로 매칭 상태를 초기화한다. 맵의 배열들은 매칭하는 동안 유지되어야 한다.
+ * 출발 위치(0)는 두 좌표가 같은 것으로 본다.
+ */
+void map_match_init(struct map_match_t *match, const enum mark_t *marks, const int32_t *ticks, uint count);
+
+/**
+ * @brief 현재 주행에서 본 마크를 맵에 맞춘다.
+ *
+ * @param mark 본 마크
+ * @param distance 마크의 위치 (현재 주행 좌표, tick)
+ * @return 맞춘 맵 인덱스, 맵에 없는 마크로 판단하면 MAP_MATCH_NONE
+ */
+int map_match(struct map_match_t *match, enum mark_t mark, int32_t distance);
+
+/**
+ * @brief 현재 주행 좌표의 위치를 맵 좌표로 바꾼다. 직선 가속, 감속 위치는 이 좌표로 비교한다.
+ */
+static inline int32_t map_locate(const struct map_match_t *match, int32_t distance) {
+    return match->map_last + (int32_t)(match->scale * (distance - match->run_last));
+}
+
+/**
+ * @brief 마크 위치의 표본 표준편차 (tick). 두 번 이상 본 마크만 값이 있다.
+ */
+static inline float map_stat_std(const struct map_stat_t *stat) {
+    return stat->count > 1 ? sqrtf(stat->m2 / (stat->count - 1)) : 0.0f;
+}
+
+/**
+ * @brief 맵을 새로 저장할 때 통계와 후보를 초기화한다. 맵은 주행 하나로 만든 것이 된다.
+ */
+void map_stat_reset(struct fs_data_t *data);
+
+/**
+ * @brief 새 1차 주행의 마크를 data의 맵에 합친다.
+ * 맵과 정렬하여(map_match) 맞춘 마크마다 위치(entry, exit)의 평균과 분산을 갱신하고, 맵에 없는 마크는 버린다.
+ * 새 주행의 위치는 맞춘 마크들로 구한 전체 거리 배율을 곱해 맵 좌표로 바꾼 뒤 합친다.
+ * 맵 마크를 MAP_MERGE_MATCH_RATIO 미만으로 맞췄거나 예측 위치와의 평균 차이가 MAP_MERGE_ERROR_TICK보다 크면,
+ * 다른 트랙이거나 크게 어긋난 주행으로 보고 합치지 않는다. 전체 거리 배율이 MAP_LOCATE_SCALE_MAX보다 벗어나도 합치지 않는다.
+ * 맵에 없는 마크는 종류와 위치(MAP_MATCH_WINDOW_TICK 안)로 후보(map_candidate_t)에 모아 두고 본 주행 수를 센다.
+ * 합친 주행이 MAP_MERGE_MIN_RUNS 이상이면, 절반 넘는 주행에서 보지 못한 마크는 잘못 본 마크로 보고 맵에서 지우고,
+ * 반대로 절반 넘는 주행에서 본 후보는 첫 주행이 놓친 마크로 보고 위치 순서에 맞게 맵에 넣는다.
+ *
+ * @param marks, ticks, exit_ticks, count 새 주행의 마크와 위치
+ * @return 0: 합침, 1: 합치지 않음
+ */
+int map_merge(struct fs_data_t *data, const enum mark_t *marks, const int32_t *ticks, const int32_t *exit_ticks,
+              uint count);
+
+/**
+ * @brief 맵 위치 position에서의 안전 거리 (tick)
+ * MAP_MERGE_MIN_RUNS 이상 합친 맵에서 SEGMENT_SNAP_TICK 안에 마크가 있으면 그 마크 위치의 표준편차로 정하고
+ * (MAP_SAFE_MIN_TICK + MAP_SAFE_SIGMA * 표준편차), 아니면 fallback을 반환한다.
+ */
+int32_t map_safe_tick(const struct fs_data_t *data, int32_t position, int32_t fallback);
+
+#endif
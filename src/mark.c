@@ -1,22 +1,24 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "hal.h"
 #include "mark.h"
 #include "switch.h"
 #include "oled.h"
 #include "sensing.h"
 #include "motor.h"
+#include "queue.h"
 
 #define MARK_STATE_READY        0x01
 #define MARK_STATE_ACCUMULATION 0x02
 #define MARK_STATE_DECISION     0x04
 
-static const sensing_ir_state_t MARK_STATE_LEFT[SENSING_IR_COUNT] = {
+static const sensing_ir_state_t HAL_ISR_DATA MARK_STATE_LEFT[SENSING_IR_COUNT] = {
     0x0000, 0x0000, 0x0000, 0x0000, 0x8000, 0xC000, 0xE000, 0xF000, //
     0x7800, 0x3C00, 0x1E00, 0x0F00, 0x0780, 0x03C0, 0x01E0, 0x00F0, //
 };
 
-static const sensing_ir_state_t MARK_STATE_RIGHT[SENSING_IR_COUNT] = {
+static const sensing_ir_state_t HAL_ISR_DATA MARK_STATE_RIGHT[SENSING_IR_COUNT] = {
     0x0780, 0x03C0, 0x01E0, 0x00F0, 0x0078, 0x003C, 0x001E, 0x000F, //
     0x0007, 0x0003, 0x0001, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, //
 };
@@ -26,15 +28,24 @@ static const sensing_ir_state_t MARK_STATE_RIGHT[SENSING_IR_COUNT] = {
 //     0x0210, 0x0108, 0x0084, 0x0042, 0x0021, 0x0010, 0x0008, 0x0004, //
 // };
 
-static const sensing_ir_state_t MARK_STATE_CENTER[SENSING_IR_COUNT] = {
+static const sensing_ir_state_t HAL_ISR_DATA MARK_STATE_CENTER[SENSING_IR_COUNT] = {
     0xF800, 0xFC00, 0xFE00, 0xFF00, 0x7F80, 0x3FC0, 0x1FE0, 0x0FF0, //
     0x07F8, 0x03FC, 0x01FE, 0x00FF, 0x007F, 0x003F, 0x001F, 0x000F, //
 };
 
+/**
+ * @brief 현재 주행 거리 (좌우 엔코더 절댓값의 평균, tick)
+ */
+static inline int32_t mark_distance(void) {
+    return (abs(motor_get_encoder_value(MOTOR_LEFT)) + abs(motor_get_encoder_value(MOTOR_RIGHT))) / 2;
+}
+
 struct mark_state_t mark_init_state(void) {
     struct mark_state_t ret;
 
     ret.state = MARK_STATE_READY;
+    ret.entry = ret.exit = 0;
+    ret.is_left = ret.is_right = false;
     ret.left = MARK_STATE_LEFT[7];
     ret.right = MARK_STATE_RIGHT[7];
     ret.both = ret.left | ret.right;
@@ -43,7 +54,7 @@ struct mark_state_t mark_init_state(void) {
     return ret;
 }
 
-void mark_update_window(struct mark_state_t *const state, const float position) {
+void HAL_ISR_FUNC(mark_update_window)(struct mark_state_t *const state, const float position) {
     // 현재 position을 통해 16조 어느 IR 센서 위에 트레이서가 위치하는지 구한다. (0: 가장 왼쪽, 15: 가장 오른쪽)
     int where = (position + 30000) / 4000;
     state->left = MARK_STATE_LEFT[where];
@@ -52,7 +63,7 @@ void mark_update_window(struct mark_state_t *const state, const float position)
     state->center = MARK_STATE_CENTER[where];
 }
 
-enum mark_t mark_update_state(struct mark_state_t *state) {
+enum mark_t HAL_ISR_FUNC(mark_update_state)(struct mark_state_t *state) {
     const sensing_ir_state_t ir_state = sensing_ir_state;
     bool is_any = ir_state & state->both;
     bool is_line_6 = __builtin_popcount(ir_state & state->center) >= 6;
@@ -67,14 +78,22 @@ enum mark_t mark_update_state(struct mark_state_t *state) {
         if (is_any || is_line_6) {
             state->state = MARK_STATE_ACCUMULATION;
             state->accumulate = ir_state;
+            state->is_left = ir_state & state->left;
+            state->is_right = ir_state & state->right;
             state->motor = ir_state & state->left ? MOTOR_LEFT : MOTOR_RIGHT;
             state->encoder = abs(motor_get_encoder_value(state->motor)) + MARK_LENGTH_TICK;
+            state->entry = state->exit = mark_distance();
         }
         break;
 
     case MARK_STATE_ACCUMULATION:
 
         state->accumulate |= ir_state; // 마크 판단을 위해 센서 상태를 누적한다.
+        state->is_left |= (ir_state & state->left) != 0;
+        state->is_right |= (ir_state & state->right) != 0;
+        if (is_any || is_line_6) {
+            state->exit = mark_distance();
+        }
 
         /*
          * 트레이서가 마크의 길이(약 2cm)를 지난 후에 상태 전이를 결정한다.
@@ -106,15 +125,13 @@ enum mark_t mark_update_state(struct mark_state_t *state) {
         if (state->accumulate == 0xFFFF) {
             return MARK_CROSS;
         }
-        bool is_left = state->accumulate & state->left;
-        bool is_right = state->accumulate & state->right;
-        if (is_left && is_right) {
+        if (state->is_left && state->is_right) {
             return MARK_BOTH;
         }
-        if (is_left) {
+        if (state->is_left) {
             return MARK_LEFT;
         }
-        if (is_right) {
+        if (state->is_right) {
             return MARK_RIGHT;
         }
         break;
@@ -123,16 +140,67 @@ enum mark_t mark_update_state(struct mark_state_t *state) {
     return MARK_NONE;
 }
 
+/*
+ * 센싱 IRQ에서 수행되는 state machine과, 결정된 마크를 메인 루프로 넘기는 큐 (queue.h)
+ */
+static struct mark_state_t isr_state;
+QUEUE_DEFINE(events, struct mark_event_t, MARK_EVENT_QUEUE_SIZE);
+
+static void HAL_ISR_FUNC(mark_frame_handler)(void) {
+    mark_update_window(&isr_state, sensing_ir_position);
+    const enum mark_t mark = mark_update_state(&isr_state);
+    if (!mark) {
+        return;
+    }
+
+    const struct mark_event_t event = {
+        .mark = mark,
+        .entry = isr_state.entry,
+        .exit = isr_state.exit,
+        .distance = mark_distance(),
+        .time_us = hal_time_us_32(),
+    };
+    queue_push(&events, &event);
+}
+
+void mark_start(void) {
+    sensing_set_frame_handler(NULL);
+    isr_state = mark_init_state();
+    queue_reset(&events);
+    sensing_set_frame_handler(mark_frame_handler);
+}
+
+void mark_stop(void) {
+    sensing_set_frame_handler(NULL);
+}
+
+bool mark_poll(struct mark_event_t *event) {
+    return queue_pop(&events, event);
+}
+
+uint mark_dropped(void) {
+    return events.overflow;
+}
+
+struct mark_state_t HAL_ISR_FUNC(mark_get_state)(void) {
+    const uint32_t status = hal_irq_save();
+    const struct mark_state_t state = isr_state;
+    hal_irq_restore(status);
+
+    return state;
+}
+
 void mark_live_test(void) {
-    sensing_start();
+    struct mark_event_t event;
 
-    struct mark_state_t mark_state = mark_init_state();
+    sensing_start();
+    mark_start();
 
     oled_clear();
     oled_printf("/0Mark Live Test");
     while (!switch_read()) {
-        mark_update_window(&mark_state, sensing_ir_position);
-        enum mark_t mark = mark_update_state(&mark_state);
+        const struct mark_state_t mark_state = mark_get_state();
+        const enum mark_t mark = mark_poll(&event) ? event.mark : MARK_NONE;
 
         switch (mark_state.state) {
         case MARK_STATE_READY:
@@ -162,6 +230,8 @@ void mark_live_test(void) {
         case MARK_CROSS:
             oled_printf("/1MARK: CROSS     ");
             break;
+        default:
+            break;
         }
 
         char output[SENSING_IR_COUNT * 3 + 1];
@@ -169,17 +239,19 @@ void mark_live_test(void) {
             sensing_ir_state_t pop = 1 << (0xf - i);
 
             if (mark_state.left & pop) {
-                strncpy(output + 3 * i, "/r1", 3);
+                memcpy(output + 3 * i, "/r1", 3);
             } else if (mark_state.right & pop) {
-                strncpy(output + 3 * i, "/b1", 3);
+                memcpy(output + 3 * i, "/b1", 3);
             } else if (mark_state.center & pop) {
-                strncpy(output + 3 * i, "/y1", 3);
+                memcpy(output + 3 * i, "/y1", 3);
             } else {
-                strncpy(output + 3 * i, "/w0", 3);
+                memcpy(output + 3 * i, "/w0", 3);
             }
         }
+        output[SENSING_IR_COUNT * 3] = '\0';
         oled_printf("/6%s", output);
     }
 
+    mark_stop();
     sensing_stop();
 }
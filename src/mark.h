@@ -23,9 +23,23 @@ struct mark_state_t {
      */
     sensing_ir_state_t left, right, both, center;
     sensing_ir_state_t accumulate;
+
+    /**
+     * @brief 누적하는 동안 그 순간의 window로 본 왼쪽, 오른쪽 마크 여부
+     * window는 라인을 따라 매 프레임 옮겨가므로, 고정된 센서 좌표로 누적한 accumulate를 마지막 window로 판단하면
+     * 곡선에서 옆으로 움직인 라인이 마크로 보인다. 그래서 좌우 판단은 프레임마다 그때의 window로 한다.
+     */
+    bool is_left, is_right;
     int32_t encoder;
     int motor;
     uint state;
+
+    /**
+     * @brief 마크를 처음 본 위치와 마지막으로 본 위치 (좌우 엔코더 절댓값의 평균, tick)
+     * 마크가 결정되는 시점은 마크를 지나고 MARK_LENGTH_TICK 이상 더 간 뒤이고 재확인할 때마다 늦어지므로,
+     * 마크의 위치로는 결정 시점 대신 이 값들을 사용한다. mark_update_state가 마크를 반환한 직후에 유효하다.
+     */
+    int32_t entry, exit;
 };
 
 /**
@@ -52,6 +66,46 @@ void mark_update_window(struct mark_state_t *const state, const float position);
  */
 enum mark_t mark_update_state(struct mark_state_t *mark_state);
 
+/**
+ * @brief 센싱 IRQ에서 결정된 마크 하나
+ */
+struct mark_event_t {
+    enum mark_t mark;
+    int32_t entry; // 마크를 처음 본 위치 (좌우 엔코더 절댓값의 평균, tick). 맵에는 이 값을 마크의 위치로 저장한다.
+    int32_t exit; // 마크를 마지막으로 본 위치
+    int32_t distance; // 마크가 결정된 순간의 주행 거리
+    uint32_t time_us; // 마크가 결정된 시각
+};
+
+/**
+ * @brief 큐가 가득 차 버려진 마크 이벤트 수 (mark_start에서 0으로 초기화된다)
+ */
+uint mark_dropped(void);
+
+/**
+ * @brief 센싱 주기마다(센싱 IRQ 안에서) 마크 state machine을 수행하기 시작한다.
+ * 결정된 마크는 큐에 쌓이며, 메인 루프는 mark_poll로 꺼내 사용한다. sensing_start 전후 어느 때나 호출할 수 있다.
+ */
+void mark_start(void);
+
+/**
+ * @brief 마크 state machine 수행을 멈추고 큐를 비운다.
+ */
+void mark_stop(void);
+
+/**
+ * @brief 큐에서 결정된 마크를 하나 꺼낸다.
+ *
+ * @param event 꺼낸 마크를 담을 변수
+ * @return 마크를 꺼냈으면 true, 큐가 비어 있으면 false
+ */
+bool mark_poll(struct mark_event_t *event);
+
+/**
+ * @brief mark_start로 수행 중인 state machine의 현재 상태를 반환한다.
+ */
+struct mark_state_t mark_get_state(void);
+
 /**
  * @brief 마크 state machine의 동작을 실시간으로 확인해볼 수 있는 테스트 함수.
  */
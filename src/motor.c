@@ -4,25 +4,16 @@
  */
 
 #include <stdlib.h>
-#include "hardware/gpio.h"
-#include "hardware/pwm.h"
-#include "hardware/pio.h"
-#include "hardware/clocks.h"
-#include "hardware/timer.h"
 
+#include "hal.h"
 #include "motor.h"
+#include "bench.h"
 #include "sensing.h"
+#include "telemetry.h"
+#include "event.h"
 #include "timer.h"
 
-/**
- * @brief 2개의 PIO(Programmable Input Ouput) 장치가 있다.
- * 이 장치를 이용하면 PIO 전용 명령어들을 이용하여 GPIO에 대해 간단한 연산들을 수행할 수 있는데,
- * 이는 CPU 자원을 이용하지 않고 PIO 장치에서 독립적으로 작동하기에 빠르고 효율적이다.
- * 우리는 하나의 PIO에 quadrature encoder 프로그램을 올리고 이를 이용하고자 한다.
- */
-static const PIO encoder_pio = MOTOR_ENCODER_PIO;
-
-static struct encoder_t {
+static const struct encoder_t {
     /**
      * @brief 엔코더의 한 쪽의 GPIO 번호.
      * 엔코더의 A상만 정의하는 이유는 PIO 프로그램에 의해 B상이 항상 A상 GPIO의 바로 다음 번호이기 때문이다.
@@ -45,7 +36,7 @@ static struct encoder_t {
      */
     const int32_t comp;
 
-} encoder[MOTOR_COUNT] = {
+} encoder[MOTOR_COUNT] HAL_ISR_DATA = {
     {
         .base_gpio = MOTOR_ENCODER_GPIO_LEFT_BASE,
         .sm = MOTOR_LEFT,
@@ -58,85 +49,47 @@ static struct encoder_t {
     }
 };
 
-#include "quadrature_encoder.pio.h"
-
 static inline void motor_encoder_init() {
-    const uint instruction_offset = pio_add_program(encoder_pio, &quadrature_encoder_program);
-
     for (int i = 0; i < MOTOR_COUNT; i++) {
-        quadrature_encoder_program_init(
-            encoder_pio, encoder[i].sm, instruction_offset, encoder[i].base_gpio, 0);
+        hal_encoder_init(encoder[i].sm, encoder[i].base_gpio);
     }
 }
 
-int32_t motor_get_encoder_value(enum motor_index index) {
-    int32_t value = quadrature_encoder_get_count(encoder_pio, encoder[index].sm);
+int32_t HAL_ISR_FUNC(motor_get_encoder_value)(enum motor_index index) {
+    int32_t value = hal_encoder_get_count(encoder[index].sm);
 
     return encoder[index].comp * value;
 }
 
 static const uint pwm_slice_num = MOTOR_PWM_SLICE_NUM;
-static const uint dir_gpio[MOTOR_COUNT] = {
+static const uint HAL_ISR_DATA dir_gpio[MOTOR_COUNT] = {
     MOTOR_DIR_GPIO_LEFT, MOTOR_DIR_GPIO_RIGHT
 };
 
 static inline void motor_driver_init() {
-    // PWM 및 시스템 클럭 정의, 이때 가청 주파수보다 높아야 귀에 거슬리는 소리가 나지 않는다.
-    const uint32_t freq_pwm = 20000;
-    const uint32_t freq_sys = clock_get_hz(clk_sys);
-
-    /**
-     * @brief PWM 주파수를 결정하기 위한 변수.
-     * PWM의 카운터 레지스터가 계속 증가하면서 TOP에 도달하면 다시 초기화되는 형태로 동작한다.
-     *
-     * RP2040 datasheet 4.5.2.6절에 따르면 PWM 주파수는 다음과 같이 구한다.
-     * freq_pwm = freq_sys / ( (TOP + 1) * (CSR_PH_CORRECT + 1) * ( DIV_INT + (DIV_FRAC / 16) ) )
-     *
-     * 1. CSR_PH_CORRECT는 카운터 레지스터가 TOP에 도달했을 때 0으로 떨어지는 것이 아니라 그대로 감소하는 설정을 말하며,
-     *    우리는 이 기능을 사용하지 않기 때문에 0으로 둔다.
-     * 2. TOP 레지스터 크기는 16비트로 기본적으로 65535 값을 가진다.
-     * 3. DIV_INT 및 DIV_FRAC는 클럭을 나눌 때 사용하며, 1과 0으로 두어 사용하지 않는다.
-     *
-     * 위의 조건에 따라 TOP 레지스터를 좌항으로 두어 식을 정리하면,
-     * TOP = freq_sys / freq_pwm - 1
-     *
-     * 예를 들어, freq_sys가 125,000,000Hz이고 freq_pwm이 20,000Hz이면 TOP은 6,250이 될 것이다.
-     */
-    const uint16_t top = freq_sys / freq_pwm - 1;
-
-    // PWM 장치 기본 설정을 가져오고, PWM 주파수 설정
-    pwm_config pwm_conf = pwm_get_default_config();
-    pwm_config_set_wrap(&pwm_conf, top);
-
-    // PWM 초기화
-    pwm_init(pwm_slice_num, &pwm_conf, false);
-
-    // (참고) RP2040에는 총 8개의 PWM slice가 존재하고, 각 slice마다 2개의 channel(GPIO)을 가지고 있다.
-    // 양쪽 모터에 대해 PWM GPIO 설정
-    gpio_set_function(MOTOR_PWM_GPIO_LEFT, GPIO_FUNC_PWM);
-    gpio_set_function(MOTOR_PWM_GPIO_RIGHT, GPIO_FUNC_PWM);
+    // PWM 주파수는 가청 주파수보다 높아야 귀에 거슬리는 소리가 나지 않는다.
+    hal_pwm_init(pwm_slice_num, 20000, MOTOR_PWM_GPIO_LEFT, MOTOR_PWM_GPIO_RIGHT);
 
     // DC 모터 드라이버의 direction 핀에 들어가는 GPIO를 초기화한다.
     // 모터 드라이버에 내장돼있는 H-Bridge 회로를 이용해 모터의 회전 방향을 변경하는데 사용된다.
     for (int i = 0; i < MOTOR_COUNT; i++) {
-        gpio_init(dir_gpio[i]);
-        gpio_set_dir(dir_gpio[i], GPIO_OUT);
-        gpio_put(dir_gpio[i], false);
+        hal_gpio_init_output(dir_gpio[i]);
+        hal_gpio_put(dir_gpio[i], false);
     }
 }
 
 void motor_pwm_enabled(const bool enabled) {
-    pwm_set_chan_level(pwm_slice_num, MOTOR_LEFT, 0);
-    pwm_set_chan_level(pwm_slice_num, MOTOR_RIGHT, 0);
+    hal_pwm_set_level(pwm_slice_num, MOTOR_LEFT, 0);
+    hal_pwm_set_level(pwm_slice_num, MOTOR_RIGHT, 0);
 
     // PWM을 비활성화 할 때, counter 레지스터에 따라 해당 핀의 Low/High가 결정된다.
     // level을 0으로 두고, 해당 핀이 Low가 될 때까지 기다려준다. 약 1ms 정도.
-    busy_wait_ms(1);
-    pwm_set_enabled(pwm_slice_num, enabled);
+    hal_busy_wait_ms(1);
+    hal_pwm_set_enabled(pwm_slice_num, enabled);
 }
 
-void motor_set_pwm_duty_ratio(enum motor_index index, float duty_ratio) {
-    const uint16_t level_max = pwm_hw->slice[pwm_slice_num].top;
+void HAL_ISR_FUNC(motor_set_pwm_duty_ratio)(enum motor_index index, float duty_ratio) {
+    const uint16_t level_max = hal_pwm_get_top(pwm_slice_num);
 
     int level = abs(duty_ratio * level_max);
     if (level > level_max) { // 오버플로우 방지
@@ -144,14 +97,17 @@ void motor_set_pwm_duty_ratio(enum motor_index index, float duty_ratio) {
     } else if (level < 0) { // 언더플로우 방지
         level = 0;
     }
-    pwm_set_chan_level(pwm_slice_num, index, (uint16_t)level); // PWM 인가
+    hal_pwm_set_level(pwm_slice_num, index, (uint16_t)level); // PWM 인가
 
-    gpio_put(dir_gpio[index], duty_ratio > 0.f); // 방향 설정
+    hal_gpio_put(dir_gpio[index], duty_ratio > 0.f); // 방향 설정
 }
 
+volatile float motor_control_gain_p = MOTOR_CONTROL_GAIN_P;
+volatile float motor_control_gain_d = MOTOR_CONTROL_GAIN_D;
+
 static struct motor_control_state_t control_state[MOTOR_COUNT];
 
-struct motor_control_state_t motor_get_control_state(enum motor_index index) {
+struct motor_control_state_t HAL_ISR_FUNC(motor_get_control_state)(enum motor_index index) {
     return control_state[index];
 }
 
@@ -159,9 +115,12 @@ struct motor_control_state_t motor_get_control_state(enum motor_index index) {
  * @brief 위치에 대한 목표값과 현재값의 차이(오차)를 계산하여 모터가 목표값까지 도달하기 위해 필요한 전압을 계산한다.
  */
 static inline void motor_control_dt(const enum motor_index index) {
-    static const float dt_s = (float)MOTOR_CONTROL_INTERVAL_US / (1000 * 1000);
     struct motor_control_state_t *const state = &control_state[index];
 
+    // 제어 중에도 USB 명령으로 게인이 바뀔 수 있으므로 매 주기마다 읽어온다.
+    state->gain_p = motor_control_gain_p;
+    state->gain_d = motor_control_gain_d;
+
     // 엔코더를 이용해 현재 모터의 위치를 구한다.
     state->current = motor_get_encoder_value(index);
 
@@ -190,10 +149,23 @@ static inline void motor_control_dt(const enum motor_index index) {
     state->error = error;
 }
 
+void motor_bench_control_dt(enum motor_index index) {
+    motor_control_dt(index);
+}
+
 // 모터 위치 PID 제어 시 목표량(Set Point, SP)을 결정하는 함수
 static motor_target_updater_t target_updater = NULL;
 
-static void motor_control_handler(void) {
+// 직전 제어 주기의 시각. 주기가 MOTOR_CONTROL_OVERRUN_US보다 길어지면 이벤트를 보낸다.
+static uint32_t control_last_us = 0;
+
+static void HAL_ISR_FUNC(motor_control_handler)(void) {
+    const uint32_t now_us = hal_time_us_32();
+    if (now_us - control_last_us > MOTOR_CONTROL_OVERRUN_US) {
+        event_push(EVENT_CONTROL_OVERRUN, now_us - control_last_us);
+    }
+    control_last_us = now_us;
+
     // 매 주기마다 목표값을 업데이트하기 위해 외부 함수를 호출한다.
     if (target_updater) {
         target_updater(
@@ -203,6 +175,16 @@ static void motor_control_handler(void) {
     // 매 주기마다 PID 제어를 실시한다.
     motor_control_dt(MOTOR_LEFT);
     motor_control_dt(MOTOR_RIGHT);
+
+    if (telemetry_streams & TELEMETRY_STREAM_CONTROL) {
+        const struct telemetry_control_t frame = {
+            .time_us = hal_time_us_32(),
+            .current = { control_state[MOTOR_LEFT].current, control_state[MOTOR_RIGHT].current },
+            .target = { control_state[MOTOR_LEFT].target, control_state[MOTOR_RIGHT].target },
+            .error = { control_state[MOTOR_LEFT].error, control_state[MOTOR_RIGHT].error },
+        };
+        telemetry_push(TELEMETRY_FRAME_CONTROL, &frame, sizeof(frame));
+    }
 }
 
 void motor_control_start(const motor_target_updater_t updater) {
@@ -211,13 +193,14 @@ void motor_control_start(const motor_target_updater_t updater) {
     for (int i = 0; i < MOTOR_COUNT; i++) {
         struct motor_control_state_t *const state = &control_state[i];
 
-        state->gain_p = MOTOR_CONTROL_GAIN_P;
-        state->gain_d = MOTOR_CONTROL_GAIN_D;
+        state->gain_p = motor_control_gain_p;
+        state->gain_d = motor_control_gain_d;
         state->target = state->current = motor_get_encoder_value(i);
         state->error = 0;
     }
 
     target_updater = updater;
+    control_last_us = hal_time_us_32();
     timer_periodic_start(
         MOTOR_CONTROL_TIMER_SLOT, MOTOR_CONTROL_INTERVAL_US, motor_control_handler);
 }
@@ -38,6 +38,16 @@ void motor_pwm_enabled(const bool enabled);
  */
 void motor_set_pwm_duty_ratio(enum motor_index index, float duty_ratio);
 
+/**
+ * @brief 모터 위치 PD 제어의 비례 이득. 제어 주기마다 읽어 적용한다.
+ */
+extern volatile float motor_control_gain_p;
+
+/**
+ * @brief 모터 위치 PD 제어의 미분 이득. 제어 주기마다 읽어 적용한다.
+ */
+extern volatile float motor_control_gain_d;
+
 struct motor_control_state_t {
     float gain_p;
     float gain_d;
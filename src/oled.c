@@ -37,18 +37,34 @@
  * DC 핀이 High일 때, SPI 통신으로 데이터를 전송하면 GDDRAM에 기록된다.
  * 기록되는 위치는 내부적으로 상태가 보존되며, 데이터 하나가 기록되면 그 다음 데이터를 알아서 가리키도록 설계돼있다.
  * 이때 다음 비트를 선택하는 기준은 세로(다음 열)가 될 수 있고, 가로(다음 행)가 될 수 있다.
- * 우리의 폰트는 가로로 읽는 것이 편하기 때문에 가로(다음 행)으로 다음 픽셀을 선택하도록 설정한다(OLED_CMD_SETREMAP).
+ * 우리는 화면 전체를 RAM의 framebuffer에 행 단위로 그려두고 변경된 영역만 DMA로 보내므로,
+ * framebuffer의 메모리 배치와 같도록 가로(다음 열)로 다음 픽셀을 선택하도록 설정한다(OLED_CMD_SETREMAP).
+ *
+ * [ Framebuffer & DMA ]
+ * 그리기 함수들은 SPI 통신을 직접 하지 않고 framebuffer에 픽셀만 쓴 후 변경된 영역(dirty rectangle)을 기록한다.
+ * DMA가 쉬고 있다면 바로 전송을 시작하고, 전송 중이라면 전송 완료 인터럽트에서 그 사이에 쌓인 영역을 이어서 전송한다.
+ * 따라서 CPU는 픽셀을 그리기만 하고 SPI 전송을 기다리지 않는다.
+ *
+ * [ Text Mode ]
+ * oled_printf는 화면을 (FONT_WIDTH + 1) x (FONT_HEIGHT + 1) 크기의 칸으로 나눈 문자 격자에 출력한다.
+ * 각 칸에 마지막으로 그린 문자와 색상을 shadow 격자에 기억해두고, 바뀐 칸만 다시 그린다.
+ * 메뉴나 테스트 화면처럼 같은 문자열을 매 반복마다 출력하는 경우, 값이 바뀐 자리만 전송된다.
  */
 
-#include <stdio.h>
 #include <stdarg.h>
+#include <string.h>
 #include "hardware/gpio.h"
 #include "hardware/spi.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
 
 #include "oled.h"
 
 #include "starfont.h"
-#define FONT        STARFONT_ASCII
+#include "starfont_atlas.h"
+#define FONT_ROWS   STARFONT_ATLAS_ROWS
+#define FONT_EXPAND STARFONT_ATLAS_EXPAND
 #define FONT_WIDTH  STARFONT_ASCII_WIDTH
 #define FONT_HEIGHT STARFONT_ASCII_HEIGHT
 
@@ -90,8 +106,55 @@ enum oled_command {
 };
 /* clang-format on */
 
-#define OLED_WIDTH  96
-#define OLED_HEIGHT 64
+/**
+ * @brief OLED 화면 전체를 담는 framebuffer. (96 x 64 x 2 bytes = 12KB)
+ *
+ * 우리가 사용하는 MCU는 Cortex-M0+ 시리즈이며, little endian으로 데이터를 저장한다.
+ * 하지만, SSD1331은 65k format 1 모드에서 상위 8비트를 먼저 받는 big endian 방식으로 데이터를 처리한다.
+ *   Bit: 15 14 13 12 11 10  9  8  7  6  5  4  3  2  1  0
+ *   1st:  x  x  x  x  x  x  x  x C4 C3 C2 C1 C0 B5 B4 B3
+ *   2nd:  x  x  x  x  x  x  x  x B2 B1 B0 A4 A3 A2 A1 A0
+ * 이를테면, 모든 A 비트가 1인 상황인 0x001F는 MCU 메모리에 0x1F, 0x00 순서로 들어가므로 그대로 보내면 안된다.
+ * 그래서 framebuffer에는 픽셀을 그릴 때 미리 바이트 순서를 바꾼 값(bus order)을 저장하여, DMA가 메모리를 그대로 보낼 수 있도록 한다.
+ */
+static uint16_t framebuffer[OLED_HEIGHT][OLED_WIDTH];
+
+/**
+ * @brief framebuffer에서 아직 OLED에 반영되지 않은 영역 (dirty rectangle)
+ * x0 > x1이면 비어있는 것으로 본다.
+ */
+static struct oled_rect_t {
+    uint8_t x0, y0, x1, y1;
+} dirty = { OLED_WIDTH, OLED_HEIGHT, 0, 0 };
+
+#define OLED_TEXT_COLS (OLED_WIDTH / (FONT_WIDTH + 1)) // 16
+#define OLED_TEXT_ROWS (OLED_HEIGHT / (FONT_HEIGHT + 1)) // 7
+
+/**
+ * @brief 문자 격자의 각 칸에 현재 framebuffer에 그려져 있는 문자와 색상.
+ * 문자가 OLED_CELL_INVALID이면 그 칸의 내용을 알 수 없으므로 다음 출력 때 반드시 다시 그린다.
+ */
+#define OLED_CELL_INVALID (0xFF)
+static struct oled_cell_t {
+    uint8_t c;
+    uint16_t color;
+} text_shadow[OLED_TEXT_ROWS][OLED_TEXT_COLS];
+
+/**
+ * @brief DMA 전송에 사용하는 채널들.
+ * data 채널은 framebuffer의 한 행(의 일부)을 SPI로 보내고, 끝나면 control 채널을 실행한다(chain).
+ * control 채널은 다음 행의 주소를 data 채널의 read address trigger 레지스터에 써서 data 채널을 다시 시작시킨다.
+ * 행 주소 목록의 끝에 NULL을 두면 data 채널이 멈추면서 인터럽트가 발생한다.
+ */
+static int dma_data_channel;
+static int dma_ctrl_channel;
+static const uint16_t *dma_row_address[OLED_HEIGHT + 1];
+static volatile bool dma_active = false;
+
+/**
+ * @brief 0보다 크면 `oled_draw_end`가 호출될 때까지 전송을 시작하지 않고 dirty rectangle만 쌓는다.
+ */
+static uint draw_depth = 0;
 
 /**
  * @brief OLED에 명령을 보내는 함수.
@@ -108,48 +171,12 @@ static inline void oled_write_command(const uint8_t *cmd, size_t length) {
     gpio_put(OLED_GPIO_CS, 1);
 }
 
-/**
- * @brief SPI 통신으로 OLED의 GDDRAM에 값(색상 데이터)을 작성하는 함수.
- * 매개변수로 전달 받은 데이터를 모두 보낼 때까지 동기적(synchronous)으로 동작한다.
- *
- * @param data 16비트 형태의 색상값들의 배열
- * @param length 보낼 값들의 갯수 (바이트 수가 아님을 주의)
- */
-static inline void oled_write_data(uint16_t *const data, int length) {
-    gpio_put(OLED_GPIO_CS, 0);
-    gpio_put(OLED_GPIO_DC, 1); // 0 is command mode
-
-    /**
-     * SSD1331 GDDRAM에 데이터를 어떻게 보내야 하는지 알아보자.
-     * 우리는 SSD1331을 초기화할 때 Remap & Color Depth setting에서 color format을 65k format 1 모드로 설정했다.
-     * 65k format 1모드는 다음과 같이 데이터를 전송하라고 정의한다.
-     *   Bit: 15 14 13 12 11 10  9  8  7  6  5  4  3  2  1  0
-     *   1st:  x  x  x  x  x  x  x  x C4 C3 C2 C1 C0 B5 B4 B3
-     *   2nd:  x  x  x  x  x  x  x  x B2 B1 B0 A4 A3 A2 A1 A0
-     *
-     * 우리가 사용하는 MCU는 Cortex-M0+ 시리즈이며, little endian으로 데이터를 저장한다.
-     * 하지만, SSD1331은 big endian 방식으로 데이터를 처리하므로, little-big 사이의 변환이 필요하다.
-     * 이를테면, 모든 A 비트가 1인 상황인 0x001F([15:0] 0000 0000 0001 1111)는
-     * MCU 메모리 어딘가 첫 번째 번지에 0x1F 값이 들어가고, 그 다음 번지에 0x00이 들어간다.
-     * 그러면, SPI 통신으로 데이터를 8비트씩 보낼 때 0번지 부터 값을 보낼 것이므로 0x1F을 보내고 0x00을 그 다음으로 보낼 것이다.
-     * SSD1331은 C1 C0 B5 B4 B3 데이터가 1인 것으로 인식할 것이며 이러면 안되므로,
-     * 상위 8비트 0x00을 보내고 나서 하위 8비트 0x1F 보내는 식으로 진행해야 한다.
-     * 다른 색상 정보도 마찬가지로 데이터를 전송할 때 상위 8비트를 먼저 보내야 한다.
-     */
-    for (int i = 0; i < length; i++) {
-        data[i] = __builtin_bswap16(data[i]); // endian 변환
-    }
-    spi_write_blocking(OLED_SPI, (uint8_t *)data, sizeof(uint16_t) * length);
-
-    gpio_put(OLED_GPIO_CS, 1);
-}
-
 /**
  * @brief SSD1331 OLED의 GDDRAM에 값을 쓸 때 값이 쓰여지는 범위를 지정하는 함수.
  * SSD1331 OLED에는 GDDRAM이라는 그래픽 메모리가 존재하며, Data 모드일 경우 SPI 통신으로 값을 쓸 때 GDDRAM에 값이 쓰여진다.
  * 이 함수는 값이 쓰여지는 범위를 지정할 수 있는데, 이 범위는 그래픽 메모리에 값이 쓰여지는 범위를 설정한다.
- * 범위를 설정하게 되면, 그래픽 메모리에 수직적으로(위에서 아래로) 값을 기록하다가 설정된 범위를 넘어갔을 때,
- * 다음 열로(왼쪽에서 오른쪽으로) 이동하여 계속해서 값이 기록되는 부가 효과를 만들 수 있다.
+ * 범위를 설정하게 되면, 그래픽 메모리에 수평적으로(왼쪽에서 오른쪽으로) 값을 기록하다가 설정된 범위를 넘어갔을 때,
+ * 다음 행으로(위에서 아래로) 이동하여 계속해서 값이 기록되는 부가 효과를 만들 수 있다.
  *
  * @param x1 GDDRAM 시작 열
  * @param y1 GDDRAM 시작 행
@@ -169,17 +196,238 @@ static inline void oled_set_address(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t
     oled_write_command(cmd, sizeof(cmd));
 }
 
+/**
+ * @brief 쌓인 dirty rectangle을 가져가고 DMA 전송을 차지한다(dma_active).
+ * 인터럽트가 비활성화된 상태 또는 DMA 인터럽트 핸들러 안에서만 호출해야 한다.
+ *
+ * @return bool 보낼 영역이 있으면 true, 이 경우 이어서 `oled_dma_send`를 호출해야 한다.
+ */
+static bool oled_dma_claim(struct oled_rect_t *rect) {
+    *rect = dirty;
+    dirty = (struct oled_rect_t) { OLED_WIDTH, OLED_HEIGHT, 0, 0 };
+
+    if (rect->x0 > rect->x1) {
+        return false; // 보낼 영역이 없다.
+    }
+
+    dma_active = true;
+    return true;
+}
+
+/**
+ * @brief `oled_dma_claim`으로 가져간 영역을 OLED로 보내는 DMA 전송을 시작한다.
+ * 주소 명령은 SPI로 기다리며 보내므로, 제어 인터럽트가 밀리지 않도록 인터럽트를 켠 상태에서 호출한다.
+ * dma_active가 true인 동안에는 다른 곳에서 SPI를 쓰지 않는다.
+ */
+static void oled_dma_send(const struct oled_rect_t *rect) {
+    // OLED GDDRAM에 데이터를 넣을 시작 위치와 종료 위치를 설정한다.
+    oled_set_address(rect->x0, rect->y0, rect->x1, rect->y1);
+
+    // 각 행에서 보낼 부분의 시작 주소를 control 채널이 읽을 목록으로 만든다.
+    int rows = 0;
+    for (int y = rect->y0; y <= rect->y1; y++) {
+        dma_row_address[rows++] = &framebuffer[y][rect->x0];
+    }
+    dma_row_address[rows] = NULL;
+
+    const uint bytes_per_row = sizeof(uint16_t) * (rect->x1 - rect->x0 + 1);
+    dma_channel_set_trans_count(dma_data_channel, bytes_per_row, false);
+
+    gpio_put(OLED_GPIO_CS, 0);
+    gpio_put(OLED_GPIO_DC, 1); // 1 is data mode
+    dma_channel_set_read_addr(dma_ctrl_channel, dma_row_address, true);
+}
+
+/**
+ * @brief DMA 전송 완료(NULL trigger) 인터럽트 핸들러.
+ * SPI FIFO에 남은 데이터가 모두 나갈 때까지 기다린 후 CS를 해제하고, 그 사이에 쌓인 영역이 있다면 이어서 전송한다.
+ * 가장 낮은 우선순위로 동작하므로 주소 명령을 보내는 동안에도 제어 인터럽트는 실행된다.
+ */
+static void oled_dma_handler(void) {
+    dma_channel_acknowledge_irq0(dma_data_channel);
+
+    while (spi_is_busy(OLED_SPI)) {
+        tight_loop_contents();
+    }
+    gpio_put(OLED_GPIO_CS, 1);
+    dma_active = false;
+
+    struct oled_rect_t rect;
+    if (oled_dma_claim(&rect)) {
+        oled_dma_send(&rect);
+    }
+}
+
+/**
+ * @brief framebuffer의 해당 영역이 변경되었음을 기록하고, DMA가 쉬고 있다면 전송을 시작한다.
+ */
+static void oled_mark_dirty(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1) {
+    struct oled_rect_t rect;
+    uint32_t status = save_and_disable_interrupts();
+
+    dirty.x0 = MIN(dirty.x0, x0);
+    dirty.y0 = MIN(dirty.y0, y0);
+    dirty.x1 = MAX(dirty.x1, x1);
+    dirty.y1 = MAX(dirty.y1, y1);
+
+    const bool is_claimed = !dma_active && draw_depth == 0 && oled_dma_claim(&rect);
+
+    restore_interrupts(status);
+
+    if (is_claimed) {
+        oled_dma_send(&rect);
+    }
+}
+
+/**
+ * @brief DMA 채널들을 설정한다.
+ */
+static void oled_dma_init(void) {
+    dma_data_channel = dma_claim_unused_channel(true);
+    dma_ctrl_channel = dma_claim_unused_channel(true);
+
+    // data 채널: framebuffer -> SPI TX FIFO, 8비트 단위로 전송하여 메모리 순서대로 내보낸다.
+    dma_channel_config data_conf = dma_channel_get_default_config(dma_data_channel);
+    channel_config_set_transfer_data_size(&data_conf, DMA_SIZE_8);
+    channel_config_set_read_increment(&data_conf, true);
+    channel_config_set_write_increment(&data_conf, false);
+    channel_config_set_dreq(&data_conf, spi_get_dreq(OLED_SPI, true));
+    channel_config_set_chain_to(&data_conf, dma_ctrl_channel);
+    channel_config_set_irq_quiet(&data_conf, true); // NULL trigger를 받았을 때에만 인터럽트를 발생시킨다.
+    dma_channel_configure(
+        dma_data_channel, &data_conf, &spi_get_hw(OLED_SPI)->dr, NULL, 0, false);
+
+    // control 채널: 행 주소 목록 -> data 채널의 read address trigger 레지스터
+    dma_channel_config ctrl_conf = dma_channel_get_default_config(dma_ctrl_channel);
+    channel_config_set_transfer_data_size(&ctrl_conf, DMA_SIZE_32);
+    channel_config_set_read_increment(&ctrl_conf, true);
+    channel_config_set_write_increment(&ctrl_conf, false);
+    dma_channel_configure(
+        dma_ctrl_channel, &ctrl_conf, &dma_hw->ch[dma_data_channel].al3_read_addr_trig, NULL, 1, false);
+
+    // 전송 완료 인터럽트는 제어 타이머보다 낮은 우선순위로 둔다.
+    dma_channel_set_irq0_enabled(dma_data_channel, true);
+    irq_set_exclusive_handler(DMA_IRQ_0, oled_dma_handler);
+    irq_set_priority(DMA_IRQ_0, PICO_LOWEST_IRQ_PRIORITY);
+    irq_set_enabled(DMA_IRQ_0, true);
+}
+
+/**
+ * @brief 문자 격자의 칸에 그릴 문자와 색상을 비교할 수 있는 형태로 만든다.
+ * 공백은 색상과 관계없이 똑같이 그려지므로 색상을 0으로 맞춘다.
+ */
+static inline struct oled_cell_t oled_make_cell(char c, uint16_t color) {
+    const uint8_t code = (uint8_t)c & 0x7F;
+    return (struct oled_cell_t) { code, code == ' ' ? 0x0000 : color };
+}
+
+/**
+ * @brief 해당 픽셀 영역과 겹치는 문자 격자 칸들을 무효화한다.
+ * 문자 격자를 거치지 않고 framebuffer에 그린 경우에 호출한다.
+ */
+static void oled_text_invalidate(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1) {
+    const int col_end = MIN(x1 / (FONT_WIDTH + 1), OLED_TEXT_COLS - 1);
+    const int row_end = MIN(y1 / (FONT_HEIGHT + 1), OLED_TEXT_ROWS - 1);
+
+    for (int row = y0 / (FONT_HEIGHT + 1); row <= row_end; row++) {
+        for (int col = x0 / (FONT_WIDTH + 1); col <= col_end; col++) {
+            text_shadow[row][col].c = OLED_CELL_INVALID;
+        }
+    }
+}
+
+void oled_draw_begin(void) {
+    draw_depth++;
+}
+
+void oled_draw_end(void) {
+    if (draw_depth > 0 && --draw_depth == 0) {
+        struct oled_rect_t rect;
+        uint32_t status = save_and_disable_interrupts();
+        const bool is_claimed = !dma_active && oled_dma_claim(&rect);
+        restore_interrupts(status);
+
+        if (is_claimed) {
+            oled_dma_send(&rect);
+        }
+    }
+}
+
+/**
+ * @brief 사각형 영역을 화면 범위로 자른다.
+ *
+ * @return bool 잘린 영역이 비어있으면 false
+ */
+static inline bool oled_clip(int *x, int *y, int *w, int *h) {
+    if (*x < 0) {
+        *w += *x;
+        *x = 0;
+    }
+    if (*y < 0) {
+        *h += *y;
+        *y = 0;
+    }
+    *w = MIN(*w, OLED_WIDTH - *x);
+    *h = MIN(*h, OLED_HEIGHT - *y);
+
+    return *w > 0 && *h > 0;
+}
+
+void oled_fill_rect(int x, int y, int w, int h, oled_color_t color) {
+    if (!oled_clip(&x, &y, &w, &h)) {
+        return;
+    }
+
+    const uint16_t bus_color = __builtin_bswap16(color);
+    for (int j = y; j < y + h; j++) {
+        for (int i = x; i < x + w; i++) {
+            framebuffer[j][i] = bus_color;
+        }
+    }
+
+    oled_text_invalidate(x, y, x + w - 1, y + h - 1);
+    oled_mark_dirty(x, y, x + w - 1, y + h - 1);
+}
+
+void oled_draw_vline(int x, int y0, int y1, oled_color_t color) {
+    if (y0 > y1) {
+        const int temp = y0;
+        y0 = y1;
+        y1 = temp;
+    }
+    oled_fill_rect(x, y0, 1, y1 - y0 + 1, color);
+}
+
+void oled_scroll_left(int x, int y, int w, int h, int dx) {
+    if (!oled_clip(&x, &y, &w, &h) || dx <= 0) {
+        return;
+    }
+
+    if (dx < w) {
+        for (int j = y; j < y + h; j++) {
+            memmove(&framebuffer[j][x], &framebuffer[j][x + dx], sizeof(uint16_t) * (w - dx));
+        }
+    }
+
+    oled_text_invalidate(x, y, x + w - 1, y + h - 1);
+    oled_mark_dirty(x, y, x + w - 1, y + h - 1);
+}
+
 void oled_clear(void) {
-    uint16_t data = 0x0000;
+    memset(framebuffer, 0x00, sizeof(framebuffer));
 
-    oled_set_address(0, 0, OLED_WIDTH - 1, OLED_HEIGHT - 1);
-    for (int i = 0; i < OLED_HEIGHT * OLED_WIDTH; i++) {
-        oled_write_data(&data, 1);
+    const struct oled_cell_t blank = oled_make_cell(' ', 0x0000);
+    for (int row = 0; row < OLED_TEXT_ROWS; row++) {
+        for (int col = 0; col < OLED_TEXT_COLS; col++) {
+            text_shadow[row][col] = blank;
+        }
     }
+
+    oled_mark_dirty(0, 0, OLED_WIDTH - 1, OLED_HEIGHT - 1);
 }
 
 void oled_init(void) {
-    // SPI 기능을 초기화한다.
+    // SPI 기능을 초기화한다. 분주비는 현재 clk_peri에서 계산되므로 클럭 프로파일과 관계없이 OLED_SPI_BUADRATE 이하로 동작한다.
     spi_init(OLED_SPI, OLED_SPI_BUADRATE);
     gpio_set_function(OLED_SPI_GPIO_SCL, GPIO_FUNC_SPI); // SPI 클럭 신호
     gpio_set_function(OLED_SPI_GPIO_SDA, GPIO_FUNC_SPI); // SPI TX 신호 (RX 신호는 따로 사용하지 않는다.)
@@ -200,10 +448,10 @@ void oled_init(void) {
     const uint8_t init_cmd[] = {
         OLED_CMD_DISPLAYOFF,
         /*
-         * 0x72 = 0b01110010 -> Horizontal address increment
-         * 0x73 = 0b01110011 -> Vertical address increment (이 모드를 사용, 제공된 폰트가 위에서 아래로 읽는 형태이기 때문)
+         * 0x72 = 0b01110010 -> Horizontal address increment (이 모드를 사용, framebuffer가 행 단위로 저장되기 때문)
+         * 0x73 = 0b01110011 -> Vertical address increment
          */
-        OLED_CMD_SETREMAP, 0x73,
+        OLED_CMD_SETREMAP, 0x72,
         OLED_CMD_STARTLINE, 0x00,
         OLED_CMD_DISPLAYOFFSET, 0x00,
         OLED_CMD_NORMALDISPLAY,
@@ -225,6 +473,29 @@ void oled_init(void) {
     };
 
     oled_write_command(init_cmd, sizeof(init_cmd));
+
+    oled_dma_init();
+    oled_clear();
+}
+
+/**
+ * @brief framebuffer에 문자 하나를 그린다. OLED로의 전송은 호출하는 쪽에서 요청해야 한다.
+ *
+ * 폰트는 빌드 전에 행 단위 비트맵(starfont_atlas.h)으로 변환되어 있으므로, 픽셀마다 비트를 검사하지 않는다.
+ * 행 마스크를 픽셀 마스크(0xFFFF 또는 0x0000)로 펼친 표를 bus order 색상과 AND 하여 그대로 복사한다.
+ */
+static inline void oled_draw_char(char c, oled_color_t color, uint8_t x, uint8_t y) {
+    const uint8_t *const rows = FONT_ROWS[(int)c & 0x7F];
+    const uint16_t bus_color = __builtin_bswap16(color);
+
+    for (int j = 0; j < FONT_HEIGHT; j++) {
+        const uint16_t *const mask = FONT_EXPAND[rows[j]];
+        uint16_t *const dst = &framebuffer[y + j][x];
+
+        for (int i = 0; i < FONT_WIDTH; i++) {
+            dst[i] = mask[i] & bus_color;
+        }
+    }
 }
 
 int oled_putchar(char c, oled_color_t color, uint8_t x, uint8_t y) {
@@ -235,33 +506,220 @@ int oled_putchar(char c, oled_color_t color, uint8_t x, uint8_t y) {
         // OLED 화면을 넘어서면 유효하지 않은 명령이다.
         return -1;
     }
-    // OLED GDDRAM에 데이터를 넣을 시작 위치(x, y)와 종료 위치(xe, ye)를 설정한다.
-    oled_set_address(x, y, xe, ye);
 
-    const char *font = FONT[(int)c];
-    static uint16_t data[FONT_WIDTH * FONT_HEIGHT];
+    oled_draw_char(c, color, x, y);
 
-    for (int i = 0; i < FONT_WIDTH; i++) {
-        for (int j = 0; j < FONT_HEIGHT; j++) {
-            data[FONT_HEIGHT * i + j] = font[i] & (1 << j) ? color : 0x0000;
-        }
+    // 문자 격자에 맞춰 그렸다면 shadow 격자를 갱신하고, 그렇지 않다면 겹치는 칸들을 무효화한다.
+    if (x % (FONT_WIDTH + 1) == 0 && y % (FONT_HEIGHT + 1) == 0) {
+        text_shadow[y / (FONT_HEIGHT + 1)][x / (FONT_WIDTH + 1)] = oled_make_cell(c, color);
+    } else {
+        oled_text_invalidate(x, y, xe, ye);
     }
 
-    oled_write_data(data, sizeof(data) / sizeof(uint16_t));
+    oled_mark_dirty(x, y, xe, ye);
     return 0;
 }
 
+/**
+ * @brief 부호 없는 정수를 base 진법의 문자열로 바꾸어 tmp의 끝에서부터 채운다.
+ *
+ * @return char* 변환된 문자열의 시작 위치
+ */
+static char *oled_format_uint(char *end, uint64_t value, uint base, bool upper) {
+    const char *digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    char *p = end;
+
+    do {
+        *--p = digits[value % base];
+        value /= base;
+    } while (value);
+
+    return p;
+}
+
+/**
+ * @brief oled_printf에서 사용하는 가벼운 서식 함수.
+ * 정수(%d %i %u %x %X), 문자(%c), 문자열(%s), 고정소수점 실수(%f)와 플래그(- 0 + 공백), 폭, 정밀도를 지원한다.
+ *
+ * vsprintf는 실수를 출력할 때 범용 double 변환 루틴(soft-float)을 거치므로 Cortex-M0+에서 매우 느리다.
+ * 여기서는 실수를 10^정밀도 배 한 64비트 정수로 한 번만 변환한 후, 나머지는 정수 연산으로 처리한다.
+ * (정밀도는 최대 9자리까지 지원한다.)
+ *
+ * @return int 버퍼에 쓴 문자 수 (NULL 문자 제외)
+ */
+static int oled_vformat(char *buffer, size_t size, const char *format, va_list args) {
+    char *out = buffer;
+    char *const out_end = buffer + size - 1;
+
+#define OLED_FORMAT_PUT(C)     \
+    do {                       \
+        if (out < out_end) {   \
+            *out++ = (C);      \
+        }                      \
+    } while (0)
+
+    for (const char *f = format; *f; f++) {
+        if (*f != '%') {
+            OLED_FORMAT_PUT(*f);
+            continue;
+        }
+
+        // 플래그
+        bool left = false, zero = false, plus = false, space = false;
+        for (;; f++) {
+            if (f[1] == '-') {
+                left = true;
+            } else if (f[1] == '0') {
+                zero = true;
+            } else if (f[1] == '+') {
+                plus = true;
+            } else if (f[1] == ' ') {
+                space = true;
+            } else {
+                break;
+            }
+        }
+
+        // 폭과 정밀도
+        int width = 0, precision = -1;
+        while (f[1] >= '0' && f[1] <= '9') {
+            width = width * 10 + (*++f - '0');
+        }
+        if (f[1] == '.') {
+            f++;
+            precision = 0;
+            while (f[1] >= '0' && f[1] <= '9') {
+                precision = precision * 10 + (*++f - '0');
+            }
+        }
+        while (f[1] == 'l' || f[1] == 'h') {
+            f++; // int와 long은 모두 32비트이므로 길이 지정자는 무시한다.
+        }
+
+        char tmp[24];
+        char *const tmp_end = tmp + sizeof(tmp);
+        const char *body = tmp_end;
+        int length = 0;
+        char sign = 0;
+        bool numeric = true;
+
+        switch (*++f) {
+        case 'd':
+        case 'i': {
+            const int value = va_arg(args, int);
+            sign = value < 0 ? '-' : plus ? '+' : space ? ' ' : 0;
+            body = oled_format_uint(tmp_end, value < 0 ? -(int64_t)value : value, 10, false);
+            break;
+        }
+        case 'u':
+            body = oled_format_uint(tmp_end, va_arg(args, uint), 10, false);
+            break;
+        case 'x':
+        case 'X':
+            body = oled_format_uint(tmp_end, va_arg(args, uint), 16, *f == 'X');
+            break;
+        case 'f': {
+            double value = va_arg(args, double);
+            precision = precision < 0 ? 6 : MIN(precision, 9);
+            sign = value < 0 ? '-' : plus ? '+' : space ? ' ' : 0;
+            value = value < 0 ? -value : value;
+
+            uint64_t scale = 1;
+            for (int i = 0; i < precision; i++) {
+                scale *= 10;
+            }
+            if (!(value < (double)(UINT64_MAX / scale))) { // NaN, inf, 범위 초과
+                body = value != value ? "nan" : "inf";
+                length = 3;
+                numeric = false;
+                break;
+            }
+
+            // 고정소수점으로 한 번 변환(반올림)한 후에는 정수 연산만 사용한다.
+            const uint64_t fixed = (uint64_t)(value * scale + 0.5);
+            char *p = tmp_end;
+            uint64_t frac = fixed % scale;
+            for (int i = 0; i < precision; i++) {
+                *--p = '0' + frac % 10;
+                frac /= 10;
+            }
+            if (precision > 0) {
+                *--p = '.';
+            }
+            body = oled_format_uint(p, fixed / scale, 10, false);
+            precision = -1; // 아래에서 정수의 정밀도로 해석되지 않도록 한다.
+            break;
+        }
+        case 'c':
+            tmp[0] = (char)va_arg(args, int);
+            body = tmp;
+            length = 1;
+            numeric = false;
+            break;
+        case 's':
+            body = va_arg(args, const char *);
+            length = strlen(body);
+            if (precision >= 0) {
+                length = MIN(length, precision);
+            }
+            numeric = false;
+            break;
+        case '%':
+            OLED_FORMAT_PUT('%');
+            continue;
+        case '\0':
+            f--; // 서식 문자열이 '%'로 끝난 경우
+            continue;
+        default:
+            continue; // 지원하지 않는 변환 지정자는 무시한다.
+        }
+
+        if (numeric) {
+            length = tmp_end - body;
+        }
+
+        // 정수에 정밀도가 지정되면 그 자리수만큼 0을 채우고, '0' 플래그는 폭의 나머지를 0으로 채운다.
+        int zeros = (numeric && precision > length) ? precision - length : 0;
+        int padding = width - length - zeros - (sign ? 1 : 0);
+        if (numeric && zero && !left && precision < 0 && padding > 0) {
+            zeros += padding;
+            padding = 0;
+        }
+
+        for (; !left && padding > 0; padding--) {
+            OLED_FORMAT_PUT(' ');
+        }
+        if (sign) {
+            OLED_FORMAT_PUT(sign);
+        }
+        for (; zeros > 0; zeros--) {
+            OLED_FORMAT_PUT('0');
+        }
+        for (int i = 0; i < length; i++) {
+            OLED_FORMAT_PUT(body[i]);
+        }
+        for (; padding > 0; padding--) {
+            OLED_FORMAT_PUT(' ');
+        }
+    }
+
+#undef OLED_FORMAT_PUT
+
+    *out = '\0';
+    return out - buffer;
+}
+
 void oled_printf(const char *format, ...) {
     static char buffer[OLED_PRINT_BUFFER];
     uint8_t posX = 0;
     uint8_t posY = 0;
 
     /*
-     * printf 함수처럼 가변 인자를 받고 vsprintf 함수를 통해 buffer에 서식 문자가 적용된 문자열을 저장한다.
+     * printf 함수처럼 가변 인자를 받고 oled_vformat 함수를 통해 buffer에 서식 문자가 적용된 문자열을 저장한다.
      */
     va_list args;
     va_start(args, format);
-    vsprintf(buffer, format, args);
+    oled_vformat(buffer, sizeof(buffer), format, args);
     va_end(args);
 
     /*
@@ -269,6 +727,7 @@ void oled_printf(const char *format, ...) {
      */
     int cursor = 0;
     oled_color_t color = OLED_COLOR_WHITE;
+    struct oled_rect_t drawn = { OLED_WIDTH, OLED_HEIGHT, 0, 0 }; // 이번 호출에서 그린 영역
 
     while (buffer[cursor]) {
 
@@ -311,8 +770,28 @@ void oled_printf(const char *format, ...) {
             }
         }
 
-        oled_putchar(buffer[cursor], color, posX, posY); // 문자를 화면에 표시한다.
+        // 문자 격자의 내용이 바뀐 칸만 framebuffer에 그린다. 화면을 넘어서는 문자는 무시한다.
+        const int col = posX / (FONT_WIDTH + 1);
+        const int row = posY / (FONT_HEIGHT + 1);
+        if (col < OLED_TEXT_COLS && row < OLED_TEXT_ROWS) {
+            const struct oled_cell_t cell = oled_make_cell(buffer[cursor], color);
+            struct oled_cell_t *const shadow = &text_shadow[row][col];
+
+            if (shadow->c != cell.c || shadow->color != cell.color) {
+                *shadow = cell;
+                oled_draw_char(buffer[cursor], color, posX, posY);
+                drawn.x0 = MIN(drawn.x0, posX);
+                drawn.y0 = MIN(drawn.y0, posY);
+                drawn.x1 = MAX(drawn.x1, posX + FONT_WIDTH - 1);
+                drawn.y1 = MAX(drawn.y1, posY + FONT_HEIGHT - 1);
+            }
+        }
         posX += FONT_WIDTH + 1; // FONT_WIDTH + 1를 해주는 이유는, 폰트 오른쪽 한 칸 여백을 남겨두기 위함이다.
         cursor++;
     }
+
+    // 그린 영역을 한 번에 전송하도록 요청한다.
+    if (drawn.x0 <= drawn.x1) {
+        oled_mark_dirty(drawn.x0, drawn.y0, drawn.x1, drawn.y1);
+    }
 }
@@ -14,6 +14,9 @@ void oled_clear(void);
  */
 void oled_init(void);
 
+#define OLED_WIDTH  96
+#define OLED_HEIGHT 64
+
 /*
  * 우리는 일상적으로 24비트 컬러를 사용한다. 각각 다음과 같이 나타낼 수 있다.
  *           0  1  2  3  4  5  6  7
@@ -68,6 +71,39 @@ typedef enum oled_colors oled_color_t;
  */
 int oled_putchar(char c, oled_color_t color, uint8_t x, uint8_t y);
 
+/**
+ * @brief 그리기 묶음을 시작한다. `oled_draw_end`가 호출될 때까지 OLED로의 전송을 미루고 변경된 영역만 모은다.
+ * 여러 그리기 함수를 연달아 호출할 때 한 번의 전송으로 묶기 위해 사용한다. 중첩해서 호출할 수 있다.
+ */
+void oled_draw_begin(void);
+
+/**
+ * @brief 그리기 묶음을 끝내고, 모인 변경 영역의 전송을 시작한다.
+ */
+void oled_draw_end(void);
+
+/**
+ * @brief 사각형 영역을 한 가지 색으로 채운다. 화면을 벗어나는 부분은 잘린다.
+ *
+ * @param x 시작 가로 위치
+ * @param y 시작 세로 위치
+ * @param w 너비
+ * @param h 높이
+ * @param color 채울 색상
+ */
+void oled_fill_rect(int x, int y, int w, int h, oled_color_t color);
+
+/**
+ * @brief x 열의 y0에서 y1까지(양 끝 포함) 세로 선을 그린다.
+ */
+void oled_draw_vline(int x, int y0, int y1, oled_color_t color);
+
+/**
+ * @brief 사각형 영역의 내용을 왼쪽으로 dx 픽셀만큼 민다. 오른쪽 끝 dx 열의 내용은 그대로 남으므로 호출하는 쪽에서 다시 그려야 한다.
+ * framebuffer 안에서 밀기 때문에 영역 전체가 dirty가 되어 OLED로 다시 전송된다.
+ */
+void oled_scroll_left(int x, int y, int w, int h, int dx);
+
 /**
  * @brief 서식을 포함한 문자열을 OLED에 출력하는 함수.
  *
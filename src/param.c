@@ -0,0 +1,186 @@
+/**
+ * @file param.c
+ * @brief 튜닝 파라미터 레지스트리
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "param.h"
+#include "drive.h"
+#include "sensing.h"
+#include "motor.h"
+#include "oled.h"
+#include "switch.h"
+#include "fs.h"
+
+/* clang-format off */
+#define PARAM_FLOAT(NAME, FORMAT, GROUP, VAR, MIN, MAX, STEP) \
+    { .name = NAME, .format = FORMAT, .type = PARAM_TYPE_FLOAT, .group = GROUP, .value.f = &(VAR), .min = MIN, .max = MAX, .step = STEP }
+#define PARAM_INT(NAME, FORMAT, GROUP, VAR, MIN, MAX, STEP) \
+    { .name = NAME, .format = FORMAT, .type = PARAM_TYPE_INT, .group = GROUP, .value.i = &(VAR), .min = MIN, .max = MAX, .step = STEP }
+
+/**
+ * @brief 파라미터 레지스트리. 주행 전 편집 화면에는 이 순서대로 표시된다.
+ * 항목을 추가하거나 이름, 타입을 바꾸면 flash에 저장된 값은 무효화되고 기본값이 사용된다.
+ */
+static const struct param_t params[] = {
+    PARAM_FLOAT("default velocity",      "%1.2f", PARAM_GROUP_DRIVE,        drive_v_default,     0.0f, 10.0f,    0.1f),
+    PARAM_FLOAT("curvature coefficient", "%1.6f", PARAM_GROUP_DRIVE,        drive_curve_coef,    0.0f, 0.001f,   0.00001f),
+    PARAM_FLOAT("look ahead",            "%1.3f", PARAM_GROUP_DRIVE,        drive_look_ahead,    0.0f, 0.1f,     0.002f),
+    PARAM_FLOAT("steer velocity",        "%1.2f", PARAM_GROUP_DRIVE,        drive_steer_velocity, 0.0f, 10.0f,   0.1f),
+    PARAM_INT  ("curve deceleration",    "%5d",   PARAM_GROUP_DRIVE,        drive_curve_decel,   1000, 100000,   1000),
+    PARAM_FLOAT("fit in",                "%1.2f", PARAM_GROUP_DRIVE,        drive_fit_in,        0.01f, 1.0f,    0.01f),
+    PARAM_FLOAT("peak velocity",         "%1.2f", PARAM_GROUP_DRIVE_SECOND, drive_v_peak,        0.0f, 15.0f,    0.1f),
+    PARAM_FLOAT("accel",                 "%1.2f", PARAM_GROUP_DRIVE_SECOND, drive_accel,         1.0f, 30.0f,    1.0f),
+    PARAM_FLOAT("decel",                 "%1.2f", PARAM_GROUP_DRIVE_SECOND, drive_decel,         1.0f, 30.0f,    1.0f),
+    PARAM_FLOAT("safe distance",         "%1.2f", PARAM_GROUP_DRIVE_SECOND, drive_safe_distance, 0.0f, 1.0f,     0.01f),
+    PARAM_INT  ("mark recover",          "%d",    PARAM_GROUP_DRIVE_SECOND, drive_mark_recover,  0, 1,           1),
+    PARAM_INT  ("escalate",              "%d",    PARAM_GROUP_DRIVE_SECOND, drive_escalate,      0, 1,           1),
+    PARAM_FLOAT("steer feedforward",     "%1.2f", PARAM_GROUP_DRIVE_SECOND, drive_steer_feedforward, 0.0f, 1.5f, 0.05f),
+    PARAM_FLOAT("limiter delta in",      "%3.1f", PARAM_GROUP_SENSING,      sensing_ir_limiter_delta_in,  1.0f, 200.0f, 1.0f),
+    PARAM_FLOAT("limiter delta out",     "%3.1f", PARAM_GROUP_SENSING,      sensing_ir_limiter_delta_out, 1.0f, 200.0f, 1.0f),
+    PARAM_FLOAT("motor gain p",          "%1.3f", PARAM_GROUP_MOTOR,        motor_control_gain_p, 0.0f, 2.0f,    0.01f),
+    PARAM_FLOAT("motor gain d",          "%1.3f", PARAM_GROUP_MOTOR,        motor_control_gain_d, 0.0f, 2.0f,    0.01f),
+};
+/* clang-format on */
+
+#define PARAM_COUNT (sizeof(params) / sizeof(struct param_t))
+
+_Static_assert(PARAM_COUNT <= PARAM_COUNT_MAX, "PARAM_COUNT_MAX is too small for the parameter registry");
+
+/**
+ * @brief 레지스트리의 이름과 타입으로부터 서명(FNV-1a 해시)을 구한다.
+ * flash에 저장된 값들은 이 서명이 일치할 때에만 유효한 것으로 본다.
+ */
+static uint32_t param_signature(void) {
+    uint32_t hash = 2166136261u;
+
+    for (uint i = 0; i < PARAM_COUNT; i++) {
+        for (const char *c = params[i].name; *c; c++) {
+            hash = (hash ^ (uint8_t)*c) * 16777619u;
+        }
+        hash = (hash ^ (uint8_t)params[i].type) * 16777619u;
+    }
+
+    return hash;
+}
+
+void param_init(void) {
+#if FLASH_LOAD_DEFAULT
+    const struct fs_data_t *fs = fs_get_data();
+
+    if (fs->param_signature == param_signature()) {
+        for (uint i = 0; i < PARAM_COUNT; i++) {
+            param_write(&params[i], fs->param_value[i]);
+        }
+    }
+#endif
+}
+
+uint param_count(void) {
+    return PARAM_COUNT;
+}
+
+const struct param_t *param_get(uint index) {
+    return index < PARAM_COUNT ? &params[index] : NULL;
+}
+
+const struct param_t *param_find(const char *name) {
+    for (uint i = 0; i < PARAM_COUNT; i++) {
+        if (strcmp(params[i].name, name) == 0) {
+            return &params[i];
+        }
+    }
+
+    return NULL;
+}
+
+float param_read(const struct param_t *param) {
+    if (param->type == PARAM_TYPE_INT) {
+        return (float)*param->value.i;
+    }
+
+    return *param->value.f;
+}
+
+float param_write(const struct param_t *param, float value) {
+    value = MIN(value, param->max);
+    value = MAX(value, param->min);
+
+    if (param->type == PARAM_TYPE_INT) {
+        *param->value.i = (int)lroundf(value);
+    } else {
+        *param->value.f = value;
+    }
+
+    return param_read(param);
+}
+
+int param_save(void) {
+    struct fs_data_t *fs = fs_get_data();
+
+    fs->param_signature = param_signature();
+    for (uint i = 0; i < PARAM_COUNT_MAX; i++) {
+        fs->param_value[i] = i < PARAM_COUNT ? param_read(&params[i]) : 0.0f;
+    }
+
+    return fs_flush_data();
+}
+
+/**
+ * @brief 파라미터의 현재 값을 OLED에 표시한다.
+ */
+static void param_display(const struct param_t *param, uint index) {
+    char format[32];
+
+    oled_printf("/0/gSet Parameter/1/w%s", param->name);
+    snprintf(format, sizeof(format), "/2:=%s", param->format);
+    if (param->type == PARAM_TYPE_INT) {
+        oled_printf(format, *param->value.i);
+    } else {
+        oled_printf(format, *param->value.f);
+    }
+    oled_printf("/6/K%2u//%2u", index + 1, (uint)PARAM_COUNT);
+}
+
+void param_edit(uint group) {
+    bool changed = false;
+
+    for (uint i = 0; i < PARAM_COUNT; i++) {
+        const struct param_t *const param = &params[i];
+        if (!(param->group & group)) {
+            continue;
+        }
+
+        oled_clear();
+        for (;;) {
+            param_display(param, i);
+
+            enum switch_event_t sw = switch_read();
+            if (sw == SWITCH_EVENT_BOTH) {
+                break;
+            } else if (sw == SWITCH_EVENT_LEFT) {
+                param_write(param, param_read(param) - param->step);
+                changed = true;
+            } else if (sw == SWITCH_EVENT_RIGHT) {
+                param_write(param, param_read(param) + param->step);
+                changed = true;
+            }
+        }
+    }
+
+    if (!changed) {
+        return;
+    }
+
+    // flash 저장
+    oled_clear();
+    oled_printf("/0Do you want/1to /gsave/2/wparameters?/4(YES // NO)");
+    enum switch_event_t sw = switch_wait_until_input();
+    if (sw == SWITCH_EVENT_LEFT) {
+        oled_printf("/6Saving ...");
+        param_save();
+    }
+}
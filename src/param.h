@@ -0,0 +1,106 @@
+/**
+ * @file param.h
+ * @brief 주행, 센싱, 모터 제어에 사용되는 튜닝 파라미터들을 한 곳에서 관리하는 레지스트리
+ *
+ * 각 파라미터는 이름, 타입, 최소/최대값, 증감 단위를 가지며, 실제 값은 해당 모듈의 전역 변수에 있다.
+ * 레지스트리는 그 변수를 가리키기만 하므로, 모듈은 평소처럼 자기 변수를 읽으면 된다.
+ * 값들은 flash에 저장되어 리셋 후에도 유지된다.
+ */
+
+#ifndef _PARAM_H_
+#define _PARAM_H_
+
+#include "pico/types.h"
+#include "config.h"
+
+enum param_type_t {
+    PARAM_TYPE_INT = 0,
+    PARAM_TYPE_FLOAT,
+};
+
+/**
+ * @brief 파라미터가 속한 그룹. 주행 전 편집 화면에서 어떤 파라미터를 보여줄지 결정할 때 사용한다.
+ */
+enum param_group_t {
+    PARAM_GROUP_DRIVE = 0x01, // 1차, n차 주행 공통
+    PARAM_GROUP_DRIVE_SECOND = 0x02, // n차 주행 전용
+    PARAM_GROUP_SENSING = 0x04,
+    PARAM_GROUP_MOTOR = 0x08,
+    PARAM_GROUP_ALL = 0xFF,
+};
+
+struct param_t {
+    const char *name;
+    const char *format; // OLED에 값을 표시할 때 사용할 서식 문자열
+    enum param_type_t type;
+    enum param_group_t group;
+    union {
+        volatile int *i;
+        volatile float *f;
+    } value;
+    float min, max, step;
+};
+
+/**
+ * @brief 파라미터 레지스트리를 초기화한다. flash에 저장된 값이 현재 레지스트리와 일치하면 그 값을 불러온다.
+ * `fs_init` 함수가 호출된 후에 호출해야 한다.
+ */
+void param_init(void);
+
+/**
+ * @brief 등록된 파라미터의 개수를 반환한다.
+ */
+uint param_count(void);
+
+/**
+ * @brief index 번째 파라미터를 반환한다.
+ *
+ * @param index 0 이상 `param_count()` 미만의 값
+ * @return const struct param_t * 범위를 벗어나면 NULL
+ */
+const struct param_t *param_get(uint index);
+
+/**
+ * @brief 이름으로 파라미터를 찾는다.
+ *
+ * @param name 파라미터 이름
+ * @return const struct param_t * 찾지 못하면 NULL
+ */
+const struct param_t *param_find(const char *name);
+
+/**
+ * @brief 파라미터의 현재 값을 실수로 반환한다.
+ */
+float param_read(const struct param_t *param);
+
+/**
+ * @brief 파라미터에 값을 쓴다. 값은 [min, max] 범위로 제한되며, 정수 파라미터는 반올림된다.
+ *
+ * @return float 실제로 적용된 값
+ */
+float param_write(const struct param_t *param, float value);
+
+/**
+ * @brief 현재 파라미터 값들을 flash에 저장한다.
+ *
+ * @return 0: flash에 쓰기 성공, 1: flash에 쓰기 실패
+ */
+int param_save(void);
+
+/**
+ * @brief 스위치와 OLED를 이용하여 group에 속한 파라미터들을 차례로 편집한다.
+ * 왼쪽 스위치는 감소, 오른쪽 스위치는 증가, 양쪽 스위치는 다음 파라미터로 넘어간다.
+ * 값이 바뀌었다면 마지막에 flash에 저장할 것인지 묻는다.
+ *
+ * @param group enum param_group_t의 조합
+ */
+void param_edit(uint group);
+
+/**
+ * @brief 모든 파라미터를 편집하는 메뉴 함수
+ */
+static inline void param_edit_all(void) {
+    param_edit(PARAM_GROUP_ALL);
+}
+
+#endif
@@ -0,0 +1,128 @@
+/**
+ * @file plot.c
+ * @brief 실시간 신호를 OLED에 흐르는 그래프(strip chart)로 그리는 위젯
+ */
+
+#include <string.h>
+#include "hardware/timer.h"
+
+#include "plot.h"
+
+/**
+ * @brief 샘플 값을 그래프 영역 안의 y 좌표로 바꾼다. 범위를 벗어나면 영역의 위, 아래 끝으로 제한된다.
+ */
+static inline int plot_value_to_y(const struct plot_t *plot, float value) {
+    const float ratio = (value - plot->min) / (plot->max - plot->min);
+    int y = plot->y + plot->height - 1 - (int)(ratio * (plot->height - 1) + 0.5f);
+
+    y = MAX(y, plot->y);
+    y = MIN(y, plot->y + plot->height - 1);
+    return y;
+}
+
+/**
+ * @brief 그래프의 x 열에 배경과 각 신호의 샘플을 그린다.
+ * 신호는 직전 샘플의 위치에서 현재 샘플의 위치까지 세로 선으로 이어서 그린다.
+ *
+ * @param index ring buffer에서 그릴 샘플의 위치
+ * @param first 참이면 이어 그릴 직전 샘플이 없다.
+ */
+static void plot_draw_column(struct plot_t *plot, int x, uint index, bool first) {
+    oled_fill_rect(x, plot->y, 1, plot->height, OLED_COLOR_DARK);
+
+    // 0이 범위 안에 있다면 기준선을 그린다.
+    if (plot->min < 0.0f && 0.0f < plot->max) {
+        const int zero = plot_value_to_y(plot, 0.0f);
+        oled_fill_rect(x, zero, 1, 1, OLED_COLOR_GRAY);
+    }
+
+    for (uint i = 0; i < plot->trace_count; i++) {
+        struct plot_trace_t *const trace = &plot->trace[i];
+        const int y = plot_value_to_y(plot, trace->history[index]);
+
+        oled_draw_vline(x, first ? y : trace->last_y, y, trace->color);
+        trace->last_y = y;
+    }
+}
+
+void plot_init(struct plot_t *plot, int x, int y, int width, int height, float min, float max, uint fps) {
+    memset(plot, 0, sizeof(struct plot_t));
+
+    plot->x = x;
+    plot->y = y;
+    plot->width = MIN(width, PLOT_HISTORY);
+    plot->height = height;
+
+    plot->autoscale = !(min < max);
+    plot->min = min;
+    plot->max = max;
+
+    plot->interval_us = 1000000 / (fps ? fps : PLOT_FPS_DEFAULT);
+    plot->next_us = time_us_32();
+
+    oled_fill_rect(plot->x, plot->y, plot->width, plot->height, OLED_COLOR_DARK);
+}
+
+int plot_add_trace(struct plot_t *plot, oled_color_t color) {
+    if (plot->trace_count >= PLOT_TRACE_MAX) {
+        return -1;
+    }
+
+    plot->trace[plot->trace_count].color = color;
+    return plot->trace_count++;
+}
+
+bool plot_update(struct plot_t *plot, const float *values) {
+    const uint32_t now = time_us_32();
+    if ((int32_t)(now - plot->next_us) < 0) {
+        return false;
+    }
+    plot->next_us = now + plot->interval_us;
+
+    // 자동 범위 모드에서는 첫 샘플을 중심으로 범위를 잡는다.
+    if (plot->autoscale && plot->count == 0 && plot->trace_count > 0) {
+        plot->min = values[0] - 0.5f;
+        plot->max = values[0] + 0.5f;
+    }
+
+    // ring buffer에 샘플 기록
+    const uint index = plot->head;
+    bool rescale = false;
+    for (uint i = 0; i < plot->trace_count; i++) {
+        plot->trace[i].history[index] = values[i];
+
+        if (plot->autoscale && (values[i] < plot->min || values[i] > plot->max)) {
+            plot->min = MIN(plot->min, values[i]);
+            plot->max = MAX(plot->max, values[i]);
+            rescale = true;
+        }
+    }
+    plot->head = (plot->head + 1) % PLOT_HISTORY;
+    plot->count = MIN(plot->count + 1, PLOT_HISTORY);
+
+    // 범위가 바뀌면 이미 그려진 픽셀들이 무효하므로 전체를 다시 그린다.
+    if (rescale) {
+        plot_redraw(plot);
+        return true;
+    }
+
+    // 영역을 한 칸 밀고 가장 오른쪽 열에 새 샘플만 그린다.
+    oled_draw_begin();
+    oled_scroll_left(plot->x, plot->y, plot->width, plot->height, 1);
+    plot_draw_column(plot, plot->x + plot->width - 1, index, plot->count == 1);
+    oled_draw_end();
+
+    return true;
+}
+
+void plot_redraw(struct plot_t *plot) {
+    const uint shown = MIN(plot->count, (uint)plot->width);
+
+    oled_draw_begin();
+    oled_fill_rect(plot->x, plot->y, plot->width, plot->height, OLED_COLOR_DARK);
+    for (uint i = 0; i < shown; i++) {
+        const uint index = (plot->head + PLOT_HISTORY - shown + i) % PLOT_HISTORY;
+        plot_draw_column(plot, plot->x + plot->width - shown + i, index, i == 0);
+    }
+    oled_draw_end();
+}
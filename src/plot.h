@@ -0,0 +1,74 @@
+/**
+ * @file plot.h
+ * @brief 실시간 신호를 OLED에 흐르는 그래프(strip chart)로 그리는 위젯
+ *
+ * 매 프레임마다 그래프 영역을 왼쪽으로 한 픽셀 밀고, 가장 오른쪽 열에 새 샘플만 그린다.
+ * 미는 것은 framebuffer 안에서 하므로 OLED로는 매 프레임 그래프 영역 전체를 보낸다.
+ * (width * height * 2 바이트, 96x46이면 8.8 KB로 8 MHz SPI에서 약 8.8 ms) 그래서 기본 프레임 수를 30으로 둔다.
+ * 신호마다 최근 샘플들을 고정 크기의 ring buffer에 보관하므로, 표시 범위가 바뀌어 전체를 다시 그려야 할 때에도 이를 이용한다.
+ */
+
+#ifndef _PLOT_H_
+#define _PLOT_H_
+
+#include "pico/types.h"
+#include "config.h"
+#include "oled.h"
+
+struct plot_trace_t {
+    float history[PLOT_HISTORY]; // 최근 샘플들의 ring buffer
+    oled_color_t color;
+    int last_y; // 직전 샘플이 그려진 화면상의 y 좌표
+};
+
+struct plot_t {
+    int x, y, width, height; // 그래프 영역
+
+    /**
+     * @brief 표시 범위. 생성 시 min >= max로 주면 자동 범위 모드가 되어, 범위를 벗어난 샘플이 들어올 때 범위를 넓히고 다시 그린다.
+     */
+    float min, max;
+    bool autoscale;
+
+    uint32_t interval_us; // 프레임 주기
+    uint32_t next_us; // 다음 프레임을 그릴 시각
+
+    uint head; // 다음 샘플이 들어갈 ring buffer 위치
+    uint count; // ring buffer에 들어있는 샘플 수
+
+    uint trace_count;
+    struct plot_trace_t trace[PLOT_TRACE_MAX];
+};
+
+/**
+ * @brief 그래프를 초기화하고 영역을 지운다.
+ *
+ * @param plot 그래프
+ * @param x, y, width, height 그래프 영역 (width는 PLOT_HISTORY 이하)
+ * @param min, max 표시 범위 (min >= max이면 자동 범위)
+ * @param fps 초당 프레임 수, 0이면 PLOT_FPS_DEFAULT
+ */
+void plot_init(struct plot_t *plot, int x, int y, int width, int height, float min, float max, uint fps);
+
+/**
+ * @brief 그래프에 신호를 추가한다.
+ *
+ * @return int 추가된 신호의 번호, 더 추가할 수 없으면 -1
+ */
+int plot_add_trace(struct plot_t *plot, oled_color_t color);
+
+/**
+ * @brief 신호들의 새 샘플을 전달한다. 프레임 주기가 지났을 때에만 샘플을 기록하고 그래프를 한 칸 흘린다.
+ * 루프에서 매번 호출해도 된다.
+ *
+ * @param values 신호 번호 순서대로 정렬된 샘플 값들 (trace_count 개)
+ * @return bool 새 프레임을 그렸다면 true
+ */
+bool plot_update(struct plot_t *plot, const float *values);
+
+/**
+ * @brief ring buffer에 보관된 샘플들로 그래프 전체를 다시 그린다.
+ */
+void plot_redraw(struct plot_t *plot);
+
+#endif
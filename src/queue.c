@@ -0,0 +1,59 @@
+/**
+ * @file queue.c
+ * @brief lock-free SPSC 큐 구현
+ *
+ * Cortex-M0+에는 캐시가 없고 메모리 접근 순서가 프로그램 순서와 같지만, 컴파일러가 항목 복사와 인덱스 갱신의
+ * 순서를 바꿀 수 있고 다른 코어와의 순서도 보장되지 않으므로 hal_memory_barrier(DMB)를 둔다.
+ * head와 tail은 계속 증가하며, 위치는 capacity로 나눈 나머지(capacity - 1과의 AND)로 구한다.
+ */
+
+#include <string.h>
+
+#include "hal.h"
+#include "queue.h"
+
+bool HAL_ISR_FUNC(queue_push)(struct queue_t *queue, const void *item) {
+    const uint32_t head = queue->head;
+
+    if (head - queue->tail >= queue->capacity) {
+        queue->overflow++;
+        return false;
+    }
+
+    // tail을 읽은 후에 빈 자리에 쓴다. (consumer가 그 자리를 다 읽었음이 보장된다)
+    hal_memory_barrier();
+    memcpy(&queue->buffer[(head & (queue->capacity - 1)) * queue->item_size], item, queue->item_size);
+
+    // 항목 내용이 모두 기록된 후에 head를 옮긴다.
+    hal_memory_barrier();
+    queue->head = head + 1;
+
+    return true;
+}
+
+bool HAL_ISR_FUNC(queue_pop)(struct queue_t *queue, void *item) {
+    const uint32_t tail = queue->tail;
+
+    if (tail == queue->head) {
+        return false;
+    }
+
+    // head를 읽은 후에 항목 내용을 읽는다.
+    hal_memory_barrier();
+    memcpy(item, &queue->buffer[(tail & (queue->capacity - 1)) * queue->item_size], queue->item_size);
+
+    // 항목을 모두 읽은 후에 자리를 돌려준다.
+    hal_memory_barrier();
+    queue->tail = tail + 1;
+
+    return true;
+}
+
+uint queue_count(const struct queue_t *queue) {
+    return queue->head - queue->tail;
+}
+
+void queue_reset(struct queue_t *queue) {
+    queue->tail = queue->head;
+    queue->overflow = 0;
+}
@@ -0,0 +1,65 @@
+/**
+ * @file queue.h
+ * @brief 인터럽트 핸들러와 메인 루프(또는 두 코어) 사이에서 고정 크기 항목을 주고받는 lock-free SPSC 큐
+ *
+ * 넣는 쪽(producer)과 꺼내는 쪽(consumer)이 각각 하나일 때만 lock 없이 안전하다.
+ * producer는 head만, consumer는 tail만 바꾸며, 항목 내용과 인덱스 사이의 순서는 메모리 barrier로 보장한다.
+ * 같은 우선순위의 IRQ 핸들러들은 서로 끼어들지 않으므로 하나의 producer로 볼 수 있다.
+ *
+ *   QUEUE_DEFINE(events, struct mark_event_t, 16);
+ *   queue_push(&events, &event); // IRQ
+ *   while (queue_pop(&events, &event)) { ... } // 메인 루프
+ */
+
+#ifndef _QUEUE_H_
+#define _QUEUE_H_
+
+#include "pico/types.h"
+
+struct queue_t {
+    uint8_t *const buffer;
+    const uint item_size; // 항목 하나의 크기 (bytes)
+    const uint capacity; // 항목 수 (2의 거듭제곱)
+
+    volatile uint32_t head; // 다음에 넣을 위치. producer만 바꾼다.
+    volatile uint32_t tail; // 다음에 꺼낼 위치. consumer만 바꾼다.
+    volatile uint overflow; // 큐가 가득 차 버려진 항목 수. producer만 바꾼다.
+};
+
+/**
+ * @brief type 항목을 size개(2의 거듭제곱) 담는 큐 name을 정적으로 정의한다.
+ */
+#define QUEUE_DEFINE(name, type, size)                                                   \
+    _Static_assert(((size) & ((size)-1)) == 0, "queue size must be a power of 2");       \
+    static type name##_buffer[size];                                                     \
+    static struct queue_t name = {                                                       \
+        .buffer = (uint8_t *)name##_buffer,                                              \
+        .item_size = sizeof(type),                                                       \
+        .capacity = (size),                                                              \
+    }
+
+/**
+ * @brief [producer] 항목을 하나 넣는다. 인터럽트 핸들러에서 호출할 수 있다.
+ *
+ * @return 넣었으면 true, 큐가 가득 차 버렸으면 false (overflow가 1 증가한다)
+ */
+bool queue_push(struct queue_t *queue, const void *item);
+
+/**
+ * @brief [consumer] 가장 오래된 항목을 하나 꺼낸다.
+ *
+ * @return 꺼냈으면 true, 큐가 비어 있으면 false
+ */
+bool queue_pop(struct queue_t *queue, void *item);
+
+/**
+ * @brief 큐에 들어 있는 항목 수. 어느 쪽에서 불러도 되지만, 다른 쪽이 동작 중이면 곧 바뀔 수 있다.
+ */
+uint queue_count(const struct queue_t *queue);
+
+/**
+ * @brief 큐를 비우고 overflow를 0으로 되돌린다. producer가 멈춰 있을 때만 호출해야 한다.
+ */
+void queue_reset(struct queue_t *queue);
+
+#endif
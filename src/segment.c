@@ -0,0 +1,146 @@
+/**
+ * @file segment.c
+ * @brief 직선, 곡선 구간 분류 구현
+ *
+ * SEGMENT_SAMPLE_TICK마다 좌우 바퀴가 간 거리의 차이로 방향 변화를 구한다. (dθ = (dR - dL) / 바퀴 사이 거리)
+ * 같은 종류(곡선은 같은 방향)의 표본이 이어지면 한 구간으로 늘리고, 바뀌면 구간을 닫아 list에 넣는다.
+ * 라인을 따라가며 생기는 작은 흔들림으로 곡선 사이에 생기는 짧은 직선은 가속할 수 없으므로 앞의 곡선에 합치고,
+ * 직선 뒤에서 방향이 거의 바뀌지 않은 곡선은 앞의 직선에 합친다.
+ */
+
+#include <stdlib.h>
+#include <math.h>
+
+#include "segment.h"
+
+static struct {
+    int32_t left, right; // 현재 표본을 시작한 위치의 엔코더 값
+    struct segment_t open; // 아직 닫지 않은 구간
+    bool is_open;
+} builder;
+
+static inline bool segment_same_direction(float a, float b) {
+    return (a >= 0.0f) == (b >= 0.0f);
+}
+
+/**
+ * @brief 닫은 구간을 list에 넣는다. 앞 구간과 이어 붙일 수 있으면 합친다.
+ */
+static void segment_close(struct segment_list_t *list, struct segment_t segment) {
+    struct segment_t *const last = list->count ? &list->segment[list->count - 1] : NULL;
+
+    // 곡선 뒤의 짧은 직선은 곡선의 일부로 본다.
+    if (last && last->type == SEGMENT_CURVE && segment.type == SEGMENT_STRAIGHT &&
+        segment.end - segment.start < SEGMENT_STRAIGHT_MIN_TICK) {
+        segment.type = SEGMENT_CURVE;
+        segment.angle = 0.0f; // 흔들림이므로 곡선의 방향과 반지름에 반영하지 않는다.
+    }
+    // 반대로, 직선 뒤에서 방향이 거의 바뀌지 않은 곡선(크로스 등에서의 흔들림)은 직선의 일부로 본다.
+    if (last && last->type == SEGMENT_STRAIGHT && segment.type == SEGMENT_CURVE &&
+        fabsf(segment.angle) < SEGMENT_CURVE_MIN_ANGLE) {
+        segment.type = SEGMENT_STRAIGHT;
+    }
+
+    const bool is_mergeable = last && last->type == segment.type &&
+                              (segment.type == SEGMENT_STRAIGHT || segment.angle == 0.0f ||
+                               segment_same_direction(last->angle, segment.angle));
+
+    // list가 가득 차면 마지막 구간에 합친다. 곡선이 섞이면 가속하지 않도록 곡선으로 둔다.
+    if (is_mergeable || list->count == SEGMENT_COUNT_MAX) {
+        if (last->type != segment.type) {
+            last->type = SEGMENT_CURVE;
+        }
+        last->end = segment.end;
+        last->angle += segment.angle;
+        return;
+    }
+
+    list->segment[list->count++] = segment;
+}
+
+void segment_begin(struct segment_list_t *list) {
+    list->count = 0;
+    builder.left = 0;
+    builder.right = 0;
+    builder.is_open = false;
+}
+
+void segment_update(struct segment_list_t *list, int32_t left, int32_t right) {
+    const int32_t d_left = left - builder.left;
+    const int32_t d_right = right - builder.right;
+
+    if ((d_left + d_right) / 2 < SEGMENT_SAMPLE_TICK) {
+        return;
+    }
+
+    const float length_m = (d_left + d_right) / 2 / MOTOR_TICK_PER_METER;
+    const float angle = (d_right - d_left) / MOTOR_TICK_PER_METER / MOTOR_TRACK_WIDTH_M;
+    const enum segment_type_t type =
+        fabsf(angle) * SEGMENT_STRAIGHT_RADIUS_M < length_m ? SEGMENT_STRAIGHT : SEGMENT_CURVE;
+    const int32_t start = (builder.left + builder.right) / 2;
+    const int32_t end = (left + right) / 2;
+
+    builder.left = left;
+    builder.right = right;
+
+    if (builder.is_open && builder.open.type == type &&
+        (type == SEGMENT_STRAIGHT || segment_same_direction(builder.open.angle, angle))) {
+        builder.open.end = end;
+        builder.open.angle += angle;
+        return;
+    }
+
+    if (builder.is_open) {
+        segment_close(list, builder.open);
+    }
+    builder.open = (struct segment_t){ .type = type, .start = start, .end = end, .angle = angle };
+    builder.is_open = true;
+}
+
+void segment_end(struct segment_list_t *list) {
+    if (builder.is_open) {
+        segment_close(list, builder.open);
+        builder.is_open = false;
+    }
+}
+
+void segment_snap(struct segment_list_t *list, const enum mark_t *marks, const int32_t *ticks, uint count) {
+    for (uint i = 0; i + 1 < list->count; i++) {
+        struct segment_t *const before = &list->segment[i];
+        struct segment_t *const after = &list->segment[i + 1];
+
+        if (before->type == after->type) {
+            continue; // 방향이 바뀌는 곡선 사이의 경계는 마크가 없을 수 있으므로 옮기지 않는다.
+        }
+
+        int32_t best = before->end, best_error = SEGMENT_SNAP_TICK;
+        for (uint m = 0; m < count; m++) {
+            const int32_t error = abs(ticks[m] - before->end);
+            if ((marks[m] == MARK_LEFT || marks[m] == MARK_RIGHT) && error < best_error) {
+                best = ticks[m];
+                best_error = error;
+            }
+        }
+
+        // 옮긴 후에도 두 구간 모두 길이가 남아 있어야 한다.
+        if (before->start < best && best < after->end) {
+            before->end = after->start = best;
+        }
+    }
+}
+
+int segment_find(const struct segment_list_t *list, int32_t position, int hint) {
+    int i = hint < 0 ? 0 : hint;
+
+    if (i >= (int)list->count) {
+        i = list->count - 1;
+    }
+    while (i > 0 && position < list->segment[i].start) {
+        i--;
+    }
+    while (i < (int)list->count && list->segment[i].end <= position) {
+        i++;
+    }
+
+    return i < (int)list->count && position >= list->segment[i].start ? i : -1;
+}
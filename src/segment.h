@@ -0,0 +1,94 @@
+/**
+ * @file segment.h
+ * @brief 1차 주행의 좌우 엔코더 차이로 트랙을 직선, 곡선 구간으로 나누는 모듈
+ *
+ * 마크 쌍으로만 직선을 찾으면, 같은 마크 두 개로 둘러싸이지 않은 직선은 가속하지 못한다.
+ * 여기서는 마크 배치와 상관없이, 주행한 경로의 곡률로 모든 구간을 직선 또는 곡선(반지름 포함)으로 분류한다.
+ * 구간의 위치는 마크 맵과 같은 좌표(좌우 엔코더 절댓값의 평균, tick)이다.
+ *
+ *   segment_begin(&list); // 1차 주행 시작
+ *   segment_update(&list, left, right); // 메인 루프마다 (좌우 엔코더 절댓값)
+ *   segment_end(&list); // 주행 종료
+ *   segment_snap(&list, detected_mark, detected_tick, detected_mark_count); // 경계를 곡선 마크에 맞춘 뒤 flash에 저장한다.
+ */
+
+#ifndef _SEGMENT_H_
+#define _SEGMENT_H_
+
+#include "pico/types.h"
+#include "config.h"
+#include "mark.h"
+
+enum segment_type_t {
+    SEGMENT_STRAIGHT = 0,
+    SEGMENT_CURVE,
+};
+
+struct segment_t {
+    enum segment_type_t type;
+    int32_t start, end; // 구간의 시작, 끝 위치 (tick)
+    float angle; // 구간에서 방향이 바뀐 각도 (rad, 왼쪽으로 돌면 양수)
+};
+
+struct segment_list_t {
+    uint count;
+    struct segment_t segment[SEGMENT_COUNT_MAX];
+};
+
+/**
+ * @brief 구간의 길이 (m)
+ */
+static inline float segment_length_m(const struct segment_t *segment) {
+    return (segment->end - segment->start) / MOTOR_TICK_PER_METER;
+}
+
+/**
+ * @brief 구간의 평균 회전 반지름 (m, 왼쪽으로 돌면 양수). 방향이 바뀌지 않았으면 0을 반환한다.
+ */
+static inline float segment_radius_m(const struct segment_t *segment) {
+    return segment->angle != 0.0f ? segment_length_m(segment) / segment->angle : 0.0f;
+}
+
+/**
+ * @brief 구간의 평균 곡률 (1/m, 왼쪽으로 돌면 양수)
+ */
+static inline float segment_curvature(const struct segment_t *segment) {
+    const float length_m = segment_length_m(segment);
+    return length_m > 0.0f ? segment->angle / length_m : 0.0f;
+}
+
+/**
+ * @brief 구간 분류를 시작한다. list를 비우고, 현재 위치를 0으로 본다.
+ */
+void segment_begin(struct segment_list_t *list);
+
+/**
+ * @brief 현재 좌우 엔코더 값으로 분류를 진행한다. SEGMENT_SAMPLE_TICK을 지날 때마다 구간이 갱신된다.
+ *
+ * @param left 왼쪽 엔코더 절댓값 (tick)
+ * @param right 오른쪽 엔코더 절댓값 (tick)
+ */
+void segment_update(struct segment_list_t *list, int32_t left, int32_t right);
+
+/**
+ * @brief 분류를 마치고, 진행 중인 구간을 list에 넣는다.
+ */
+void segment_end(struct segment_list_t *list);
+
+/**
+ * @brief 직선과 곡선 사이의 경계를 SEGMENT_SNAP_TICK 안에 있는 가장 가까운 곡선 마크(왼쪽, 오른쪽)의 위치로 옮긴다.
+ * 엔코더 차이로 찾은 경계는 표본 길이만큼 어긋나고, 곡선을 나온 뒤 방향이 안정될 때까지 늦어진다.
+ * 곡선 마크는 곡선의 시작과 끝에 놓이므로 더 정확하다. 근처에 마크가 없으면 경계를 그대로 둔다.
+ *
+ * @param marks, ticks, count 1차 주행에서 본 마크와 그 위치 (tick)
+ */
+void segment_snap(struct segment_list_t *list, const enum mark_t *marks, const int32_t *ticks, uint count);
+
+/**
+ * @brief position이 속한 구간의 인덱스를 찾는다. 위치는 점점 커지므로 이전 결과를 hint로 주면 거기서부터 찾는다.
+ *
+ * @return 구간 인덱스, list의 범위를 벗어나면 -1
+ */
+int segment_find(const struct segment_list_t *list, int32_t position, int hint);
+
+#endif
@@ -1,32 +1,27 @@
 #include <stdlib.h>
 
-#include "hardware/gpio.h"
-#include "hardware/adc.h"
-#include "hardware/sync.h"
-#include "hardware/timer.h"
-
+#include "hal.h"
 #include "sensing.h"
+#include "bench.h"
 #include "timer.h"
+#include "telemetry.h"
+#include "event.h"
 #include "fs.h"
 
 void sensing_init(void) {
     // ADC Block 초기화
-    adc_init();
+    hal_adc_init();
 
     // 전압 측정, IR 수광 센서 측정을 위해 해당 GPIO를 ADC 기능으로 초기화
-    adc_gpio_init(SENSING_VOLTAGE_GPIO);
-    adc_gpio_init(SENSING_IR_MUX_GPIO_IN_A);
-    adc_gpio_init(SENSING_IR_MUX_GPIO_IN_B);
+    hal_adc_gpio_init(SENSING_VOLTAGE_GPIO);
+    hal_adc_gpio_init(SENSING_IR_MUX_GPIO_IN_A);
+    hal_adc_gpio_init(SENSING_IR_MUX_GPIO_IN_B);
 
     // IR 센서부 GPIO 초기화
-    gpio_init(SENSING_IR_MUX_GPIO_SEL0);
-    gpio_set_dir(SENSING_IR_MUX_GPIO_SEL0, GPIO_OUT);
-    gpio_init(SENSING_IR_MUX_GPIO_SEL1);
-    gpio_set_dir(SENSING_IR_MUX_GPIO_SEL1, GPIO_OUT);
-    gpio_init(SENSING_IR_MUX_GPIO_SEL2);
-    gpio_set_dir(SENSING_IR_MUX_GPIO_SEL2, GPIO_OUT);
-    gpio_init(SENSING_IR_MUX_GPIO_OUT);
-    gpio_set_dir(SENSING_IR_MUX_GPIO_OUT, GPIO_OUT);
+    hal_gpio_init_output(SENSING_IR_MUX_GPIO_SEL0);
+    hal_gpio_init_output(SENSING_IR_MUX_GPIO_SEL1);
+    hal_gpio_init_output(SENSING_IR_MUX_GPIO_SEL2);
+    hal_gpio_init_output(SENSING_IR_MUX_GPIO_OUT);
 
 #if FLASH_LOAD_DEFAULT
     struct fs_data_t *fs = fs_get_data();
@@ -45,7 +40,7 @@ void sensing_init(void) {
  * @param channel 0(GPIO 26), 1(GPIO 27), 2(GPIO 28) 중 하나의 값
  * @return 해당 채널에서 아날로그-디지털 변환한 데이터
  */
-static uint sensing_get_adc_data(uint channel) {
+static uint HAL_ISR_FUNC(sensing_get_adc_data)(uint channel) {
     uint data[3];
     uint status;
 
@@ -65,20 +60,17 @@ static uint sensing_get_adc_data(uint channel) {
      *  -> 반복문 속에 있는 분기문 및 여러 연산자로 인해 생기는 클럭 소모를 없애기 위해서이다.
      */
 
-    status = save_and_disable_interrupts();
-    adc_select_input(channel);
-    data[0] = adc_read();
-    restore_interrupts(status);
+    status = hal_irq_save();
+    data[0] = hal_adc_read(channel);
+    hal_irq_restore(status);
 
-    status = save_and_disable_interrupts();
-    adc_select_input(channel);
-    data[1] = adc_read();
-    restore_interrupts(status);
+    status = hal_irq_save();
+    data[1] = hal_adc_read(channel);
+    hal_irq_restore(status);
 
-    status = save_and_disable_interrupts();
-    adc_select_input(channel);
-    data[2] = adc_read();
-    restore_interrupts(status);
+    status = hal_irq_save();
+    data[2] = hal_adc_read(channel);
+    hal_irq_restore(status);
 
     /*
      * 위에서 구한 총 3개의 ADC 결과를 오름차순으로 정렬한다.
@@ -111,10 +103,21 @@ volatile float sensing_supply_voltage;
 
 /**
  * @brief 전압 센싱을 한 후 실제 전압으로 바꾸어 전역 변수에 저장(갱신)한다.
+ * 전압이 SENSING_LOW_VOLTAGE 아래로 떨어지면 EVENT_LOW_VOLTAGE를 한 번 보낸다.
  */
 static inline void sensing_update_voltage(void) {
-    sensing_supply_voltage = SENSING_EXPR_RAW_TO_VOLTAGE(
+    static bool low_voltage = false;
+
+    const float voltage = SENSING_EXPR_RAW_TO_VOLTAGE(
         sensing_get_adc_data(GET_ADC_CHANNEL(SENSING_VOLTAGE_GPIO)));
+    sensing_supply_voltage = voltage;
+
+    if (!low_voltage && voltage < SENSING_LOW_VOLTAGE) {
+        low_voltage = true;
+        event_push(EVENT_LOW_VOLTAGE, voltage * 1000);
+    } else if (low_voltage && voltage > SENSING_LOW_VOLTAGE + SENSING_LOW_VOLTAGE_HYSTERESIS) {
+        low_voltage = false;
+    }
 }
 
 volatile int sensing_ir_bias[SENSING_IR_COUNT];
@@ -187,8 +190,36 @@ static inline void sensing_calc_position(void) {
     }
 }
 
-static float limiter_delta_in = 20.0f;
-static float limiter_delta_out = 10.0f;
+volatile float sensing_ir_position_rate;
+
+// 직전 frame의 position과 시각 (sensing_calc_position_rate)
+static struct {
+    int position;
+    uint32_t time_us;
+    bool is_valid;
+} ir_frame;
+
+/**
+ * @brief frame이 끝날 때마다 position의 변화율을 구한다.
+ * 측정을 막 시작했거나 frame이 밀렸으면(SENSING_IR_FRAME_TIMEOUT_US) 시간 간격을 믿을 수 없으므로 변화율을 0으로 둔다.
+ */
+static inline void sensing_calc_position_rate(void) {
+    const uint32_t now_us = hal_time_us_32();
+    const uint32_t dt_us = now_us - ir_frame.time_us;
+
+    if (ir_frame.is_valid && dt_us > 0 && dt_us < SENSING_IR_FRAME_TIMEOUT_US) {
+        sensing_ir_position_rate = (sensing_ir_position - ir_frame.position) * 1e6f / dt_us;
+    } else {
+        sensing_ir_position_rate = 0.0f;
+    }
+
+    ir_frame.position = sensing_ir_position;
+    ir_frame.time_us = now_us;
+    ir_frame.is_valid = true;
+}
+
+volatile float sensing_ir_limiter_delta_in = 20.0f;
+volatile float sensing_ir_limiter_delta_out = 10.0f;
 
 /**
  * @brief 곡선 감속 시, 진입할 때는 빠르게 감속하지만, 빠져나올 떄에 서서히 원래 속도로 돌아오게 만들기 위해 아래의 기능을 추가한다.
@@ -198,14 +229,14 @@ static inline void sensing_calc_position_limited(void) {
 
     if (sensing_ir_position_limited < position) {
         // 곡선에 진입할 때, limiter_delta_in 만큼 증가시키면서 position에 대한 accel 구현
-        sensing_ir_position_limited += limiter_delta_in;
+        sensing_ir_position_limited += sensing_ir_limiter_delta_in;
 
         if (sensing_ir_position_limited > position) {
             sensing_ir_position_limited = position;
         }
     } else {
         // 곡선에서 나올 때, limiter_delta_out 만큼 감소시키면서 position에 대한 decel 구현
-        sensing_ir_position_limited -= limiter_delta_out;
+        sensing_ir_position_limited -= sensing_ir_limiter_delta_out;
 
         if (sensing_ir_position_limited < position) {
             sensing_ir_position_limited = position;
@@ -236,15 +267,15 @@ static inline void sensing_update_ir(void) {
     static uint i = 0;
 
     // MUX를 이용하여 IR 발광 및 수광 센서 선택
-    gpio_clr_mask(ir_mask);
-    gpio_set_mask(ir_order[i]);
+    hal_gpio_clr_mask(ir_mask);
+    hal_gpio_set_mask(ir_order[i]);
 
-    gpio_put(SENSING_IR_MUX_GPIO_OUT, 1); // IR 발광센서 켜기
-    busy_wait_us_32(8); // 발광 센서 안정화
+    hal_gpio_put(SENSING_IR_MUX_GPIO_OUT, 1); // IR 발광센서 켜기
+    hal_busy_wait_us(8); // 발광 센서 안정화
     // 두 개의 MUX로부터 ADC 값을 가져옴
     int raw_l = sensing_get_adc_data(GET_ADC_CHANNEL(SENSING_IR_MUX_GPIO_IN_A)) >> 4;
     int raw_r = sensing_get_adc_data(GET_ADC_CHANNEL(SENSING_IR_MUX_GPIO_IN_B)) >> 4;
-    gpio_put(SENSING_IR_MUX_GPIO_OUT, 0); // IR 발광센서 끄기
+    hal_gpio_put(SENSING_IR_MUX_GPIO_OUT, 0); // IR 발광센서 끄기
 
     // raw
     sensing_ir_raw[i] = raw_l;
@@ -267,21 +298,66 @@ static inline void sensing_update_ir(void) {
     // limited position
     sensing_calc_position_limited();
 
+    // position rate: 마지막 센서 쌍까지 갱신되어 frame이 끝났을 때
+    if (i == 0x07) {
+        sensing_calc_position_rate();
+    }
+
     i = (i + 1) & 0x07;
 }
 
+// IR 센서 값이 갱신될 때마다 호출되는 함수 (sensing_set_frame_handler)
+static void (*volatile frame_handler)(void) = NULL;
+
 /**
  * @brief `sensing.c` 전용 타이머 IRQ 핸들러
  */
-static void sensing_handler(void) {
+static void HAL_ISR_FUNC(sensing_handler)(void) {
     sensing_update_voltage();
     sensing_update_ir();
+
+    void (*const handler)(void) = frame_handler;
+    if (handler) {
+        handler();
+    }
+
+    if (telemetry_streams & TELEMETRY_STREAM_SENSING) {
+        struct telemetry_sensing_t frame = {
+            .time_us = hal_time_us_32(),
+            .ir_state = sensing_ir_state,
+            .position = sensing_ir_position,
+            .position_limited = sensing_ir_position_limited,
+            .voltage_mv = sensing_supply_voltage * 1000,
+        };
+        for (int i = 0; i < SENSING_IR_COUNT; i++) {
+            frame.normalized[i] = sensing_ir_normalized[i];
+        }
+        telemetry_push(TELEMETRY_FRAME_SENSING, &frame, sizeof(frame));
+    }
+}
+
+int sensing_bench_normalize_ir(int raw, int bias, int range) {
+    return sensing_normalize_ir(raw, bias, range);
+}
+
+void sensing_bench_calc_position(void) {
+    sensing_calc_position();
+}
+
+void sensing_bench_calc_position_limited(void) {
+    sensing_calc_position_limited();
 }
 
 void sensing_start(void) {
+    ir_frame.is_valid = false;
+    sensing_ir_position_rate = 0.0f;
     timer_periodic_start(SENSING_TIMER_SLOT, SENSING_TIMER_INTERVAL_US, sensing_handler);
 }
 
 void sensing_stop(void) {
     timer_periodic_stop(SENSING_TIMER_SLOT);
 }
+
+void sensing_set_frame_handler(void (*handler)(void)) {
+    frame_handler = handler;
+}
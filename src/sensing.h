@@ -59,6 +59,23 @@ extern volatile int sensing_ir_position;
  */
 extern volatile int sensing_ir_position_limited;
 
+/**
+ * @brief [READ ONLY] position의 변화율 (1/s). 양수이면 라인이 센서 보드의 오른쪽으로 움직이고 있다.
+ * 한 주기에는 센서 두 개만 갱신되므로, 모든 센서가 한 번씩 갱신될 때(frame, SENSING_IR_FRAME_US)마다
+ * 직전 frame의 position과 그 시각으로부터 구한다.
+ */
+extern volatile float sensing_ir_position_rate;
+
+/**
+ * @brief position limiter가 곡선에 진입할 때 한 주기마다 증가하는 양
+ */
+extern volatile float sensing_ir_limiter_delta_in;
+
+/**
+ * @brief position limiter가 곡선에서 빠져나올 때 한 주기마다 감소하는 양
+ */
+extern volatile float sensing_ir_limiter_delta_out;
+
 /**
  * @brief 전압 및 IR 센서의 정보를 ADC로부터 가져오고 가공할 준비를 하는 초기화 함수
  */
@@ -74,4 +91,12 @@ void sensing_start(void);
  */
 void sensing_stop(void);
 
+/**
+ * @brief 센싱 주기마다 IR 센서 값이 갱신된 직후 호출할 함수를 등록한다. (센싱 IRQ 핸들러 안에서 호출된다)
+ * 마크 state machine처럼 새 센서 값을 하나도 놓치지 않아야 하는 처리에 사용한다.
+ *
+ * @param handler 등록할 함수. NULL이면 등록을 해제한다.
+ */
+void sensing_set_frame_handler(void (*handler)(void));
+
 #endif
\ No newline at end of file
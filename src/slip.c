@@ -0,0 +1,101 @@
+/**
+ * @file slip.c
+ * @brief 바퀴 슬립 추정 구현
+ *
+ * 매 주기의 증가량은 엔코더 분해능과 위치 제어의 흔들림 때문에 잡음이 크므로, 종방향 비율은
+ * SLIP_FILTER로 걸러 몇 주기 이상 이어지는 차이만 슬립으로 본다. 횡방향은 적분하므로 따로 거르지 않는다.
+ */
+
+#include <stdlib.h>
+#include <math.h>
+
+#include "slip.h"
+#include "hal.h"
+
+volatile struct slip_state_t slip_state;
+
+static struct {
+    int32_t target[MOTOR_COUNT], current[MOTOR_COUNT]; // 직전 주기의 목표, 엔코더 위치
+    float angle; // 맵 곡률보다 더 돈 각도 (rad, leaky integral)
+    float angle_ir; // 라인이 바깥으로 밀려나는 동안 트랙 최대 곡률보다 더 돈 각도 (rad, leaky integral)
+    bool is_started;
+} history;
+
+void slip_reset(void) {
+    slip_state = (struct slip_state_t){ 0 };
+    history.angle = 0.0f;
+    history.angle_ir = 0.0f;
+    history.is_started = false;
+}
+
+bool HAL_ISR_FUNC(slip_update)(const struct motor_control_state_t *left, const struct motor_control_state_t *right,
+                               float curvature, bool is_curvature_known, int position, float position_rate) {
+    static const float dt_s = (float)MOTOR_CONTROL_INTERVAL_US / (1000 * 1000);
+
+    // 앞으로 가는 방향이 양수가 되도록 한다. (왼쪽 모터는 목표 값이 감소하는 방향이 전진)
+    const int32_t target_left = history.target[MOTOR_LEFT] - left->target;
+    const int32_t target_right = right->target - history.target[MOTOR_RIGHT];
+    const int32_t current_left = history.current[MOTOR_LEFT] - left->current;
+    const int32_t current_right = right->current - history.current[MOTOR_RIGHT];
+    const bool is_started = history.is_started;
+
+    history.target[MOTOR_LEFT] = left->target;
+    history.target[MOTOR_RIGHT] = right->target;
+    history.current[MOTOR_LEFT] = left->current;
+    history.current[MOTOR_RIGHT] = right->current;
+    history.is_started = true;
+
+    if (!is_started) {
+        return false;
+    }
+
+    /*
+     * 종방향: 지령 증가량과 엔코더 증가량의 차이. 미끄러지는 바퀴는 가벼워 위치 제어가 흔들리므로 좌우 중 큰 쪽을 본다.
+     * 거의 멈춰 있을 때 비율이 커지지 않도록 분모에 하한을 둔다.
+     */
+    const float commanded =
+        fmaxf((abs(target_left) + abs(target_right)) / 2.0f, SLIP_MIN_VELOCITY * MOTOR_TICK_PER_METER * dt_s);
+    const float mismatch =
+        fmaxf(abs(target_left - current_left), abs(target_right - current_right)) / commanded;
+
+    /*
+     * 횡방향: 옆으로 미끄러지면 엔코더로 잰 회전 속도만큼 실제로 돌지 못한다. 곡선 방향으로 맵 곡률의 회전 속도를 넘는
+     * 양을 적분하면, 라인을 다시 따라잡기 위해 잠깐 더 도는 것은 작은 각도에서 끝나지만 미끄러지는 동안에는 계속 쌓인다.
+     * 곡선 구간 경계에서의 위치 오차가 쌓이지 않도록 SLIP_LATERAL_LEAK_S의 시상수로 새어 나가게 한다.
+     */
+    const float v = (current_left + current_right) / 2.0f / MOTOR_TICK_PER_METER / dt_s;
+    const float yaw = (current_right - current_left) / MOTOR_TICK_PER_METER / MOTOR_TRACK_WIDTH_M / dt_s;
+    const float excess =
+        is_curvature_known && curvature != 0.0f ? (yaw - v * curvature) * copysignf(1.0f, curvature) : 0.0f;
+
+    history.angle += (excess - history.angle / SLIP_LATERAL_LEAK_S) * dt_s;
+
+    /*
+     * 맵이 없을 때(1차 주행, 맵을 잃었을 때)는 IR position 변화율로 본다. 엔코더로 잰 경로가 트랙의 어떤 곡선보다도
+     * 급한데(SLIP_TRACK_CURVATURE_MAX) 라인이 여전히 도는 쪽 바깥으로 밀려나고 있다면, 그만큼 실제로 돌지 못한 것이다.
+     * 라인을 되찾으며 잠깐 급하게 도는 경우에는 라인이 안쪽으로 돌아오므로 쌓이지 않는다.
+     */
+    const bool is_drifting = yaw * position > 0 && yaw * position_rate > 0;
+    const float excess_ir = is_drifting ? fabsf(yaw) - fabsf(v) * SLIP_TRACK_CURVATURE_MAX : 0.0f;
+
+    history.angle_ir += (fmaxf(excess_ir, 0.0f) - history.angle_ir / SLIP_LATERAL_LEAK_S) * dt_s;
+    const float lateral = fmaxf(fmaxf(history.angle, history.angle_ir), 0.0f);
+
+    slip_state.longitudinal += SLIP_FILTER * (mismatch - slip_state.longitudinal);
+    slip_state.lateral = lateral;
+    slip_state.level =
+        fmaxf(slip_state.longitudinal / SLIP_LONGITUDINAL_RATIO, slip_state.lateral / SLIP_LATERAL_ANGLE);
+
+    const uint32_t now_us = hal_time_us_32();
+    if (slip_state.level >= 1.0f) {
+        const bool is_new = !slip_state.is_detected;
+        slip_state.detected_us = now_us;
+        slip_state.is_detected = true;
+        return is_new;
+    }
+    if (slip_state.is_detected && now_us - slip_state.detected_us > SLIP_HOLD_US) {
+        slip_state.is_detected = false;
+    }
+
+    return false;
+}
@@ -0,0 +1,63 @@
+/**
+ * @file slip.h
+ * @brief 바퀴 슬립 추정 모듈
+ *
+ * 가감속도가 바퀴의 접지력을 넘으면 바퀴가 미끄러진다. 여기서는 모터 제어 주기마다 두 가지로 슬립을 추정한다.
+ * - 종방향: 미끄러지는 바퀴는 로봇을 끌지 않으므로 지령보다 빠르게 돌거나 멈춘다.
+ *   지령 위치(target)의 증가량과 엔코더 위치(current)의 증가량의 차이를 지령 증가량에 대한 비율로 본다.
+ * - 횡방향: 곡선에서 옆으로 미끄러지면, 좌우 엔코더 차이로 잰 만큼 실제로 돌지 못한다.
+ *   엔코더 회전 속도가 맵 곡률로 구한 회전 속도를 넘는 양을 적분하여, 맵보다 더 돈 각도를 본다.
+ *   맵이 없으면 IR position 변화율로, 라인이 바깥으로 밀려나는 동안 트랙 최대 곡률보다 더 돈 각도를 본다.
+ * 두 값을 각각의 한계(SLIP_LONGITUDINAL_RATIO, SLIP_LATERAL_ANGLE)로 나누어 슬립 정도(level)로 합친다.
+ * level이 1 이상이면 미끄러지는 것으로 본다.
+ *
+ *   slip_reset(); // 주행 시작
+ *   slip_update(&left, &right, curvature, is_curvature_known, position, position_rate); // 모터 제어 주기마다 (IRQ)
+ *   if (slip_is_detected()) { ... } // 가감속도 제한
+ */
+
+#ifndef _SLIP_H_
+#define _SLIP_H_
+
+#include "pico/types.h"
+#include "config.h"
+#include "motor.h"
+
+struct slip_state_t {
+    float longitudinal; // 지령 증가량에 대한 엔코더 증가량 차이의 비율 (filtered)
+    float lateral; // 곡선에서 엔코더로 잰 회전이 맵 곡률(맵이 없으면 트랙 최대 곡률)보다 더 돈 각도 (rad)
+    float level; // 슬립 정도 (1 이상이면 슬립)
+    uint32_t detected_us; // 마지막으로 level이 1 이상이었던 시각
+    bool is_detected; // SLIP_HOLD_US 동안 유지된다.
+};
+
+/**
+ * @brief [READ ONLY] 현재 슬립 추정 상태
+ */
+extern volatile struct slip_state_t slip_state;
+
+/**
+ * @brief 추정 상태를 초기화한다. 모터 제어를 시작하기 전에 호출한다.
+ */
+void slip_reset(void);
+
+/**
+ * @brief [IRQ] 모터 제어 주기마다 호출하여 슬립을 추정한다.
+ *
+ * @param left, right 목표 위치를 갱신한 직후의 모터 제어 상태 (motor_get_control_state)
+ * @param curvature 현재 위치의 맵 곡률 (1/m, 왼쪽으로 돌면 양수)
+ * @param is_curvature_known 맵이 없어 곡률을 모르면 false. 이때는 맵 곡률로 횡방향 슬립을 추정하지 않는다.
+ * @param position, position_rate IR position과 그 변화율 (sensing_ir_position, sensing_ir_position_rate)
+ * @return 슬립을 새로 감지했으면(SLIP_HOLD_US가 지난 뒤 처음) true
+ */
+bool slip_update(const struct motor_control_state_t *left, const struct motor_control_state_t *right, float curvature,
+                 bool is_curvature_known, int position, float position_rate);
+
+/**
+ * @brief 마지막으로 슬립을 감지한 후 SLIP_HOLD_US가 지나지 않았으면 true
+ */
+static inline bool slip_is_detected(void) {
+    return slip_state.is_detected;
+}
+
+#endif
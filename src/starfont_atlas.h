@@ -0,0 +1,180 @@
+/*
+ * starfont_atlas.h
+ * tools/gen_starfont_atlas.py에 의해 starfont.h로부터 생성된 파일이다. 직접 수정하지 않는다.
+ */
+
+#ifndef _STARFONT_ATLAS_H_
+#define _STARFONT_ATLAS_H_
+
+#include <stdint.h>
+
+// ASCII Code Character(5*8) [HORIZONTAL ORDER]
+// 각 행의 i번째 비트가 i번째 열(왼쪽부터)의 픽셀을 나타낸다.
+static const uint8_t STARFONT_ATLAS_ROWS[128][8] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x0a, 0x00, 0x11, 0x0e, 0x00, 0x00 },
+    { 0x00, 0x00, 0x0a, 0x00, 0x0e, 0x11, 0x00, 0x00 },
+    { 0x00, 0x0a, 0x1f, 0x1f, 0x0e, 0x04, 0x00, 0x00 },
+    { 0x00, 0x04, 0x0e, 0x1f, 0x0e, 0x04, 0x00, 0x00 },
+    { 0x00, 0x0e, 0x0e, 0x1f, 0x1f, 0x04, 0x0e, 0x00 },
+    { 0x00, 0x04, 0x0e, 0x1f, 0x1f, 0x04, 0x0e, 0x00 },
+    { 0x00, 0x00, 0x0e, 0x0e, 0x0e, 0x00, 0x00, 0x00 },
+    { 0x00, 0x1f, 0x11, 0x11, 0x11, 0x1f, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x1c, 0x18, 0x14, 0x06, 0x09, 0x09, 0x06, 0x00 },
+    { 0x0e, 0x11, 0x0e, 0x04, 0x1f, 0x04, 0x04, 0x00 },
+    { 0x04, 0x0c, 0x14, 0x14, 0x06, 0x07, 0x02, 0x00 },
+    { 0x1e, 0x12, 0x1e, 0x12, 0x1a, 0x1b, 0x03, 0x00 },
+    { 0x00, 0x15, 0x0e, 0x1b, 0x0e, 0x15, 0x00, 0x00 },
+    { 0x00, 0x03, 0x0f, 0x1f, 0x0f, 0x03, 0x00, 0x00 },
+    { 0x00, 0x18, 0x1e, 0x1f, 0x1e, 0x18, 0x00, 0x00 },
+    { 0x04, 0x0e, 0x15, 0x04, 0x15, 0x0e, 0x04, 0x00 },
+    { 0x0a, 0x0a, 0x0a, 0x0a, 0x0a, 0x00, 0x0a, 0x00 },
+    { 0x16, 0x15, 0x16, 0x14, 0x14, 0x14, 0x14, 0x00 },
+    { 0x0e, 0x02, 0x0c, 0x0a, 0x06, 0x08, 0x0e, 0x00 },
+    { 0x00, 0x00, 0x00, 0x0e, 0x00, 0x00, 0x00, 0x00 },
+    { 0x04, 0x0e, 0x15, 0x04, 0x04, 0x04, 0x04, 0x00 },
+    { 0x00, 0x04, 0x0e, 0x15, 0x04, 0x04, 0x00, 0x00 },
+    { 0x00, 0x04, 0x04, 0x15, 0x0e, 0x04, 0x00, 0x00 },
+    { 0x00, 0x04, 0x08, 0x1f, 0x08, 0x04, 0x00, 0x00 },
+    { 0x00, 0x04, 0x02, 0x1f, 0x02, 0x04, 0x00, 0x00 },
+    { 0x04, 0x04, 0x04, 0x04, 0x15, 0x0e, 0x04, 0x00 },
+    { 0x00, 0x0a, 0x15, 0x11, 0x0a, 0x04, 0x00, 0x00 },
+    { 0x00, 0x04, 0x0e, 0x0e, 0x1f, 0x1f, 0x00, 0x00 },
+    { 0x00, 0x1f, 0x1f, 0x0e, 0x0e, 0x04, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04, 0x00 },
+    { 0x0a, 0x0a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x0a, 0x1f, 0x0a, 0x1f, 0x0a, 0x00, 0x00 },
+    { 0x0e, 0x15, 0x05, 0x0e, 0x14, 0x15, 0x0e, 0x00 },
+    { 0x00, 0x11, 0x08, 0x04, 0x02, 0x11, 0x00, 0x00 },
+    { 0x0e, 0x0a, 0x06, 0x02, 0x0d, 0x11, 0x0e, 0x00 },
+    { 0x04, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x08, 0x04, 0x04, 0x04, 0x04, 0x04, 0x08, 0x00 },
+    { 0x02, 0x04, 0x04, 0x04, 0x04, 0x04, 0x02, 0x00 },
+    { 0x00, 0x15, 0x0e, 0x1f, 0x0e, 0x15, 0x00, 0x00 },
+    { 0x00, 0x04, 0x04, 0x1f, 0x04, 0x04, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x02 },
+    { 0x00, 0x00, 0x00, 0x1f, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00 },
+    { 0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00, 0x00 },
+    { 0x0e, 0x11, 0x19, 0x15, 0x13, 0x11, 0x0e, 0x00 },
+    { 0x04, 0x06, 0x04, 0x04, 0x04, 0x04, 0x0e, 0x00 },
+    { 0x0e, 0x11, 0x10, 0x08, 0x04, 0x02, 0x1f, 0x00 },
+    { 0x0e, 0x11, 0x10, 0x0c, 0x10, 0x11, 0x0e, 0x00 },
+    { 0x08, 0x0c, 0x0a, 0x09, 0x1f, 0x08, 0x08, 0x00 },
+    { 0x1f, 0x01, 0x0f, 0x10, 0x10, 0x11, 0x0e, 0x00 },
+    { 0x0e, 0x11, 0x01, 0x0f, 0x11, 0x11, 0x0e, 0x00 },
+    { 0x1f, 0x10, 0x10, 0x08, 0x04, 0x04, 0x04, 0x00 },
+    { 0x0e, 0x11, 0x11, 0x0e, 0x11, 0x11, 0x0e, 0x00 },
+    { 0x0e, 0x11, 0x11, 0x1e, 0x10, 0x11, 0x0e, 0x00 },
+    { 0x00, 0x04, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00 },
+    { 0x00, 0x04, 0x00, 0x00, 0x00, 0x04, 0x04, 0x00 },
+    { 0x00, 0x10, 0x08, 0x04, 0x08, 0x10, 0x00, 0x00 },
+    { 0x00, 0x00, 0x1f, 0x00, 0x1f, 0x00, 0x00, 0x00 },
+    { 0x00, 0x01, 0x02, 0x04, 0x02, 0x01, 0x00, 0x00 },
+    { 0x0e, 0x11, 0x10, 0x08, 0x04, 0x00, 0x04, 0x00 },
+    { 0x0e, 0x11, 0x1d, 0x15, 0x1d, 0x01, 0x1e, 0x00 },
+    { 0x0e, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11, 0x00 },
+    { 0x0f, 0x11, 0x11, 0x0f, 0x11, 0x11, 0x0f, 0x00 },
+    { 0x0e, 0x11, 0x01, 0x01, 0x01, 0x11, 0x0e, 0x00 },
+    { 0x07, 0x09, 0x11, 0x11, 0x11, 0x09, 0x07, 0x00 },
+    { 0x1f, 0x01, 0x01, 0x0f, 0x01, 0x01, 0x1f, 0x00 },
+    { 0x1f, 0x01, 0x01, 0x0f, 0x01, 0x01, 0x01, 0x00 },
+    { 0x0e, 0x11, 0x01, 0x19, 0x11, 0x11, 0x0e, 0x00 },
+    { 0x11, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11, 0x00 },
+    { 0x0e, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e, 0x00 },
+    { 0x0e, 0x04, 0x04, 0x04, 0x04, 0x04, 0x02, 0x00 },
+    { 0x11, 0x09, 0x05, 0x03, 0x05, 0x09, 0x11, 0x00 },
+    { 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x1f, 0x00 },
+    { 0x11, 0x1b, 0x15, 0x11, 0x11, 0x11, 0x11, 0x00 },
+    { 0x11, 0x11, 0x13, 0x15, 0x19, 0x11, 0x11, 0x00 },
+    { 0x0e, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e, 0x00 },
+    { 0x0f, 0x11, 0x11, 0x0f, 0x01, 0x01, 0x01, 0x00 },
+    { 0x0e, 0x11, 0x11, 0x11, 0x11, 0x0e, 0x18, 0x00 },
+    { 0x0f, 0x11, 0x11, 0x0f, 0x05, 0x09, 0x11, 0x00 },
+    { 0x0e, 0x11, 0x01, 0x0e, 0x10, 0x11, 0x0e, 0x00 },
+    { 0x1f, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00 },
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e, 0x00 },
+    { 0x11, 0x11, 0x11, 0x11, 0x0a, 0x0a, 0x04, 0x00 },
+    { 0x11, 0x11, 0x11, 0x11, 0x15, 0x1b, 0x11, 0x00 },
+    { 0x11, 0x11, 0x0a, 0x04, 0x0a, 0x11, 0x11, 0x00 },
+    { 0x11, 0x11, 0x0a, 0x04, 0x04, 0x04, 0x04, 0x00 },
+    { 0x1f, 0x10, 0x08, 0x04, 0x02, 0x01, 0x1f, 0x00 },
+    { 0x0c, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0c, 0x00 },
+    { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00, 0x00 },
+    { 0x06, 0x04, 0x04, 0x04, 0x04, 0x04, 0x06, 0x00 },
+    { 0x04, 0x0a, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x00 },
+    { 0x04, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x0e, 0x10, 0x1e, 0x11, 0x1e, 0x00 },
+    { 0x01, 0x01, 0x0f, 0x11, 0x11, 0x11, 0x0f, 0x00 },
+    { 0x00, 0x00, 0x0e, 0x11, 0x01, 0x11, 0x0e, 0x00 },
+    { 0x10, 0x10, 0x1e, 0x11, 0x11, 0x11, 0x1e, 0x00 },
+    { 0x00, 0x00, 0x0e, 0x11, 0x1f, 0x01, 0x0e, 0x00 },
+    { 0x08, 0x04, 0x04, 0x0e, 0x04, 0x04, 0x04, 0x00 },
+    { 0x00, 0x00, 0x1e, 0x11, 0x11, 0x1e, 0x10, 0x0f },
+    { 0x01, 0x01, 0x0f, 0x11, 0x11, 0x11, 0x11, 0x00 },
+    { 0x04, 0x00, 0x06, 0x04, 0x04, 0x04, 0x0e, 0x00 },
+    { 0x04, 0x00, 0x06, 0x04, 0x04, 0x04, 0x04, 0x02 },
+    { 0x01, 0x01, 0x01, 0x05, 0x03, 0x05, 0x09, 0x00 },
+    { 0x06, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e, 0x00 },
+    { 0x00, 0x00, 0x0b, 0x15, 0x15, 0x15, 0x11, 0x00 },
+    { 0x00, 0x00, 0x0f, 0x11, 0x11, 0x11, 0x11, 0x00 },
+    { 0x00, 0x00, 0x0e, 0x11, 0x11, 0x11, 0x0e, 0x00 },
+    { 0x00, 0x00, 0x0f, 0x11, 0x11, 0x0f, 0x01, 0x01 },
+    { 0x00, 0x00, 0x1e, 0x11, 0x11, 0x1e, 0x10, 0x10 },
+    { 0x00, 0x00, 0x19, 0x05, 0x03, 0x01, 0x01, 0x00 },
+    { 0x00, 0x00, 0x1e, 0x01, 0x0e, 0x10, 0x0f, 0x00 },
+    { 0x00, 0x04, 0x04, 0x0e, 0x04, 0x04, 0x0c, 0x00 },
+    { 0x00, 0x00, 0x11, 0x11, 0x11, 0x11, 0x1e, 0x00 },
+    { 0x00, 0x00, 0x11, 0x11, 0x0a, 0x0a, 0x04, 0x00 },
+    { 0x00, 0x00, 0x11, 0x15, 0x15, 0x15, 0x0a, 0x00 },
+    { 0x00, 0x00, 0x11, 0x0a, 0x04, 0x0a, 0x11, 0x00 },
+    { 0x00, 0x00, 0x11, 0x11, 0x11, 0x1e, 0x10, 0x0f },
+    { 0x00, 0x00, 0x1f, 0x08, 0x04, 0x02, 0x1f, 0x00 },
+    { 0x08, 0x04, 0x04, 0x02, 0x04, 0x04, 0x08, 0x00 },
+    { 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00 },
+    { 0x02, 0x04, 0x04, 0x08, 0x04, 0x04, 0x02, 0x00 },
+    { 0x00, 0x00, 0x12, 0x15, 0x09, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x04, 0x0a, 0x11, 0x11, 0x1f, 0x00 },
+};
+
+// 행 마스크를 5개의 픽셀 마스크로 펼친 표. 픽셀 마스크와 (bus order) 색상을 AND 하면 그대로 framebuffer에 쓸 수 있다.
+static const uint16_t STARFONT_ATLAS_EXPAND[32][5] = {
+    { 0x0000, 0x0000, 0x0000, 0x0000, 0x0000 },
+    { 0xffff, 0x0000, 0x0000, 0x0000, 0x0000 },
+    { 0x0000, 0xffff, 0x0000, 0x0000, 0x0000 },
+    { 0xffff, 0xffff, 0x0000, 0x0000, 0x0000 },
+    { 0x0000, 0x0000, 0xffff, 0x0000, 0x0000 },
+    { 0xffff, 0x0000, 0xffff, 0x0000, 0x0000 },
+    { 0x0000, 0xffff, 0xffff, 0x0000, 0x0000 },
+    { 0xffff, 0xffff, 0xffff, 0x0000, 0x0000 },
+    { 0x0000, 0x0000, 0x0000, 0xffff, 0x0000 },
+    { 0xffff, 0x0000, 0x0000, 0xffff, 0x0000 },
+    { 0x0000, 0xffff, 0x0000, 0xffff, 0x0000 },
+    { 0xffff, 0xffff, 0x0000, 0xffff, 0x0000 },
+    { 0x0000, 0x0000, 0xffff, 0xffff, 0x0000 },
+    { 0xffff, 0x0000, 0xffff, 0xffff, 0x0000 },
+    { 0x0000, 0xffff, 0xffff, 0xffff, 0x0000 },
+    { 0xffff, 0xffff, 0xffff, 0xffff, 0x0000 },
+    { 0x0000, 0x0000, 0x0000, 0x0000, 0xffff },
+    { 0xffff, 0x0000, 0x0000, 0x0000, 0xffff },
+    { 0x0000, 0xffff, 0x0000, 0x0000, 0xffff },
+    { 0xffff, 0xffff, 0x0000, 0x0000, 0xffff },
+    { 0x0000, 0x0000, 0xffff, 0x0000, 0xffff },
+    { 0xffff, 0x0000, 0xffff, 0x0000, 0xffff },
+    { 0x0000, 0xffff, 0xffff, 0x0000, 0xffff },
+    { 0xffff, 0xffff, 0xffff, 0x0000, 0xffff },
+    { 0x0000, 0x0000, 0x0000, 0xffff, 0xffff },
+    { 0xffff, 0x0000, 0x0000, 0xffff, 0xffff },
+    { 0x0000, 0xffff, 0x0000, 0xffff, 0xffff },
+    { 0xffff, 0xffff, 0x0000, 0xffff, 0xffff },
+    { 0x0000, 0x0000, 0xffff, 0xffff, 0xffff },
+    { 0xffff, 0x0000, 0xffff, 0xffff, 0xffff },
+    { 0x0000, 0xffff, 0xffff, 0xffff, 0xffff },
+    { 0xffff, 0xffff, 0xffff, 0xffff, 0xffff },
+};
+
+#endif
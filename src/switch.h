@@ -5,8 +5,7 @@
 #ifndef _SWITCH_H_
 #define _SWITCH_H_
 
-#include "pico.h"
-#include "config.h"
+#include "hal.h"
 
 enum switch_event_t {
     SWITCH_EVENT_NONE = 0x00, // 아무 스위치도 눌리지 않았을 때
@@ -36,7 +35,7 @@ inline static enum switch_event_t switch_wait_until_input(void) {
     enum switch_event_t sw;
 
     while (!(sw = switch_read())) {
-        tight_loop_contents();
+        hal_tight_loop();
     }
 
     return sw;
@@ -0,0 +1,202 @@
+/**
+ * @file telemetry.c
+ * @brief 센싱, 제어, 마크 정보를 USB CDC로 내보내는 이진 telemetry
+ */
+
+#include <string.h>
+
+#include "telemetry.h"
+#include "hal.h"
+
+_Static_assert((TELEMETRY_BUFFER_SIZE & (TELEMETRY_BUFFER_SIZE - 1)) == 0, "TELEMETRY_BUFFER_SIZE must be a power of two");
+
+/**
+ * @brief 프레임들을 담는 ring buffer.
+ * 각 프레임은 length(1) | type(1) | seq(1) | payload(length) 형태로 저장된다.
+ * head는 생산자만, tail은 소비자(메인 루프)만 증가시키며, 두 값 모두 TELEMETRY_BUFFER_SIZE로 나눈 나머지를 위치로 사용한다.
+ */
+static uint8_t ring[TELEMETRY_BUFFER_SIZE];
+static volatile uint32_t ring_head = 0;
+static volatile uint32_t ring_tail = 0;
+static uint8_t ring_seq = 0;
+
+volatile uint telemetry_streams = 0;
+volatile uint telemetry_dropped = 0;
+
+static inline void ring_write(uint32_t at, const void *data, uint length) {
+    const uint32_t index = at & (TELEMETRY_BUFFER_SIZE - 1);
+    const uint first = MIN(length, TELEMETRY_BUFFER_SIZE - index);
+
+    memcpy(&ring[index], data, first);
+    memcpy(&ring[0], (const uint8_t *)data + first, length - first);
+}
+
+static inline void ring_read(uint32_t at, void *data, uint length) {
+    const uint32_t index = at & (TELEMETRY_BUFFER_SIZE - 1);
+    const uint first = MIN(length, TELEMETRY_BUFFER_SIZE - index);
+
+    memcpy(data, &ring[index], first);
+    memcpy((uint8_t *)data + first, &ring[0], length - first);
+}
+
+/**
+ * @brief stream의 활성화 여부와 관계없이 프레임을 ring buffer에 넣는다.
+ */
+static void HAL_ISR_FUNC(telemetry_push_frame)(uint type, const void *payload, uint length) {
+    uint32_t status = hal_irq_save();
+
+    const uint32_t head = ring_head;
+    if (TELEMETRY_BUFFER_SIZE - (head - ring_tail) < length + 3) {
+        telemetry_dropped++;
+        ring_seq++; // 수신 측에서 빠진 프레임을 알 수 있도록 seq는 증가시킨다.
+    } else {
+        const uint8_t header[3] = { length, type, ring_seq++ };
+        ring_write(head, header, sizeof(header));
+        ring_write(head + sizeof(header), payload, length);
+
+        // 프레임 내용이 모두 기록된 후에 head를 옮긴다.
+        hal_memory_barrier();
+        ring_head = head + sizeof(header) + length;
+    }
+
+    hal_irq_restore(status);
+}
+
+void HAL_ISR_FUNC(telemetry_push)(uint type, const void *payload, uint length) {
+    if (!(telemetry_streams & (1u << type)) || length > TELEMETRY_PAYLOAD_MAX) {
+        return;
+    }
+
+    telemetry_push_frame(type, payload, length);
+}
+
+/**
+ * @brief COBS 인코딩: 0x00이 없는 바이트열로 바꾸고 끝에 구분자 0x00을 붙인다.
+ *
+ * @return uint 인코딩된 길이 (구분자 포함)
+ */
+static uint telemetry_cobs_encode(const uint8_t *src, uint length, uint8_t *dst) {
+    uint8_t *const start = dst;
+    uint8_t *code = dst++; // 현재 블록의 코드(다음 0x00까지의 거리)가 들어갈 위치
+    uint8_t count = 1;
+
+    for (uint i = 0; i < length; i++) {
+        if (src[i] == 0x00) {
+            *code = count;
+            code = dst++;
+            count = 1;
+        } else {
+            *dst++ = src[i];
+            if (++count == 0xFF) {
+                *code = count;
+                code = dst++;
+                count = 1;
+            }
+        }
+    }
+    *code = count;
+    *dst++ = 0x00;
+
+    return dst - start;
+}
+
+/**
+ * @brief 인코딩된 프레임들을 모아두었다가 한 번에 USB로 보내기 위한 버퍼
+ */
+static uint8_t out_buffer[TELEMETRY_FLUSH_BYTES];
+
+/**
+ * @brief 길이가 length인 프레임을 COBS로 인코딩했을 때의 최대 길이 (crc16, COBS 코드, 구분자 포함)
+ */
+#define TELEMETRY_ENCODED_LENGTH(length) ((length) + 2 + 2)
+
+void telemetry_flush(void) {
+    /*
+     * stdio_usb는 USB 송신 버퍼가 가득 차면 버퍼가 빌 때까지 한동안 기다린다.
+     * 주행 중에 메인 루프가 멈추면 안되므로, 송신 버퍼에 바로 들어갈 수 있는 만큼만 보낸다.
+     * 보내지 못한 프레임은 ring buffer에 남아 다음 호출 때 보내진다.
+     */
+    const uint budget = MIN(sizeof(out_buffer), hal_usb_write_available());
+    uint out_length = 0;
+
+    for (;;) {
+        const uint32_t tail = ring_tail;
+        if (tail == ring_head) {
+            break;
+        }
+        hal_memory_barrier(); // head를 읽은 후에 프레임 내용을 읽는다.
+
+        uint8_t header[3];
+        ring_read(tail, header, sizeof(header));
+        const uint length = header[0];
+        if (out_length + TELEMETRY_ENCODED_LENGTH(length + 2) > budget) {
+            break;
+        }
+
+        // type과 seq 뒤에 payload를 이어 붙이고 crc16을 붙인다.
+        uint8_t frame[TELEMETRY_FRAME_MAX];
+        frame[0] = header[1];
+        frame[1] = header[2];
+        ring_read(tail + sizeof(header), &frame[2], length);
+
+        // 프레임을 모두 읽은 후에 tail을 옮겨 생산자가 그 자리를 쓸 수 있게 한다.
+        hal_memory_barrier();
+        ring_tail = tail + sizeof(header) + length;
+
+        const uint16_t crc = telemetry_crc16(frame, length + 2);
+        frame[length + 2] = crc & 0xFF;
+        frame[length + 3] = crc >> 8;
+        out_length += telemetry_cobs_encode(frame, length + 4, &out_buffer[out_length]);
+    }
+
+    if (out_length > 0) {
+        hal_usb_write(out_buffer, out_length);
+    }
+}
+
+bool telemetry_connected(void) {
+    return hal_usb_connected();
+}
+
+uint telemetry_pending(void) {
+    return ring_head - ring_tail;
+}
+
+void telemetry_start(uint streams) {
+    if (!hal_usb_connected()) {
+        return;
+    }
+
+    telemetry_dropped = 0;
+    telemetry_streams = streams;
+}
+
+void telemetry_stop(void) {
+    telemetry_streams = 0;
+
+    // 남은 프레임을 최대 TELEMETRY_DRAIN_TIMEOUT_US 동안 보내고, 그래도 남은 프레임은 버린다.
+    const uint32_t start = hal_time_us_32();
+    while (ring_tail != ring_head && hal_usb_connected() &&
+           hal_time_us_32() - start < TELEMETRY_DRAIN_TIMEOUT_US) {
+        telemetry_flush();
+    }
+
+    uint32_t status = hal_irq_save();
+    ring_tail = ring_head;
+    hal_irq_restore(status);
+}
+
+void telemetry_print(const char *text) {
+    uint length = strlen(text);
+
+    // 긴 문자열은 여러 프레임으로 나누어 보낸다.
+    while (length > 0) {
+        const uint chunk = MIN(length, TELEMETRY_PAYLOAD_MAX);
+
+        telemetry_push_frame(TELEMETRY_FRAME_TEXT, text, chunk);
+        text += chunk;
+        length -= chunk;
+    }
+
+    telemetry_flush();
+}
@@ -0,0 +1,83 @@
+/**
+ * @file telemetry.h
+ * @brief 센싱, 제어, 마크 정보를 USB CDC로 내보내는 이진 telemetry
+ *
+ * 인터럽트 핸들러는 `telemetry_push` 함수로 프레임을 ring buffer에 넣기만 하고,
+ * 메인 루프에서 `telemetry_flush` 함수를 호출하여 프레임을 COBS로 인코딩한 후 USB로 보낸다.
+ * 프레임 구조는 telemetry_protocol.h를 참고한다.
+ */
+
+#ifndef _TELEMETRY_H_
+#define _TELEMETRY_H_
+
+#include "pico/types.h"
+#include "config.h"
+#include "telemetry_protocol.h"
+
+enum telemetry_stream_t {
+    TELEMETRY_STREAM_SENSING = 1 << TELEMETRY_FRAME_SENSING,
+    TELEMETRY_STREAM_CONTROL = 1 << TELEMETRY_FRAME_CONTROL,
+    TELEMETRY_STREAM_MARK = 1 << TELEMETRY_FRAME_MARK,
+    TELEMETRY_STREAM_TEXT = 1 << TELEMETRY_FRAME_TEXT,
+    TELEMETRY_STREAM_BLACKBOX = 1 << TELEMETRY_FRAME_BLACKBOX,
+    TELEMETRY_STREAM_ALL = 0xFF,
+};
+
+/**
+ * @brief [READ ONLY] 현재 내보내고 있는 stream들 (enum telemetry_stream_t의 조합)
+ */
+extern volatile uint telemetry_streams;
+
+/**
+ * @brief [READ ONLY] ring buffer가 가득 차서 버려진 프레임 수
+ */
+extern volatile uint telemetry_dropped;
+
+/**
+ * @brief 프레임을 ring buffer에 넣는다. 인터럽트 핸들러에서 호출할 수 있다.
+ * 해당 stream이 꺼져 있거나 ring buffer에 자리가 없으면 프레임을 버린다.
+ *
+ * 소비자(메인 루프)와는 head, tail 인덱스만으로 동기화하므로 소비자는 lock 없이 동작한다.
+ * 생산자는 여러 곳(센싱, 모터 제어 인터럽트, 메인 루프)일 수 있으므로, 프레임을 쓰는 짧은 동안만 인터럽트를 막아
+ * 생산자가 항상 하나처럼 동작하도록 한다.
+ *
+ * @param type enum telemetry_frame_type_t
+ * @param payload 프레임 내용
+ * @param length 프레임 내용의 길이 (TELEMETRY_PAYLOAD_MAX 이하)
+ */
+void telemetry_push(uint type, const void *payload, uint length);
+
+/**
+ * @brief ring buffer에 쌓인 프레임들을 인코딩하여 USB로 보낸다. 메인 루프에서만 호출한다.
+ * 한 번 호출될 때 최대 TELEMETRY_FLUSH_BYTES 바이트만 보내므로 호출 시간이 길어지지 않는다.
+ */
+void telemetry_flush(void);
+
+/**
+ * @brief USB가 연결되어 있어 프레임을 보낼 수 있는지 반환한다.
+ */
+bool telemetry_connected(void);
+
+/**
+ * @brief ring buffer에 남아 있는 (아직 보내지 않은) 바이트 수를 반환한다.
+ */
+uint telemetry_pending(void);
+
+/**
+ * @brief 지정한 stream들을 내보내기 시작한다. USB가 연결되어 있지 않으면 아무것도 하지 않는다.
+ *
+ * @param streams enum telemetry_stream_t의 조합
+ */
+void telemetry_start(uint streams);
+
+/**
+ * @brief 모든 stream을 멈추고, 남은 프레임을 모두 보낸다.
+ */
+void telemetry_stop(void);
+
+/**
+ * @brief 문자열 프레임을 보낸다. 메인 루프에서만 호출한다.
+ */
+void telemetry_print(const char *text);
+
+#endif
@@ -0,0 +1,205 @@
+/**
+ * @file telemetry_protocol.h
+ * @brief USB CDC로 전송되는 이진 telemetry 프레임의 정의. 펌웨어와 호스트 도구가 함께 사용한다.
+ *
+ * [ 프레임 구조 ]
+ * 한 프레임은 아래의 바이트열을 COBS(Consistent Overhead Byte Stuffing)로 인코딩한 후 0x00을 붙여 보낸다.
+ *   type(1) | seq(1) | payload(0 ~ TELEMETRY_PAYLOAD_MAX) | crc16(2, little endian)
+ * COBS로 인코딩하면 프레임 안에 0x00이 나타나지 않으므로, 수신 측은 0x00을 기준으로 프레임을 나눌 수 있다.
+ * seq는 프레임이 만들어질 때마다 1씩 증가하므로, 수신 측에서 빠진 프레임을 알아낼 수 있다.
+ * crc16은 type부터 payload까지에 대한 CRC-16/CCITT-FALSE 값이다.
+ *
+ * payload의 다중 바이트 값은 모두 little endian이다.
+ */
+
+#ifndef _TELEMETRY_PROTOCOL_H_
+#define _TELEMETRY_PROTOCOL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define TELEMETRY_PAYLOAD_MAX (48)
+#define TELEMETRY_FRAME_MAX   (TELEMETRY_PAYLOAD_MAX + 4) // type, seq, crc16
+
+/**
+ * @brief COBS로 인코딩한 프레임의 최대 길이 (구분자 0x00 포함)
+ */
+#define TELEMETRY_ENCODED_MAX (TELEMETRY_FRAME_MAX + TELEMETRY_FRAME_MAX / 254 + 2)
+
+enum telemetry_frame_type_t {
+    TELEMETRY_FRAME_SENSING = 0x01,
+    TELEMETRY_FRAME_CONTROL = 0x02,
+    TELEMETRY_FRAME_MARK = 0x03,
+    TELEMETRY_FRAME_TEXT = 0x04,
+    TELEMETRY_FRAME_BLACKBOX = 0x05,
+};
+
+/**
+ * @brief 센싱 프레임: 센싱 주기(SENSING_TIMER_INTERVAL_US)마다 하나씩 만들어진다.
+ */
+struct telemetry_sensing_t {
+    uint32_t time_us;
+    uint16_t ir_state;
+    int16_t position;
+    int16_t position_limited;
+    uint16_t voltage_mv;
+    uint8_t normalized[16];
+} __attribute__((packed));
+
+/**
+ * @brief 제어 프레임: 모터 제어 주기(MOTOR_CONTROL_INTERVAL_US)마다 하나씩 만들어진다.
+ * 배열의 0번은 왼쪽, 1번은 오른쪽 모터이다.
+ */
+struct telemetry_control_t {
+    uint32_t time_us;
+    int32_t current[2]; // 엔코더 값
+    int32_t target[2];
+    int32_t error[2];
+} __attribute__((packed));
+
+/**
+ * @brief 마크 프레임: 주행 중 마크가 결정될 때마다 만들어진다.
+ */
+struct telemetry_mark_t {
+    uint32_t time_us;
+    uint8_t mark; // enum mark_t
+    int32_t distance; // 엔코더로 잰 주행 거리 (tick)
+} __attribute__((packed));
+
+/**
+ * @brief 블랙박스 프레임: 블랙박스에 기록된 레코드 하나. 블랙박스는 이 구조체를 그대로 RAM에 저장한다.
+ * 모터 제어 주기마다 기록되므로 크기를 작게 유지한다.
+ */
+struct telemetry_blackbox_t {
+    uint32_t time_us;
+    uint16_t ir_state;
+    int16_t position;
+    int16_t encoder[2]; // 엔코더 값의 하위 16비트. 한 주기 동안의 변화량이 작으므로 이어 붙여 복원할 수 있다.
+    uint16_t velocity_mm; // 지령 속도 (mm/s)
+    uint8_t mark; // 마지막으로 결정된 마크 (enum mark_t)
+    uint8_t mark_state; // 마크 state machine의 상태
+} __attribute__((packed));
+
+_Static_assert(sizeof(struct telemetry_sensing_t) <= TELEMETRY_PAYLOAD_MAX, "sensing frame is too long");
+_Static_assert(sizeof(struct telemetry_control_t) <= TELEMETRY_PAYLOAD_MAX, "control frame is too long");
+_Static_assert(sizeof(struct telemetry_mark_t) <= TELEMETRY_PAYLOAD_MAX, "mark frame is too long");
+_Static_assert(sizeof(struct telemetry_blackbox_t) == 16, "blackbox record should stay compact");
+
+/**
+ * @brief CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)를 계산한다.
+ */
+static inline uint16_t telemetry_crc16(const uint8_t *data, size_t length) {
+    uint16_t crc = 0xFFFF;
+
+    for (size_t i = 0; i < length; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+/**
+ * @brief COBS로 인코딩된 프레임(구분자 제외)을 복원한다. 호스트 도구에서 사용한다.
+ *
+ * @return int 복원된 길이, 잘못된 입력이면 -1
+ */
+static inline int telemetry_cobs_decode(const uint8_t *src, int length, uint8_t *dst, int capacity) {
+    int out = 0;
+
+    for (int i = 0; i < length;) {
+        const int code = src[i++];
+        if (code == 0 || i + code - 1 > length) {
+            return -1;
+        }
+        for (int j = 1; j < code; j++) {
+            if (out >= capacity) {
+                return -1;
+            }
+            dst[out++] = src[i++];
+        }
+        if (code != 0xFF && i < length) {
+            if (out >= capacity) {
+                return -1;
+            }
+            dst[out++] = 0x00;
+        }
+    }
+
+    return out;
+}
+
+/**
+ * @brief 받은 바이트열을 구분자(0x00)로 나누어 프레임을 복원하는 parser의 상태. 호스트 도구에서 사용한다.
+ */
+struct telemetry_parser_t {
+    uint8_t encoded[TELEMETRY_ENCODED_MAX];
+    int encoded_length;
+    int overflow; // 구분자 없이 최대 길이를 넘은 경우, 다음 구분자까지 버린다.
+    int last_seq; // 마지막으로 받은 프레임의 seq, 아직 받은 프레임이 없으면 -1
+
+    unsigned long frames;
+    unsigned long lost; // seq가 건너뛴 프레임 수
+    unsigned long crc_errors;
+    unsigned long format_errors; // COBS 오류, 길이 오류
+};
+
+static inline void telemetry_parser_init(struct telemetry_parser_t *parser) {
+    parser->encoded_length = 0;
+    parser->overflow = 0;
+    parser->last_seq = -1;
+    parser->frames = parser->lost = parser->crc_errors = parser->format_errors = 0;
+}
+
+/**
+ * @brief 받은 바이트 하나를 넣는다. 이 바이트로 올바른 프레임이 끝나면 frame에 type | seq | payload를 복원한다.
+ *
+ * @param frame TELEMETRY_FRAME_MAX 바이트 이상의 버퍼
+ * @return int 프레임이 끝났으면 payload 길이, 아직 끝나지 않았거나 잘못된 프레임이면 -1
+ */
+static inline int telemetry_parser_feed(struct telemetry_parser_t *parser, uint8_t byte, uint8_t *frame) {
+    if (byte != 0x00) {
+        if (parser->encoded_length < (int)sizeof(parser->encoded)) {
+            parser->encoded[parser->encoded_length++] = byte;
+        } else {
+            parser->overflow = 1;
+        }
+        return -1;
+    }
+
+    const int length = parser->encoded_length;
+    const int overflow = parser->overflow;
+    parser->encoded_length = 0;
+    parser->overflow = 0;
+
+    if (overflow) {
+        parser->format_errors++;
+        return -1;
+    }
+    if (length == 0) { // 연속된 구분자
+        return -1;
+    }
+
+    const int decoded = telemetry_cobs_decode(parser->encoded, length, frame, TELEMETRY_FRAME_MAX);
+    if (decoded < 4) {
+        parser->format_errors++;
+        return -1;
+    }
+    if (telemetry_crc16(frame, decoded - 2) != (frame[decoded - 2] | (frame[decoded - 1] << 8))) {
+        parser->crc_errors++;
+        return -1;
+    }
+
+    const uint8_t seq = frame[1];
+    if (parser->last_seq >= 0) {
+        parser->lost += (uint8_t)(seq - parser->last_seq - 1);
+    }
+    parser->last_seq = seq;
+    parser->frames++;
+
+    return decoded - 4;
+}
+
+#endif
@@ -15,12 +15,17 @@
 #include "hardware/timer.h"
 #include "hardware/irq.h"
 
+#include "hal.h"
+
 // 각 인터럽트의 주기들
 uint timer_periodic_intervals[TIMER_SLOT_COUNT];
 
 // 일정 주기에 도달했을 때 수행되는 함수들
 static void (*timer_periodic_handlers[TIMER_SLOT_COUNT])(void);
 
+// 각 IRQ 핸들러의 실행 시간 통계 (단위: HAL_CYCLE_UNIT)
+static struct timer_stats_t timer_stats[TIMER_SLOT_COUNT];
+
 /*
  * Timer의 Alarm 값을 [(현재 Timer 값) + (interval)]로 설정하여 (interval)가
  * 지난 후 Alarm 기능이 동작하도록 설정한다. 즉, 인터럽트를 발생시킨다. 한편,
@@ -31,19 +36,32 @@ inline static void timer_set_alarm(enum timer_slot_index index, uint interval) {
     timer_hw->alarm[index] = timer_hw->timerawl + interval;
 }
 
+inline static void timer_update_stats(enum timer_slot_index index, uint32_t elapsed) {
+    struct timer_stats_t *const stats = &timer_stats[index];
+
+    stats->count++;
+    stats->total += elapsed;
+    if (stats->max < elapsed) {
+        stats->max = elapsed;
+    }
+}
+
 /*
  * Timer의 각 Alarm에 대한 인터럽트 핸들러를 정의하는 매크로
  * 1. 다음 주기에 Alarm이 수행될 수 있도록 ALRAM 레지스터를 설정한다.
  * 2. Alarm IRQ를 초기화 한다.
  * 3. Alarm에 등록된 함수를 수행한다.
  * 4. Alarm IRQ를 설정한다.
+ * 5. 1 ~ 4에 걸린 시간을 통계에 더한다.
  */
-#define TIMER_IRQ_HANDLER(SLOT)                                \
-    static void timer_irq_handler_##SLOT(void) {               \
-        timer_set_alarm(SLOT, timer_periodic_intervals[SLOT]); \
-        hw_clear_bits(&timer_hw->intr, 1u << SLOT);            \
-        timer_periodic_handlers[SLOT]();                       \
-        hw_set_bits(&timer_hw->inte, 1u << SLOT);              \
+#define TIMER_IRQ_HANDLER(SLOT)                                                  \
+    static void HAL_ISR_FUNC(timer_irq_handler_##SLOT)(void) {                   \
+        const uint32_t begin = hal_cycle_count();                                \
+        timer_set_alarm(SLOT, timer_periodic_intervals[SLOT]);                   \
+        hw_clear_bits(&timer_hw->intr, 1u << SLOT);                              \
+        timer_periodic_handlers[SLOT]();                                         \
+        hw_set_bits(&timer_hw->inte, 1u << SLOT);                                \
+        timer_update_stats(SLOT, (hal_cycle_count() - begin) & HAL_CYCLE_MASK);  \
     }
 
 // 총 4개의 Alarm IRQ 핸들러 등록
@@ -86,4 +104,20 @@ void timer_periodic_stop(enum timer_slot_index index) {
     hw_set_bits(&timer_hw->armed, 1u << index);
     irq_set_enabled(alarm_irqs[index], false);
     hw_clear_bits(&timer_hw->intr, 1u << index);
-}
\ No newline at end of file
+}
+
+struct timer_stats_t timer_get_stats(enum timer_slot_index index) {
+    const uint32_t status = hal_irq_save();
+    const struct timer_stats_t stats = timer_stats[index];
+    hal_irq_restore(status);
+
+    return stats;
+}
+
+void timer_reset_stats(void) {
+    const uint32_t status = hal_irq_save();
+    for (int i = 0; i < TIMER_SLOT_COUNT; i++) {
+        timer_stats[i] = (struct timer_stats_t) { 0 };
+    }
+    hal_irq_restore(status);
+}
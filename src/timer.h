@@ -28,4 +28,23 @@ void timer_periodic_start(enum timer_slot_index index, uint interval, void (*han
  */
 void timer_periodic_stop(enum timer_slot_index index);
 
+/**
+ * @brief IRQ 핸들러 실행 시간 통계. 시간은 hal_cycle_count로 재며 단위는 HAL_CYCLE_UNIT이다.
+ * 사이클 카운터는 hal_cycle_counter_init으로 미리 켜 두어야 한다.
+ */
+struct timer_stats_t {
+    uint32_t count; // 핸들러 실행 횟수
+    uint32_t max; // 가장 오래 걸린 한 번의 실행 시간
+    uint64_t total; // 실행 시간의 합
+};
+
+/*! \brief 슬롯의 핸들러 실행 시간 통계를 가져온다.
+ * \param index 타이머 슬롯 (TIMER_SLOT_0, TIMER_SLOT_1, ..., TIMER_SLOT_3)
+ */
+struct timer_stats_t timer_get_stats(enum timer_slot_index index);
+
+/*! \brief 모든 슬롯의 핸들러 실행 시간 통계를 초기화한다.
+ */
+void timer_reset_stats(void);
+
 #endif
\ No newline at end of file
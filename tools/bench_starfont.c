@@ -0,0 +1,89 @@
+/**
+ * @file bench_starfont.c
+ * @brief 문자 렌더링 방식에 따른 초당 처리 문자 수를 호스트에서 비교하는 벤치마크
+ *
+ * before: 1비트 비트맵을 픽셀마다 검사하여 열 단위 버퍼를 채운 후, 전송 전에 바이트 순서를 바꾸는 방식 (기존 oled_putchar)
+ * after:  starfont_atlas.h의 행 마스크와 픽셀 마스크 표를 이용해 framebuffer에 masked blit 하는 방식
+ *
+ * 빌드 및 실행 (저장소 최상위에서):
+ *     cc -O2 -Isrc tools/bench_starfont.c -o bench_starfont && ./bench_starfont
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "starfont.h"
+#include "starfont_atlas.h"
+
+#define WIDTH       96
+#define HEIGHT      64
+#define FONT_WIDTH  STARFONT_ASCII_WIDTH
+#define FONT_HEIGHT STARFONT_ASCII_HEIGHT
+#define ITERATIONS  (4 * 1000 * 1000)
+
+static uint16_t framebuffer[HEIGHT][WIDTH];
+static uint16_t column_buffer[FONT_WIDTH * FONT_HEIGHT];
+
+static void render_before(char c, uint16_t color) {
+    const char *font = STARFONT_ASCII[(int)c & 0x7F];
+
+    for (int i = 0; i < FONT_WIDTH; i++) {
+        for (int j = 0; j < FONT_HEIGHT; j++) {
+            column_buffer[FONT_HEIGHT * i + j] = font[i] & (1 << j) ? color : 0x0000;
+        }
+    }
+    for (int i = 0; i < FONT_WIDTH * FONT_HEIGHT; i++) {
+        column_buffer[i] = __builtin_bswap16(column_buffer[i]);
+    }
+}
+
+static void render_after(char c, uint16_t color, int x, int y) {
+    const uint8_t *const rows = STARFONT_ATLAS_ROWS[(int)c & 0x7F];
+    const uint16_t bus_color = __builtin_bswap16(color);
+
+    for (int j = 0; j < FONT_HEIGHT; j++) {
+        const uint16_t *const mask = STARFONT_ATLAS_EXPAND[rows[j]];
+        uint16_t *const dst = &framebuffer[y + j][x];
+
+        for (int i = 0; i < FONT_WIDTH; i++) {
+            dst[i] = mask[i] & bus_color;
+        }
+    }
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(void) {
+    volatile uint32_t sink = 0;
+    double t0, t1;
+
+    t0 = now_s();
+    for (int n = 0; n < ITERATIONS; n++) {
+        render_before(' ' + n % 95, 0xF800 ^ n);
+        sink += column_buffer[n % (FONT_WIDTH * FONT_HEIGHT)];
+    }
+    t1 = now_s();
+    const double before = ITERATIONS / (t1 - t0);
+
+    t0 = now_s();
+    for (int n = 0; n < ITERATIONS; n++) {
+        const int col = n % (WIDTH / (FONT_WIDTH + 1));
+        const int row = (n / 16) % (HEIGHT / (FONT_HEIGHT + 1));
+        render_after(' ' + n % 95, 0xF800 ^ n, col * (FONT_WIDTH + 1), row * (FONT_HEIGHT + 1));
+        sink += framebuffer[row][col];
+    }
+    t1 = now_s();
+    const double after = ITERATIONS / (t1 - t0);
+
+    printf("method,chars_per_second\n");
+    printf("before,%.0f\n", before);
+    printf("after,%.0f\n", after);
+    printf("speedup,%.2f\n", after / before);
+
+    return sink == 0xFFFFFFFF;
+}
@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+"""
+starfont.h의 세로 방향(column) 비트맵을 가로 방향(row) 비트맵으로 전치하여
+src/starfont_atlas.h를 생성한다. framebuffer가 행 단위로 저장되므로, 문자를 그릴 때
+행 마스크 하나로 5픽셀을 한 번에 채울 수 있도록 미리 변환해두는 것이다.
+
+사용법 (저장소 최상위에서):
+    python3 tools/gen_starfont_atlas.py
+"""
+
+import os
+import re
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+SRC = os.path.join(ROOT, "src", "starfont.h")
+DST = os.path.join(ROOT, "src", "starfont_atlas.h")
+
+
+def parse_font(text):
+    width = int(re.search(r"#define\s+STARFONT_ASCII_WIDTH\s+(\d+)", text).group(1))
+    height = int(re.search(r"#define\s+STARFONT_ASCII_HEIGHT\s+(\d+)", text).group(1))
+    body = text[text.index("STARFONT_ASCII[128]"):]
+    glyphs = []
+    for row in re.finditer(r"\{([^{}]*)\}", body):
+        values = [int(v, 16) for v in re.findall(r"0x[0-9a-fA-F]+", row.group(1))]
+        if len(values) == width:
+            glyphs.append(values)
+        if len(glyphs) == 128:
+            break
+    assert len(glyphs) == 128, "failed to parse STARFONT_ASCII"
+    return width, height, glyphs
+
+
+def main():
+    with open(SRC, encoding="utf-8") as f:
+        width, height, glyphs = parse_font(f.read())
+
+    out = []
+    out.append("/*")
+    out.append(" * starfont_atlas.h")
+    out.append(" * tools/gen_starfont_atlas.py에 의해 starfont.h로부터 생성된 파일이다. 직접 수정하지 않는다.")
+    out.append(" */")
+    out.append("")
+    out.append("#ifndef _STARFONT_ATLAS_H_")
+    out.append("#define _STARFONT_ATLAS_H_")
+    out.append("")
+    out.append("#include <stdint.h>")
+    out.append("")
+    out.append("// ASCII Code Character(%d*%d) [HORIZONTAL ORDER]" % (width, height))
+    out.append("// 각 행의 i번째 비트가 i번째 열(왼쪽부터)의 픽셀을 나타낸다.")
+    out.append("static const uint8_t STARFONT_ATLAS_ROWS[128][%d] = {" % height)
+    for glyph in glyphs:
+        rows = []
+        for j in range(height):
+            mask = 0
+            for i in range(width):
+                if glyph[i] & (1 << j):
+                    mask |= 1 << i
+            rows.append("0x%02x" % mask)
+        out.append("    { %s }," % ", ".join(rows))
+    out.append("};")
+    out.append("")
+    out.append("// 행 마스크를 %d개의 픽셀 마스크로 펼친 표. 픽셀 마스크와 (bus order) 색상을 AND 하면 그대로 framebuffer에 쓸 수 있다." % width)
+    out.append("static const uint16_t STARFONT_ATLAS_EXPAND[%d][%d] = {" % (1 << width, width))
+    for mask in range(1 << width):
+        pixels = ["0xffff" if mask & (1 << i) else "0x0000" for i in range(width)]
+        out.append("    { %s }," % ", ".join(pixels))
+    out.append("};")
+    out.append("")
+    out.append("#endif")
+    out.append("")
+
+    with open(DST, "w", encoding="utf-8") as f:
+        f.write("\n".join(out))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,221 @@
+/**
+ * @file param_tool.c
+ * @brief USB CDC로 라인트레이서의 파라미터를 읽고 쓰는 호스트 도구
+ *
+ * 명령 형식은 src/command.h를 참고한다. 응답은 telemetry의 TEXT 프레임으로 오므로, 다른 프레임은 무시한다.
+ *   param_tool <device> list
+ *   param_tool <device> get <param>
+ *   param_tool <device> set <param> <value> [<param> <value> ...]
+ *   param_tool <device> sweep <param> <start> <stop> <step> <dwell ms>
+ * sweep은 start부터 stop까지 step씩 바꾸며 각 값을 dwell ms 동안 유지하고, "time_ms,value" 를 stdout에 CSV로 출력한다.
+ * telemetry_decode와 함께 쓰면 값을 바꾼 시각과 센서, 제어 기록을 맞추어 볼 수 있다.
+ *
+ * 빌드 및 실행 (저장소 최상위에서):
+ *     cc -O2 -Isrc tools/param_tool.c -o param_tool && ./param_tool /dev/ttyACM0 list
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <termios.h>
+
+#include "telemetry_protocol.h"
+
+#define REPLY_TIMEOUT_MS 1000
+#define LINE_MAX_LENGTH  256
+
+static int fd;
+
+static struct telemetry_parser_t parser;
+static uint8_t received[512]; // 읽었지만 아직 parser에 넣지 않은 바이트
+static int received_length = 0;
+static int received_index = 0;
+static char text[LINE_MAX_LENGTH];
+static int text_length = 0;
+
+static long now_ms(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * @brief 받은 바이트 하나를 parser에 넣는다. TEXT 프레임이 끝나면 그 내용을 text 뒤에 이어 붙인다.
+ */
+static void handle_byte(uint8_t byte) {
+    uint8_t frame[TELEMETRY_FRAME_MAX];
+
+    const int length = telemetry_parser_feed(&parser, byte, frame);
+    if (length < 0 || frame[0] != TELEMETRY_FRAME_TEXT) {
+        return;
+    }
+
+    for (int i = 0; i < length && text_length < LINE_MAX_LENGTH - 1; i++) {
+        text[text_length++] = frame[2 + i];
+    }
+}
+
+/**
+ * @brief 응답 한 줄을 읽는다.
+ * 한 번에 여러 줄이 도착해도 text가 넘치지 않도록, 한 줄이 완성되면 나머지 바이트는 다음 호출까지 남겨둔다.
+ *
+ * @return 0: 성공, 1: 시간 초과 또는 연결 끊김
+ */
+static int read_line(char *line) {
+    const long deadline = now_ms() + REPLY_TIMEOUT_MS;
+
+    for (;;) {
+        char *newline = memchr(text, '\n', text_length);
+        if (newline) {
+            const int length = newline - text;
+            memcpy(line, text, length);
+            line[length] = '\0';
+            text_length -= length + 1;
+            memmove(text, newline + 1, text_length);
+            return 0;
+        }
+
+        if (received_index < received_length) {
+            handle_byte(received[received_index++]);
+            continue;
+        }
+
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        const long remain = deadline - now_ms();
+        if (remain <= 0 || poll(&pfd, 1, remain) <= 0) {
+            return 1;
+        }
+
+        const ssize_t n = read(fd, received, sizeof(received));
+        if (n <= 0) {
+            return 1;
+        }
+        received_length = n;
+        received_index = 0;
+    }
+}
+
+/**
+ * @brief 명령을 보내고 "ok" 또는 "err" 로 시작하는 마지막 줄까지 받는다. 그 전의 줄들은 stdout으로 출력한다.
+ *
+ * @param reply 마지막 줄이 저장될 곳
+ * @return 0: ok, 1: err 또는 응답 없음
+ */
+static int request(const char *command, char *reply) {
+    char line[LINE_MAX_LENGTH];
+
+    snprintf(line, sizeof(line), "%s\n", command);
+    if (write(fd, line, strlen(line)) < 0) {
+        perror("write");
+        return 1;
+    }
+
+    for (;;) {
+        if (read_line(reply)) {
+            fprintf(stderr, "no reply to \"%s\"\n", command);
+            return 1;
+        }
+        if (strncmp(reply, "ok", 2) == 0) {
+            return 0;
+        }
+        if (strncmp(reply, "err", 3) == 0) {
+            fprintf(stderr, "%s: %s\n", command, reply);
+            return 1;
+        }
+        printf("%s\n", reply);
+    }
+}
+
+static int sweep(const char *param, double start, double stop, double step, long dwell_ms) {
+    char command[LINE_MAX_LENGTH];
+    char reply[LINE_MAX_LENGTH];
+
+    if (step == 0 || (stop - start) / step < 0) {
+        fprintf(stderr, "invalid sweep range\n");
+        return 1;
+    }
+
+    const long origin = now_ms();
+    const int count = (int)((stop - start) / step + 1e-9) + 1;
+
+    printf("time_ms,value\n");
+    for (int i = 0; i < count; i++) {
+        snprintf(command, sizeof(command), "set %s %.9g", param, start + step * i);
+        if (request(command, reply)) {
+            return 1;
+        }
+
+        // 실제로 적용된 값(범위 제한, 반올림 후)을 기록한다.
+        const char *value = strrchr(reply, ' ');
+        printf("%ld,%s\n", now_ms() - origin, value ? value + 1 : "");
+        fflush(stdout);
+
+        usleep(dwell_ms * 1000);
+    }
+
+    return 0;
+}
+
+static void setup_tty(void) {
+    struct termios tio;
+
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+}
+
+static void usage(const char *name) {
+    fprintf(stderr,
+            "usage: %s <device> list\n"
+            "       %s <device> get <param>\n"
+            "       %s <device> set <param> <value> [<param> <value> ...]\n"
+            "       %s <device> sweep <param> <start> <stop> <step> <dwell ms>\n",
+            name, name, name, name);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    fd = open(argv[1], O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        perror(argv[1]);
+        return 1;
+    }
+    setup_tty();
+    telemetry_parser_init(&parser);
+
+    char command[LINE_MAX_LENGTH];
+    char reply[LINE_MAX_LENGTH];
+    int result;
+
+    if (strcmp(argv[2], "sweep") == 0 && argc == 8) {
+        result = sweep(argv[3], atof(argv[4]), atof(argv[5]), atof(argv[6]), atol(argv[7]));
+    } else if ((strcmp(argv[2], "list") == 0 && argc == 3) || (strcmp(argv[2], "get") == 0 && argc == 4) ||
+               (strcmp(argv[2], "set") == 0 && argc >= 5 && argc % 2 == 1)) {
+        int length = 0;
+        for (int i = 2; i < argc && length < (int)sizeof(command); i++) {
+            length += snprintf(&command[length], sizeof(command) - length, i == 2 ? "%s" : " %s", argv[i]);
+        }
+        result = request(command, reply);
+        if (!result && strcmp(argv[2], "list") != 0) {
+            printf("%s\n", reply + 3);
+        }
+    } else {
+        usage(argv[0]);
+        result = 1;
+    }
+
+    close(fd);
+
+    return result;
+}
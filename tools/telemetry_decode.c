@@ -0,0 +1,138 @@
+/**
+ * @file telemetry_decode.c
+ * @brief USB CDC로 받은 이진 telemetry 스트림을 해석하여 프레임 종류별 CSV 파일로 저장하는 호스트 도구
+ *
+ * 입력은 시리얼 장치(/dev/ttyACM0 등) 또는 미리 저장해 둔 파일이다. 입력이 끝나거나 Ctrl+C를 누르면 통계를 출력하고 종료한다.
+ *   <prefix>_sensing.csv, <prefix>_control.csv, <prefix>_mark.csv, <prefix>_blackbox.csv 를 만들고, TEXT 프레임은 stderr로 출력한다.
+ *
+ * 빌드 및 실행 (저장소 최상위에서):
+ *     cc -O2 -Isrc tools/telemetry_decode.c -o telemetry_decode && ./telemetry_decode /dev/ttyACM0 run1
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+
+#include "telemetry_protocol.h"
+
+static volatile sig_atomic_t running = 1;
+
+static FILE *csv_sensing, *csv_control, *csv_mark, *csv_blackbox;
+
+static void on_signal(int sig) {
+    (void)sig;
+    running = 0;
+}
+
+static FILE *open_csv(const char *prefix, const char *name, const char *header) {
+    char path[256];
+
+    snprintf(path, sizeof(path), "%s_%s.csv", prefix, name);
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        perror(path);
+        return NULL;
+    }
+    fprintf(file, "%s\n", header);
+
+    return file;
+}
+
+static void write_frame(uint8_t type, const uint8_t *payload, int length, struct telemetry_parser_t *parser) {
+    if (type == TELEMETRY_FRAME_SENSING && length == sizeof(struct telemetry_sensing_t)) {
+        struct telemetry_sensing_t f;
+        memcpy(&f, payload, sizeof(f));
+        fprintf(csv_sensing, "%u,0x%04x,%d,%d,%u", f.time_us, f.ir_state, f.position, f.position_limited, f.voltage_mv);
+        for (int i = 0; i < 16; i++) {
+            fprintf(csv_sensing, ",%u", f.normalized[i]);
+        }
+        fputc('\n', csv_sensing);
+    } else if (type == TELEMETRY_FRAME_CONTROL && length == sizeof(struct telemetry_control_t)) {
+        struct telemetry_control_t f;
+        memcpy(&f, payload, sizeof(f));
+        fprintf(csv_control, "%u,%d,%d,%d,%d,%d,%d\n", f.time_us, f.current[0], f.current[1], f.target[0], f.target[1], f.error[0], f.error[1]);
+    } else if (type == TELEMETRY_FRAME_MARK && length == sizeof(struct telemetry_mark_t)) {
+        struct telemetry_mark_t f;
+        memcpy(&f, payload, sizeof(f));
+        fprintf(csv_mark, "%u,%u,%d\n", f.time_us, f.mark, f.distance);
+    } else if (type == TELEMETRY_FRAME_BLACKBOX && length == sizeof(struct telemetry_blackbox_t)) {
+        struct telemetry_blackbox_t f;
+        memcpy(&f, payload, sizeof(f));
+        fprintf(csv_blackbox, "%u,0x%04x,%d,%d,%d,%u,%u,%u\n", f.time_us, f.ir_state, f.position, f.encoder[0], f.encoder[1], f.velocity_mm, f.mark, f.mark_state);
+    } else if (type == TELEMETRY_FRAME_TEXT) {
+        fwrite(payload, 1, length, stderr);
+    } else {
+        parser->format_errors++; // 알 수 없는 type 또는 길이
+    }
+}
+
+/**
+ * @brief 입력이 시리얼 장치라면 raw 모드로 설정한다. USB CDC는 baud rate를 무시하므로 따로 설정하지 않는다.
+ */
+static void setup_tty(int fd) {
+    struct termios tio;
+
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tio.c_cc[VMIN] = 1;
+        tio.c_cc[VTIME] = 0;
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s <device or file> <csv prefix>\n", argv[0]);
+        return 1;
+    }
+
+    const int fd = strcmp(argv[1], "-") == 0 ? STDIN_FILENO : open(argv[1], O_RDONLY | O_NOCTTY);
+    if (fd < 0) {
+        perror(argv[1]);
+        return 1;
+    }
+    setup_tty(fd);
+
+    csv_sensing = open_csv(argv[2], "sensing", "time_us,ir_state,position,position_limited,voltage_mv,n0,n1,n2,n3,n4,n5,n6,n7,n8,n9,n10,n11,n12,n13,n14,n15");
+    csv_control = open_csv(argv[2], "control", "time_us,current_l,current_r,target_l,target_r,error_l,error_r");
+    csv_mark = open_csv(argv[2], "mark", "time_us,mark,distance");
+    csv_blackbox = open_csv(argv[2], "blackbox", "time_us,ir_state,position,encoder_l,encoder_r,velocity_mm,mark,mark_state");
+    if (!csv_sensing || !csv_control || !csv_mark || !csv_blackbox) {
+        return 1;
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    struct telemetry_parser_t parser;
+    telemetry_parser_init(&parser);
+    uint8_t buffer[4096];
+    uint8_t frame[TELEMETRY_FRAME_MAX];
+
+    while (running) {
+        const ssize_t n = read(fd, buffer, sizeof(buffer));
+        if (n <= 0) {
+            break;
+        }
+
+        for (ssize_t i = 0; i < n; i++) {
+            const int length = telemetry_parser_feed(&parser, buffer[i], frame);
+            if (length >= 0) {
+                write_frame(frame[0], &frame[2], length, &parser);
+            }
+        }
+    }
+
+    fclose(csv_sensing);
+    fclose(csv_control);
+    fclose(csv_mark);
+    fclose(csv_blackbox);
+
+    fprintf(stderr, "\nframes: %lu, lost: %lu, crc errors: %lu, format errors: %lu\n", parser.frames, parser.lost, parser.crc_errors, parser.format_errors);
+
+    return parser.crc_errors || parser.format_errors;
+}